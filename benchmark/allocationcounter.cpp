@@ -0,0 +1,24 @@
+#include <cstdlib>
+#include <new>
+#include "allocationcounter.h"
+
+using namespace std;
+
+long long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* memory = malloc(size == 0 ? 1 : size);
+    if (memory == NULL) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
@@ -0,0 +1,8 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+/// Heap allocations made by the program, counted by the replacement operator new defined in
+/// allocationcounter.cpp, which takes the place of the standard one in any program linking it.
+extern long long allocations;
+
+#endif // ALLOCATIONCOUNTER_H
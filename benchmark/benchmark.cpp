@@ -0,0 +1,396 @@
+
+
+/// File: benchmark.cpp
+/// Times the hot paths of dealing, bidding, reading and writing games, reporting the time per operation,
+/// operations per second and heap allocations per operation for each.
+///
+/// Usage: benchmark [--json] [--repetitions R] [--filter TEXT]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "allocationcounter.h"
+#include "dealfile.h"
+#include "dealfilter.h"
+#include "dealnumber.h"
+#include "dealrenderer.h"
+#include "game.h"
+#include "handbatch.h"
+#include "playengine.h"
+
+using namespace std;
+
+const int NUMSAMPLEDEALS = 1024;
+const double WARMUPSECONDS = 0.1;
+const double REPETITIONSECONDS = 0.05;
+
+/// Written with the results of the timed code so that the compiler cannot leave it out.
+static volatile uint64_t sink;
+
+/// A stream buffer that throws away everything written to it, so that output is timed without the device.
+class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) {
+            return c;
+        }
+
+        streamsize xsputn(const char*, streamsize count) {
+            return count;
+        }
+};
+
+/// One timed operation: its name and a function performing it the given number of times.
+struct Benchmark {
+    string name;
+    function<void(long long)> run;
+};
+
+/// The measurements of one benchmark.
+struct Result {
+    string name;
+    long long iterations;
+    vector<double> nanoseconds;
+    double allocationsPerOp;
+};
+
+/// \brief
+/// Runs an operation the given number of times.
+///
+/// \param benchmark Benchmark& - the operation.
+/// \param iterations long long - number of times to perform it.
+///
+/// \return double - seconds taken.
+double timeRun(Benchmark& benchmark, long long iterations) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    benchmark.run(iterations);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/// \brief
+/// Warms an operation up, chooses a number of iterations that takes about REPETITIONSECONDS and then
+/// times the requested number of repetitions of it.
+///
+/// \param benchmark Benchmark& - the operation.
+/// \param repetitions int - number of timed repetitions.
+///
+/// \return Result - the time per operation of each repetition and the allocations per operation.
+Result measure(Benchmark& benchmark, int repetitions) {
+    Result result;
+    result.name = benchmark.name;
+
+    // Double the iterations until a run is long enough to time reliably, which also warms the caches
+    long long iterations = 1;
+    double seconds = timeRun(benchmark, iterations);
+    double warmed = seconds;
+    while (seconds < REPETITIONSECONDS / 4 || warmed < WARMUPSECONDS) {
+        iterations *= 2;
+        seconds = timeRun(benchmark, iterations);
+        warmed += seconds;
+    }
+    iterations = max(1LL, (long long) (iterations * REPETITIONSECONDS / seconds));
+    result.iterations = iterations;
+
+    // Room for the times is made first so that only the operation's own allocations are counted
+    result.nanoseconds.reserve(repetitions);
+    long long allocationsBefore = allocations;
+    for (int i = 0; i < repetitions; i++) {
+        result.nanoseconds.push_back(timeRun(benchmark, iterations) * 1e9 / iterations);
+    }
+    result.allocationsPerOp = (double) (allocations - allocationsBefore) / (iterations * repetitions);
+    return result;
+}
+
+/// \brief
+/// Works out the median, minimum, mean and standard deviation of a list of times.
+///
+/// \param times vector<double> - the times per operation.
+/// \param statistics double[] - receives the median, minimum, mean and standard deviation.
+void summarise(vector<double> times, double statistics[4]) {
+    sort(times.begin(), times.end());
+    size_t count = times.size();
+    double mean = 0;
+    double variance = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        mean += times[i] / count;
+    }
+    for (size_t i = 0; i < count; i++) {
+        variance += (times[i] - mean) * (times[i] - mean) / count;
+    }
+    statistics[0] = count % 2 == 1 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2;
+    statistics[1] = times[0];
+    statistics[2] = mean;
+    statistics[3] = sqrt(variance);
+}
+
+/// \brief
+/// Writes the results as a table.
+///
+/// \param out ostream& - output stream receiving the table.
+/// \param results vector<Result>& - the measurements.
+void printTable(ostream& out, vector<Result>& results) {
+    out << left << setw(28) << "benchmark" << right << setw(12) << "ns/op" << setw(10) << "min" << setw(10) << "stddev"
+        << setw(16) << "ops/sec" << setw(12) << "allocs/op" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        double statistics[4];
+        summarise(results[i].nanoseconds, statistics);
+        out << left << setw(28) << results[i].name << right << fixed << setprecision(1) << setw(12) << statistics[0]
+            << setw(10) << statistics[1] << setw(10) << statistics[3] << setprecision(0) << setw(16) << 1e9 / statistics[0]
+            << setprecision(3) << setw(12) << results[i].allocationsPerOp << endl;
+    }
+}
+
+/// \brief
+/// Writes the results as JSON.
+///
+/// \param out ostream& - output stream receiving the JSON.
+/// \param results vector<Result>& - the measurements.
+/// \param repetitions int - number of timed repetitions of each benchmark.
+void printJson(ostream& out, vector<Result>& results, int repetitions) {
+    out << "{\n  \"compiler\": \"" << __VERSION__ << "\",\n  \"repetitions\": " << repetitions << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        double statistics[4];
+        summarise(results[i].nanoseconds, statistics);
+        out << (i > 0 ? "," : "") << "\n    {\"name\": \"" << results[i].name << "\", \"iterations\": " << results[i].iterations
+            << fixed << setprecision(3)
+            << ", \"ns_per_op\": {\"median\": " << statistics[0] << ", \"min\": " << statistics[1]
+            << ", \"mean\": " << statistics[2] << ", \"stddev\": " << statistics[3] << "}"
+            << ", \"ops_per_sec\": " << 1e9 / statistics[0]
+            << ", \"allocs_per_op\": " << results[i].allocationsPerOp << "}";
+    }
+    out << "\n  ]\n}" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    bool json = false;
+    int repetitions = 10;
+    string filter;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        }
+    }
+
+    // Sample deals shared by the benchmarks that need dealt hands or text to read
+    static Game game;
+    static Hand hands[NUMSAMPLEDEALS];
+    static CardSet deals[NUMSAMPLEDEALS][NUMPOSITIONS];
+    static Card cards[NUMCARDS];
+    static vector<CardSet> handCards;
+    ostringstream text;
+    for (int i = 0; i < NUMSAMPLEDEALS; i++) {
+        game.setup(1, i);
+        game.deal();
+        for (int j = 0; j < NUMPOSITIONS; j++) {
+            deals[i][j] = game.getHand((Position) j)->getCards();
+            handCards.push_back(deals[i][j]);
+        }
+        writeTextDeal(text, game.getDealer(), deals[i]);
+        game.nextDealer();
+    }
+    for (int i = 0; i < NUMCARDS; i++) {
+        cards[i] = Card((Rank) (TWO + i % NUMRANKS), (Suit) (i / NUMRANKS));
+    }
+
+    // The hands bid are those dealt to a different seat of each sample deal, so that the bids
+    // vary as they would in play rather than repeating a handful of hands
+    for (int i = 0; i < NUMSAMPLEDEALS; i++) {
+        for (CardSet held = deals[i][i % NUMPOSITIONS]; held != 0; held &= held - 1) {
+            int bit = __builtin_ctzll(held);
+            hands[i].addCard(&cards[(bit / SUITBITS) * NUMRANKS + bit % SUITBITS - TWO]);
+        }
+    }
+    static istringstream textIn(text.str());
+    static NullBuffer nullBuffer;
+    static ostream nullOut(&nullBuffer);
+    static DealRenderer renderer(DIAGRAM);
+    static HandBatch batch;
+    static vector<HandFeatures> features(handCards.size());
+    static vector<HandEvaluation> evaluations(handCards.size());
+    static DealFilter dealFilter;
+    string error;
+    dealFilter.compile("N hcp 15-17 and N balanced and S spades 5+", error);
+
+    vector<Benchmark> benchmarks = {
+        { "Deck::shuffle", [](long long n) {
+            static Deck deck;
+            static Random randomizer(1, 0);
+            for (long long i = 0; i < n; i++) {
+                deck.shuffle(randomizer);
+            }
+        } },
+        { "Deck::shuffle(seed,deal)", [](long long n) {
+            static Deck deck;
+            for (long long i = 0; i < n; i++) {
+                deck.shuffle(1, i);
+            }
+        } },
+        { "Game::deal", [](long long n) {
+            for (long long i = 0; i < n; i++) {
+                game.setup(true);
+                game.deal();
+            }
+            sink = game.getHand(NORTH)->getCards();
+        } },
+        { "Hand::addCard", [](long long n) {
+            static Hand hand;
+            for (long long i = 0; i < n; i++) {
+                if (i % NUMRANKS == 0) {
+                    hand.clear();
+                }
+                hand.addCard(&cards[(i * 7) % NUMCARDS]);
+            }
+            sink = hand.getCards();
+        } },
+        { "Hand::remove+restoreCard", [](long long n) {
+            static Hand hand;
+            static long long step = 0;
+            if (hand.getCards() == 0) {
+                for (int i = 0; i < NUMRANKS; i++) {
+                    hand.addCard(&cards[i * 4]);
+                }
+            }
+
+            // Play the hand out card by card and take every card back, as a search over play would,
+            // carrying on from wherever the last run stopped
+            uint64_t total = 0;
+            for (long long i = 0; i < n; i++, step++) {
+                if (step % (2 * NUMRANKS) < NUMRANKS) {
+                    CardSet legal = hand.legalCards((Suit) (step % NUMSUITS));
+                    hand.removeCard(__builtin_ctzll(legal));
+                    total += hand.getStrength();
+                }
+                else {
+                    total += hand.restoreCard();
+                }
+            }
+            sink = total;
+        } },
+        { "Hand::makeBid", [](long long n) {
+            uint64_t total = 0;
+            for (long long i = 0; i < n; i++) {
+                total += hands[i % NUMSAMPLEDEALS].makeBid().size();
+            }
+            sink = total;
+        } },
+        { "Hand::makeBidCode", [](long long n) {
+            uint64_t total = 0;
+            for (long long i = 0; i < n; i++) {
+                total += hands[i % NUMSAMPLEDEALS].makeBidCode();
+            }
+            sink = total;
+        } },
+        { "Game::auction", [](long long n) {
+            for (long long i = 0; i < n; i++) {
+                game.auction();
+            }
+            sink = game.getOpeningBid();
+        } },
+        { "operator>>(Game)", [](long long n) {
+            for (long long i = 0; i < n; i++) {
+                if (i % NUMSAMPLEDEALS == 0) {
+                    textIn.clear();
+                    textIn.seekg(0);
+                }
+                textIn >> game;
+            }
+        } },
+        { "operator<<(Game)", [](long long n) {
+            for (long long i = 0; i < n; i++) {
+                nullOut << game << endl;
+            }
+        } },
+        { "DealRenderer::add", [](long long n) {
+            for (long long i = 0; i < n; i++) {
+                renderer.add(deals[i % NUMSAMPLEDEALS], NORTH, PASSBID, NORTH);
+                if (renderer.full()) {
+                    renderer.write(nullOut);
+                }
+            }
+        } },
+        { "HandBatch::evaluate(hand)", [](long long n) {
+            long long done = 0;
+            while (done < n) {
+                int count = (int) min(n - done, (long long) handCards.size());
+                batch.evaluate(handCards.data(), count, features.data());
+                done += count;
+            }
+            sink = features[0].highCardPoints;
+        } },
+        { "HandBatch::evaluate(all)", [](long long n) {
+            long long done = 0;
+            while (done < n) {
+                int count = (int) min(n - done, (long long) handCards.size());
+                batch.evaluate(handCards.data(), count, evaluations.data());
+                done += count;
+            }
+            sink = evaluations[0].losers;
+        } },
+        { "DealFilter::generate", [](long long n) {
+            CardSet deal[NUMPOSITIONS];
+            uint64_t accepted = 0;
+            for (long long i = 0; i < n; i++) {
+                accepted += dealFilter.generate(1, i, deal);
+            }
+            sink = accepted;
+        } },
+        { "rankDeal+unrankDeal", [](long long n) {
+            CardSet deal[NUMPOSITIONS];
+            DealNumber total = 0;
+            for (long long i = 0; i < n; i++) {
+                unrankDeal(rankDeal(deals[i % NUMSAMPLEDEALS]), deal);
+                total += deal[0];
+            }
+            sink = (uint64_t) total;
+        } },
+        { "PlayEngine::playOut", [](long long n) {
+            static PlayEngine engine;
+            static Random randomizer(1, 0);
+            uint64_t total = 0;
+            for (long long i = 0; i < n; i++) {
+                total += engine.playOut(deals[i % NUMSAMPLEDEALS], SPADES, WEST, randomizer);
+            }
+            sink = total;
+        } },
+        { "packDeal+unpackDeal", [](long long n) {
+            uint8_t record[DEALBYTES];
+            CardSet deal[NUMPOSITIONS];
+            for (long long i = 0; i < n; i++) {
+                packDeal(deals[i % NUMSAMPLEDEALS], record);
+                unpackDeal(record, deal);
+            }
+            sink = deal[0];
+        } },
+    };
+
+    vector<Result> results;
+    for (size_t i = 0; i < benchmarks.size(); i++) {
+        if (benchmarks[i].name.find(filter) != string::npos) {
+            results.push_back(measure(benchmarks[i], repetitions));
+        }
+    }
+
+    if (json) {
+        printJson(cout, results, repetitions);
+    }
+    else {
+        printTable(cout, results);
+    }
+    return 0;
+}
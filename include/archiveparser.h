@@ -0,0 +1,244 @@
+#ifndef ARCHIVEPARSER_H
+#define ARCHIVEPARSER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cardset.h"
+#include "dealfile.h"
+#include "game.h"
+
+using namespace std;
+
+/// The kinds of deal archive read by the parser.
+enum ArchiveFormat {
+    PBNFORMAT,
+    LINFORMAT
+};
+
+/// Bytes of archive handed to a thread at a time, before moving the split to the next record boundary.
+const size_t ARCHIVECHUNKBYTES = 1 << 22;
+
+/// Problems kept with their messages and positions; any more are only counted.
+const int MAXARCHIVEERRORS = 100;
+
+/// A problem found in an archive and the place it was found, lines and columns counting from one.
+struct ArchiveError {
+    size_t offset;
+    long long line;
+    long long column;
+    string message;
+};
+
+/// This class reads the deals of a PBN or LIN archive. The file is mapped into memory, split into
+/// chunks at record boundaries (blank lines between PBN games, line ends in LIN) and the chunks are
+/// parsed on several threads straight into packed 13-byte deals, each with its board number and
+/// dealer, so no card ever becomes a string. Every deal is checked to hold 13 cards in each hand
+/// and 52 different cards in all; a deal failing the check is left out and reported with the line
+/// and column where it went wrong, and the rest of the archive is still read.
+///
+/// PBN deals come from the Deal tag, with the board and dealer taken from the Board and Dealer tags
+/// of the same game. LIN deals come from md tags, whose first character gives the dealer and which
+/// may leave out the last hand; the board is taken from an ah tag reading "Board N" after the deal
+/// or a qx tag before it on the same line. A deal with no board number has board zero.
+///
+class ArchiveParser
+{
+    public:
+
+        /// \brief
+        /// Creates a parser with no archive open.
+        ArchiveParser();
+
+        /// \brief
+        /// Unmaps the archive if it is still open.
+        ~ArchiveParser();
+
+        /// \brief
+        /// Maps an archive into memory and tells PBN from LIN by its first character, PBN files
+        /// starting with a tag or a comment.
+        ///
+        /// \param fileName const string& - name of the archive.
+        /// \param error string& - receives a description of the problem if the archive cannot be used.
+        ///
+        /// \return bool - true if the archive was opened.
+        bool open(const string& fileName, string& error);
+
+        /// \brief
+        /// Unmaps the archive and forgets its deals.
+        void close();
+
+        /// \brief
+        /// Returns the format of the open archive.
+        ///
+        /// \return ArchiveFormat - PBN or LIN.
+        ArchiveFormat getFormat();
+
+        /// \brief
+        /// Reads every deal of the archive. The deals and problems found are the same whatever
+        /// the number of threads.
+        ///
+        /// \param numThreads int - number of threads parsing chunks.
+        ///
+        /// \return bool - true if no problem was found.
+        bool parse(int numThreads);
+
+        /// \brief
+        /// Returns the number of valid deals read.
+        ///
+        /// \return long long - count of deals.
+        long long getNumDeals();
+
+        /// \brief
+        /// Unpacks one deal read.
+        ///
+        /// \param index long long - position of the deal among the valid deals, starting from zero.
+        /// \param deal CardSet[] - receives the cards held by each position.
+        void getDeal(long long index, CardSet deal[NUMPOSITIONS]);
+
+        /// \brief
+        /// Returns the board number of one deal read.
+        ///
+        /// \param index long long - position of the deal among the valid deals, starting from zero.
+        ///
+        /// \return long long - the board number, or zero if the archive gives none.
+        long long getBoard(long long index);
+
+        /// \brief
+        /// Returns the dealer of one deal read, following the board number where the archive names none.
+        ///
+        /// \param index long long - position of the deal among the valid deals, starting from zero.
+        ///
+        /// \return Position - the player dealing, or north if the archive gives neither dealer nor board.
+        Position getDealer(long long index);
+
+        /// \brief
+        /// Tells whether the archive gives the dealer of one deal read, by name or by its board number.
+        ///
+        /// \param index long long - position of the deal among the valid deals, starting from zero.
+        ///
+        /// \return bool - true if the dealer is given.
+        bool hasDealer(long long index);
+
+        /// \brief
+        /// Returns the first problems found, in the order they appear in the archive.
+        ///
+        /// \return const vector<ArchiveError>& - at most MAXARCHIVEERRORS problems.
+        const vector<ArchiveError>& getErrors();
+
+        /// \brief
+        /// Returns the number of problems found, including those not kept.
+        ///
+        /// \return long long - count of problems.
+        long long getNumErrors();
+
+        /// \brief
+        /// Returns the size of the open archive.
+        ///
+        /// \return size_t - bytes in the file.
+        size_t getBytes();
+
+        /// \brief
+        /// Returns the speed of the last parse.
+        ///
+        /// \return double - bytes of archive parsed per second.
+        double getBytesPerSecond();
+
+    private:
+        struct Chunk {
+            const char* begin;
+            const char* end;
+            vector<uint8_t> records;
+            vector<uint32_t> boards;
+            vector<uint8_t> dealers;
+            vector<ArchiveError> errors;
+            long long numErrors = 0;
+        };
+
+        const uint8_t* mapped = NULL;
+        size_t mappedBytes = 0;
+        ArchiveFormat format = PBNFORMAT;
+        vector<Chunk> chunks;
+        atomic<size_t> nextChunk { 0 };
+        double seconds = 0;
+
+        // The valid deals of the whole archive, in the order they appear
+        vector<uint8_t> records;
+        vector<uint32_t> boards;
+        vector<uint8_t> dealers;
+        vector<ArchiveError> errors;
+        long long numErrors = 0;
+
+        /// \brief
+        /// Splits the archive into chunks of about ARCHIVECHUNKBYTES, each starting at a record boundary.
+        void split();
+
+        /// \brief
+        /// Parses chunks until none are left.
+        void worker();
+
+        /// \brief
+        /// Reads the games of a chunk of a PBN archive.
+        ///
+        /// \param chunk Chunk& - the chunk, receiving its deals and problems.
+        void parsePbn(Chunk& chunk);
+
+        /// \brief
+        /// Reads the md tags of a chunk of a LIN archive.
+        ///
+        /// \param chunk Chunk& - the chunk, receiving its deals and problems.
+        void parseLin(Chunk& chunk);
+
+        /// \brief
+        /// Reads the value of a PBN Deal tag, such as "N:AKQ.JT9.876.5432 ...".
+        ///
+        /// \param chunk Chunk& - the chunk, receiving any problem.
+        /// \param value const char* - first character of the value.
+        /// \param end const char* - the closing quote.
+        /// \param deal CardSet[] - receives the cards held by each position.
+        ///
+        /// \return bool - true if the value is a whole valid deal.
+        bool readPbnDeal(Chunk& chunk, const char* value, const char* end, CardSet deal[NUMPOSITIONS]);
+
+        /// \brief
+        /// Reads the value of a LIN md tag, such as "3SAKQHJT9D876C5432,S...,S...,".
+        ///
+        /// \param chunk Chunk& - the chunk, receiving any problem.
+        /// \param value const char* - first character of the value.
+        /// \param end const char* - the bar or line end after the value.
+        /// \param deal CardSet[] - receives the cards held by each position.
+        /// \param dealer Position& - receives the player dealing.
+        ///
+        /// \return bool - true if the value is a whole valid deal.
+        bool readLinDeal(Chunk& chunk, const char* value, const char* end, CardSet deal[NUMPOSITIONS], Position& dealer);
+
+        /// \brief
+        /// Checks that each hand holds 13 cards, reporting the first that does not.
+        ///
+        /// \param chunk Chunk& - the chunk, receiving any problem.
+        /// \param deal const CardSet[] - the cards held by each position.
+        /// \param handStarts const char* const[] - where each position's hand is written.
+        ///
+        /// \return bool - true if every hand holds 13 cards.
+        bool checkHands(Chunk& chunk, const CardSet deal[NUMPOSITIONS], const char* const handStarts[NUMPOSITIONS]);
+
+        /// \brief
+        /// Adds a valid deal to a chunk.
+        ///
+        /// \param chunk Chunk& - the chunk.
+        /// \param deal const CardSet[] - the cards held by each position.
+        /// \param board uint32_t - the board number, or zero if none was given.
+        /// \param dealer uint8_t - the player dealing, or UNKNOWNDEALER if the archive gives none.
+        void addDeal(Chunk& chunk, const CardSet deal[NUMPOSITIONS], uint32_t board, uint8_t dealer);
+
+        /// \brief
+        /// Records a problem found in a chunk.
+        ///
+        /// \param chunk Chunk& - the chunk.
+        /// \param at const char* - the character where the problem was found.
+        /// \param message const string& - what is wrong.
+        void addError(Chunk& chunk, const char* at, const string& message);
+};
+
+#endif // ARCHIVEPARSER_H
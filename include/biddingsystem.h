@@ -0,0 +1,165 @@
+#ifndef BIDDINGSYSTEM_H
+#define BIDDINGSYSTEM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "hand.h"
+
+using namespace std;
+
+/// The values of a hand that the rules of a bidding system test.
+enum SystemFeature {
+    CLUBSFEATURE,
+    DIAMONDSFEATURE,
+    HEARTSFEATURE,
+    SPADESFEATURE,
+    STRENGTHFEATURE,
+    BALANCEDFEATURE,
+    LONGESTFEATURE,
+    LONGESTSUITSFEATURE
+};
+
+const int NUMSYSTEMFEATURES = 8;
+
+/// Number of suit length patterns the opening bid table has a row for: clubs, diamonds and hearts
+/// each from 0 to 13, the spades following from the other three.
+const int NUMBIDSHAPES = 14 * 14 * 14;
+
+/// This class holds a system of opening bids read from rules, one rule per line, tried in order
+/// until one matches the hand; a hand matching none passes. A rule is a bid followed by conditions
+/// that must all hold, and # starts a comment. The bid is pass, a level and strain such as 1S or
+/// 2NT, or a level and one of
+///     longest         the longest suit, the lowest ranking if several are equally long
+///     longest-high    the longest suit, the highest ranking if several are equally long
+///     minor           the longer minor, diamonds if both hold four or more and clubs otherwise
+/// and the conditions are balanced, unbalanced or a value followed by a range written as 15-17,
+/// 5+, 12- or 7, the values being
+///     strength        high card points plus one for every card over four in a suit
+///     clubs|diamonds|hearts|spades   length of the suit
+///     longest         length of the longest suit
+///     longest-suits   number of suits as long as the longest
+/// for example "1NT balanced strength 15-17". A bid depends only on the suit lengths and strength,
+/// so when the rules are compiled they are run once for every shape and strength up to the highest
+/// strength they tell apart, and bidding a hand is then a single lookup in the table built.
+///
+class BiddingSystem
+{
+    public:
+
+        /// \brief
+        /// Creates a system holding the standard rules.
+        BiddingSystem();
+
+        /// \brief
+        /// Reads the rules of a system from a file and compiles them.
+        ///
+        /// \param fileName const string& - name of the file.
+        /// \param error string& - receives a description of the first error found.
+        ///
+        /// \return bool - true if the rules were compiled, false leaving the system unchanged.
+        bool load(const string& fileName, string& error);
+
+        /// \brief
+        /// Compiles the rules of a system, replacing the rules compiled before.
+        ///
+        /// \param text const string& - the rules, one per line.
+        /// \param error string& - receives a description of the first error found.
+        ///
+        /// \return bool - true if the rules were compiled, false leaving the system unchanged.
+        bool compile(const string& text, string& error);
+
+        /// \brief
+        /// Looks up the opening bid of a hand with the given suit lengths and strength.
+        ///
+        /// \param lengths const int[] - number of cards held in each suit, indexed by Suit.
+        /// \param strength int - the high card and length points of the hand.
+        ///
+        /// \return BidCode - the bid that the player should make.
+        inline BidCode openingBid(const int lengths[NUMSUITS], int strength) const {
+            int shapeCode = (lengths[CLUBS] * 14 + lengths[DIAMONDS]) * 14 + lengths[HEARTS];
+            return table[shapeCode * (maxStrength + 1) + min(strength, maxStrength)];
+        }
+
+        /// \brief
+        /// Returns the number of rules in the system.
+        ///
+        /// \return int - count of rules.
+        int getNumRules();
+
+        /// \brief
+        /// Returns a hash of the bids the system makes, which differs between systems bidding any
+        /// hand differently and is kept in files holding bids so that they can tell which system made them.
+        ///
+        /// \return uint64_t - the FNV-1a hash of the bid table and the highest strength it tells apart.
+        uint64_t getHash() const;
+
+        /// \brief
+        /// Returns the rules of the standard system, which every system starts with.
+        ///
+        /// \return string - the rules, one per line.
+        static string standardRules();
+
+        /// \brief
+        /// Returns the system used by every hand to decide its opening bid.
+        ///
+        /// \return const BiddingSystem& - the system set last, or the standard system if none was set.
+        static inline const BiddingSystem& active() {
+            return activeSystem != NULL ? *activeSystem : standard();
+        }
+
+        /// \brief
+        /// Makes every hand decide its opening bid by a system. It should be set before any
+        /// thread starts bidding, and the system must be kept for as long as hands are bid.
+        ///
+        /// \param system const BiddingSystem& - the system.
+        static void setActive(const BiddingSystem& system);
+
+    private:
+
+        // Strains above no trumps stand for a suit chosen by the hand's lengths
+        enum Strain { LONGESTSTRAIN = NUMSUITS + 1, LONGESTHIGHSTRAIN, MINORSTRAIN };
+
+        // A condition passes when the feature lies from low to high
+        struct Condition {
+            uint8_t feature;
+            uint8_t low;
+            uint8_t high;
+        };
+
+        // A rule is its conditions, taken from a flat array, and the bid made when they all pass
+        struct Rule {
+            int firstCondition;
+            int numConditions;
+            int level;
+            int strain;
+        };
+
+        vector<Condition> conditions;
+        vector<Rule> rules;
+        vector<BidCode> table;
+        int maxStrength = 0;
+        uint64_t hash = 0;
+
+        static const BiddingSystem* activeSystem;
+
+        /// \brief
+        /// Returns the standard system, compiling it the first time it is needed.
+        ///
+        /// \return const BiddingSystem& - the standard system.
+        static const BiddingSystem& standard();
+
+        /// \brief
+        /// Runs the rules for a hand with the given features and works out the bid of the first that matches.
+        ///
+        /// \param features const int[] - the value of each SystemFeature.
+        ///
+        /// \return BidCode - the bid, or PASSBID if no rule matches.
+        BidCode decide(const int features[NUMSYSTEMFEATURES]) const;
+
+        /// \brief
+        /// Fills the table with the bid for every shape and strength, and hashes it.
+        void buildTable();
+};
+
+#endif // BIDDINGSYSTEM_H
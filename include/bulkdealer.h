@@ -0,0 +1,75 @@
+#ifndef BULKDEALER_H
+#define BULKDEALER_H
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "deck.h"
+
+using namespace std;
+
+const int DEALSPERCHUNK = 4096;
+
+/// This class generates a large number of shuffled deals across several threads. Deals are produced in
+/// chunks by workers each owning their own deck, every deal shuffled from the random stream numbered
+/// by the deal, and the chunks are written out in deal order. Each deal is written as one line of
+/// 52 cards in the format read by the game input stream.
+///
+class BulkDealer
+{
+    public:
+
+        /// \brief
+        /// Sets up a generator for the given number of deals.
+        ///
+        /// \param numDeals long long - total number of deals to be generated.
+        /// \param seed unsigned long long - seed from which every deal's random stream is derived.
+        /// \param numThreads int - number of worker threads shuffling deals.
+        BulkDealer(long long numDeals, unsigned long long seed, int numThreads);
+
+        /// \brief
+        /// Generates every deal on the worker threads and writes them to the output stream in deal order.
+        ///
+        /// \param out ostream& - output stream receiving the deals.
+        void run(ostream& out);
+
+        /// \brief
+        /// Returns the throughput of the last run.
+        ///
+        /// \return double - deals generated per second.
+        double getDealsPerSecond();
+
+    private:
+        struct Chunk {
+            string text;
+            bool filled = false;
+            mutex lock;
+            condition_variable changed;
+        };
+
+        long long numDeals;
+        unsigned long long seed;
+        int numThreads;
+        long long numChunks;
+        vector<Chunk> chunks;
+        double dealsPerSecond = 0;
+
+        /// \brief
+        /// Generates every chunk belonging to one worker thread, waiting for the writer to empty
+        /// the chunk's slot before reusing it.
+        ///
+        /// \param threadIndex int - index of the worker, which handles every chunk equal to it modulo the thread count.
+        void worker(int threadIndex);
+
+        /// \brief
+        /// Shuffles and formats all deals of one chunk.
+        ///
+        /// \param chunkIndex long long - index of the chunk.
+        /// \param deck Deck& - the worker's own deck.
+        /// \param text string& - buffer receiving the formatted deals.
+        void generateChunk(long long chunkIndex, Deck& deck, string& text);
+};
+
+#endif // BULKDEALER_H
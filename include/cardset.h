@@ -0,0 +1,110 @@
+#ifndef CARDSET_H
+#define CARDSET_H
+
+#include <cstdint>
+#include "card.h"
+
+/// A set of cards packed into a 64-bit integer holding one 16-bit mask per suit.
+/// Within a suit mask bit n is set when the card of rank n is held, so only bits
+/// 2 (TWO) to 14 (ACE) are ever used. Clubs occupy the lowest 16 bits and spades the highest.
+typedef uint64_t CardSet;
+
+/// A single suit's 16-bit mask taken from a card set.
+typedef uint16_t Holding;
+
+const int SUITBITS = 16;
+const Holding FULLSUIT = 0x7FFC;
+const CardSet ALLCARDS = 0x7FFC7FFC7FFC7FFCULL;
+
+/// The aces, kings, queens and jacks of every suit.
+const CardSet ACES = 0x4000400040004000ULL;
+const CardSet KINGS = ACES >> 1;
+const CardSet QUEENS = ACES >> 2;
+const CardSet JACKS = ACES >> 3;
+
+/// \brief
+/// Returns the card set containing only the given card.
+///
+/// \param rank Rank - rank of the card.
+/// \param suit Suit - suit of the card.
+///
+/// \return CardSet - a set with the single bit of the card set.
+inline CardSet cardBit(Rank rank, Suit suit) {
+    return (CardSet) 1 << ((int) suit * SUITBITS + (int) rank);
+}
+
+/// \brief
+/// Returns the mask of ranks held in one suit of a card set.
+///
+/// \param cards CardSet - the set of cards.
+/// \param suit Suit - the suit to extract.
+///
+/// \return Holding - bit n is set when the card of rank n is held in the suit.
+inline Holding suitHolding(CardSet cards, Suit suit) {
+    return (Holding) (cards >> ((int) suit * SUITBITS));
+}
+
+/// \brief
+/// Counts the cards held in a suit mask.
+///
+/// \param holding Holding - the suit mask to count.
+///
+/// \return int - number of cards in the suit.
+inline int holdingLength(Holding holding) {
+    return __builtin_popcount(holding);
+}
+
+/// \brief
+/// Counts the cards held in one suit of a card set.
+///
+/// \param cards CardSet - the set of cards.
+/// \param suit Suit - the suit to count.
+///
+/// \return int - number of cards of the suit in the set.
+inline int suitLength(CardSet cards, Suit suit) {
+    return holdingLength(suitHolding(cards, suit));
+}
+
+/// \brief
+/// Counts all cards in a card set.
+///
+/// \param cards CardSet - the set of cards.
+///
+/// \return int - number of cards in the set.
+inline int cardCount(CardSet cards) {
+    return __builtin_popcountll(cards);
+}
+
+/// \brief
+/// Counts the high card points of a card set, four for each ace down to one for each jack.
+///
+/// \param cards CardSet - the set of cards.
+///
+/// \return int - the high card points of the set.
+inline int highCardPoints(CardSet cards) {
+    return 4 * cardCount(cards & ACES) + 3 * cardCount(cards & KINGS)
+           + 2 * cardCount(cards & QUEENS) + cardCount(cards & JACKS);
+}
+
+/// \brief
+/// Returns the high card points of a single card, four for an ace down to one for a jack.
+///
+/// \param card int - bit index of the card in a card set.
+///
+/// \return int - the high card points of the card.
+inline int cardPoints(int card) {
+    int rank = card % SUITBITS;
+    return rank > TEN ? rank - TEN : 0;
+}
+
+/// \brief
+/// Returns the highest rank held in a non-empty suit mask.
+///
+/// \param holding Holding - a suit mask with at least one bit set.
+///
+/// \return Rank - the highest rank in the mask.
+inline Rank highestRank(Holding holding) {
+    return (Rank) (31 - __builtin_clz(holding));
+}
+
+#endif // CARDSET_H
@@ -0,0 +1,224 @@
+#ifndef DEALFILE_H
+#define DEALFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "cardset.h"
+#include "game.h"
+
+using namespace std;
+
+/// Bytes taken by one deal in a binary deal file: two bits naming the holder of each of the 52 cards.
+const int DEALBYTES = 13;
+const uint16_t DEALFILEVERSION = 1;
+
+/// Version of the deal files that also store each deal's board and dealer, written only when the
+/// deals are not numbered on from the first board.
+const uint16_t DEALFILEBOARDSVERSION = 2;
+const int WRITEBUFFERBYTES = 1 << 20;
+
+/// The header at the start of a binary deal file, stored in little-endian byte order. In a version 1
+/// file deal k is board firstBoard + k, dealt by the player the board number gives (board 1 by north,
+/// board 2 by east and so on). A version 2 file follows the deals with the board number of each deal
+/// as a uint32_t and then the dealer of each deal as one byte.
+struct DealFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t dealBytes;
+    uint32_t firstBoard;
+    uint32_t reserved;
+    uint64_t numDeals;
+};
+
+/// \brief
+/// Packs a deal into its binary form, card n of new deck order (clubs to spades, two to ace) taking
+/// bits 2n and 2n+1 with the position holding it.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param record uint8_t[] - receives the packed deal.
+void packDeal(const CardSet deal[NUMPOSITIONS], uint8_t record[DEALBYTES]);
+
+/// \brief
+/// Unpacks a deal from its binary form.
+///
+/// \param record const uint8_t[] - the packed deal.
+/// \param deal CardSet[] - receives the cards held by each position.
+void unpackDeal(const uint8_t record[DEALBYTES], CardSet deal[NUMPOSITIONS]);
+
+/// \brief
+/// Reads a deal written as 52 cards in the format read by the game input stream.
+///
+/// \param in istream& - input stream holding the deal.
+/// \param dealer Position - the player dealing, whose left hand opponent receives the first card.
+/// \param deal CardSet[] - receives the cards held by each position.
+///
+/// \return bool - true if 52 different cards were read.
+bool readTextDeal(istream& in, Position dealer, CardSet deal[NUMPOSITIONS]);
+
+/// \brief
+/// Writes a deal as one line of 52 cards in the format read by the game input stream, so that a game
+/// with the given dealer deals each card back to the hand it came from.
+///
+/// \param out ostream& - output stream receiving the deal.
+/// \param dealer Position - the player dealing, whose left hand opponent receives the first card.
+/// \param deal const CardSet[] - the cards held by each position.
+void writeTextDeal(ostream& out, Position dealer, const CardSet deal[NUMPOSITIONS]);
+
+/// \brief
+/// Reads a hand written as its spade, heart, diamond and club ranks separated by dots, such as
+/// "AK32.QJ4.T9.8765", a void being left empty or written as a dash.
+///
+/// \param text const string& - the hand.
+/// \param hand CardSet& - receives the cards of the hand.
+///
+/// \return bool - true if the text is four suits of different ranks.
+bool readDottedHand(const string& text, CardSet& hand);
+
+/// \brief
+/// Maps the whole of a file into memory for reading.
+///
+/// \param fileName const string& - name of the file.
+/// \param bytes size_t& - receives the size of the file.
+/// \param error string& - receives a description of the problem if the file cannot be mapped.
+///
+/// \return const uint8_t* - the first byte of the file, or NULL if it could not be mapped or is empty.
+const uint8_t* mapFile(const string& fileName, size_t& bytes, string& error);
+
+/// \brief
+/// Unmaps a file mapped by mapFile.
+///
+/// \param mapped const uint8_t* - the first byte of the file, or NULL if nothing is mapped.
+/// \param bytes size_t - size of the file.
+void unmapFile(const uint8_t* mapped, size_t bytes);
+
+/// This class writes a binary deal file, packing each deal into 13 bytes and writing them out
+/// a megabyte at a time. The number of deals in the header is filled in when the file is closed.
+/// Boards and dealers are only kept per deal, and written after the deals as a version 2 file,
+/// once a deal is given a board or dealer other than the one numbering on from the first board.
+///
+class DealWriter
+{
+    public:
+
+        /// \brief
+        /// Creates a writer with no file open.
+        DealWriter();
+
+        /// \brief
+        /// Closes the file if it is still open.
+        ~DealWriter();
+
+        /// \brief
+        /// Creates a binary deal file, replacing any file of the same name.
+        ///
+        /// \param fileName const string& - name of the file.
+        /// \param firstBoard unsigned int - board number of the first deal.
+        ///
+        /// \return bool - true if the file was created.
+        bool open(const string& fileName, unsigned int firstBoard = 1);
+
+        /// \brief
+        /// Adds a deal to the file, numbered on from the board of the deal before.
+        ///
+        /// \param deal const CardSet[] - the cards held by each position.
+        void write(const CardSet deal[NUMPOSITIONS]);
+
+        /// \brief
+        /// Adds a deal to the file with its own board number and dealer.
+        ///
+        /// \param deal const CardSet[] - the cards held by each position.
+        /// \param board unsigned int - board number of the deal.
+        /// \param dealer Position - the player dealing.
+        void write(const CardSet deal[NUMPOSITIONS], unsigned int board, Position dealer);
+
+        /// \brief
+        /// Writes out any buffered deals and any boards kept, records the number of deals in the header and
+        /// closes the file.
+        ///
+        /// \return bool - true if everything was written.
+        bool close();
+
+    private:
+        ofstream out;
+        vector<uint8_t> buffer;
+        size_t buffered = 0;
+        DealFileHeader header;
+        vector<uint32_t> boards;
+        vector<uint8_t> dealers;
+
+        /// \brief
+        /// Writes the buffered deals to the file.
+        void flush();
+};
+
+/// This class reads a binary deal file by mapping it into memory, so that any deal can be taken
+/// straight from its 13 bytes by index without reading or parsing the rest of the file.
+///
+class DealReader
+{
+    public:
+
+        /// \brief
+        /// Creates a reader with no file open.
+        DealReader();
+
+        /// \brief
+        /// Unmaps the file if it is still open.
+        ~DealReader();
+
+        /// \brief
+        /// Maps a binary deal file into memory and checks its header.
+        ///
+        /// \param fileName const string& - name of the file.
+        /// \param error string& - receives a description of the problem if the file cannot be used.
+        ///
+        /// \return bool - true if the file was opened.
+        bool open(const string& fileName, string& error);
+
+        /// \brief
+        /// Unmaps the file.
+        void close();
+
+        /// \brief
+        /// Returns the number of deals in the file.
+        ///
+        /// \return long long - count of deals.
+        long long getNumDeals();
+
+        /// \brief
+        /// Unpacks one deal of the file.
+        ///
+        /// \param index long long - position of the deal in the file, starting from zero.
+        /// \param deal CardSet[] - receives the cards held by each position.
+        void getDeal(long long index, CardSet deal[NUMPOSITIONS]);
+
+        /// \brief
+        /// Returns the board number of one deal of the file.
+        ///
+        /// \param index long long - position of the deal in the file, starting from zero.
+        ///
+        /// \return long long - the board number.
+        long long getBoard(long long index);
+
+        /// \brief
+        /// Returns the dealer of one deal of the file, following the board number unless the file stores it.
+        ///
+        /// \param index long long - position of the deal in the file, starting from zero.
+        ///
+        /// \return Position - the player dealing.
+        Position getDealer(long long index);
+
+    private:
+        const uint8_t* mapped = NULL;
+        size_t mappedBytes = 0;
+        const uint8_t* records = NULL;
+        const uint8_t* boards = NULL;
+        const uint8_t* dealers = NULL;
+        long long numDeals = 0;
+        uint32_t firstBoard = 1;
+};
+
+#endif // DEALFILE_H
@@ -0,0 +1,200 @@
+#ifndef DEALFILTER_H
+#define DEALFILTER_H
+
+#include <bitset>
+#include <string>
+#include <vector>
+#include "cardset.h"
+#include "game.h"
+
+using namespace std;
+
+/// Number of suit length patterns a single hand can be given a code for: spades, hearts and diamonds
+/// each from 0 to 13, the clubs following from the other three.
+const int NUMSHAPECODES = 14 * 14 * 14;
+const int CALIBRATIONDEALS = 2000;
+
+/// This class compiles a constraint expression into a filter over the four hands of a deal and
+/// deals random hands that satisfy it. An expression combines predicates with and, or, not and
+/// brackets. Each predicate names a seat (N, E, S or W) or a partnership (NS or EW) followed by
+/// one of
+///     hcp RANGE                       high card points, counting the cards of both partners together
+///     spades|hearts|diamonds|clubs RANGE   length of the suit
+///     balanced                        a single seat holding 4333 or 4432 in any order
+///     shape PATTERN [+ PATTERN ...]   a single seat's spade, heart, diamond and club lengths,
+///                                     x matching any length and any allowing the suits in any order
+/// where a RANGE is written as 15-17, 5+ (at least), 12- (at most) or 7 (exactly), for example
+/// "N hcp 15-17 and N balanced and S spades 5+". The terms joined by and at the top level are
+/// checked separately: once the filter is compiled, random deals are used to estimate how often
+/// each term passes, the seats are dealt in the order expected to reject a failing deal soonest
+/// and the terms are checked as soon as all their seats are dealt, cheapest and most selective first.
+/// Hands are dealt one at a time, so a deal is given up as soon as a term fails without dealing
+/// the remaining hands.
+///
+class DealFilter
+{
+    public:
+
+        /// \brief
+        /// Creates a filter accepting every deal.
+        DealFilter();
+
+        /// \brief
+        /// Compiles a constraint expression, replacing any expression compiled before.
+        ///
+        /// \param expression const string& - the constraints the deals must satisfy.
+        /// \param error string& - receives a description of the first error found.
+        ///
+        /// \return bool - true if the expression was compiled, false if it is not valid.
+        bool compile(const string& expression, string& error);
+
+        /// \brief
+        /// Deals one deal from the random stream numbered by the deal and checks it against the filter,
+        /// so that deal k of a seed is always the same whatever deals were tried before it.
+        ///
+        /// \param seed unsigned long long - seed of the run the deal belongs to.
+        /// \param dealNumber unsigned long long - number of the deal within the run.
+        /// \param deal CardSet[] - receives the cards held by each position if the deal is accepted.
+        ///
+        /// \return bool - true if the deal satisfies every constraint.
+        bool generate(unsigned long long seed, unsigned long long dealNumber, CardSet deal[NUMPOSITIONS]);
+
+        /// \brief
+        /// Checks a complete deal against the filter.
+        ///
+        /// \param deal const CardSet[] - the cards held by each position.
+        ///
+        /// \return bool - true if the deal satisfies every constraint.
+        bool accepts(const CardSet deal[NUMPOSITIONS]);
+
+        /// \brief
+        /// Returns the number of hands dealt by generate since the filter was compiled.
+        ///
+        /// \return long long - count of hands dealt, including those of rejected deals.
+        long long getHandsDealt();
+
+    private:
+        enum NodeKind { AND, OR, NOT, HCP, LENGTH, SHAPE };
+
+        struct Node {
+            NodeKind kind;
+            int seats = 0;
+            int suit = 0;
+            int low = 0;
+            int high = 0;
+            int shape = 0;
+            vector<int> children;
+        };
+
+        struct Term {
+            int node;
+            int seats;
+            double cost;
+            double passRate;
+        };
+
+        vector<Node> nodes;
+        vector<bitset<NUMSHAPECODES> > shapes;
+        vector<Term> terms;
+        int seatOrder[NUMPOSITIONS];
+        vector<int> stageTerms[NUMPOSITIONS];
+        long long handsDealt = 0;
+
+        vector<string> tokens;
+        size_t nextToken;
+        string parseError;
+
+        /// \brief
+        /// Parses terms joined by or.
+        ///
+        /// \return int - index of the node built, or -1 on error.
+        int parseOr();
+
+        /// \brief
+        /// Parses terms joined by and.
+        ///
+        /// \return int - index of the node built, or -1 on error.
+        int parseAnd();
+
+        /// \brief
+        /// Parses a negated term, a bracketed expression or a single predicate.
+        ///
+        /// \return int - index of the node built, or -1 on error.
+        int parseTerm();
+
+        /// \brief
+        /// Parses a predicate on a seat or partnership.
+        ///
+        /// \return int - index of the node built, or -1 on error.
+        int parsePredicate();
+
+        /// \brief
+        /// Parses a range of values such as 15-17, 5+, 12- or 7.
+        ///
+        /// \param node Node& - receives the lowest and highest values allowed.
+        ///
+        /// \return bool - true if a range was read.
+        bool parseRange(Node& node);
+
+        /// \brief
+        /// Adds a shape pattern such as 5xxx or any 4432 to a set of allowed shapes.
+        ///
+        /// \param pattern const string& - four lengths in spade, heart, diamond, club order, x matching any.
+        /// \param anyOrder bool - whether the lengths may be held in any of the suits.
+        /// \param allowed bitset& - the shape codes to add to.
+        ///
+        /// \return bool - true if the pattern was valid.
+        bool addShape(const string& pattern, bool anyOrder, bitset<NUMSHAPECODES>& allowed);
+
+        /// \brief
+        /// Returns the next token without consuming it.
+        ///
+        /// \return string - the token, or an empty string at the end of the expression.
+        string peek();
+
+        /// \brief
+        /// Records a parse error at the current token.
+        ///
+        /// \param message const string& - description of what was expected.
+        ///
+        /// \return int - always -1 so that parse functions can return the result directly.
+        int fail(const string& message);
+
+        /// \brief
+        /// Splits the top level and of the expression into separately checked terms and estimates the cost
+        /// and pass rate of each.
+        ///
+        /// \param root int - index of the root node.
+        void buildTerms(int root);
+
+        /// \brief
+        /// Chooses the seat order and the terms checked after each seat is dealt.
+        void planStages();
+
+        /// \brief
+        /// Estimates the work done checking a node.
+        ///
+        /// \param node int - index of the node.
+        ///
+        /// \return double - cost in units of one suit length test.
+        double nodeCost(int node);
+
+        /// \brief
+        /// Finds the seats whose cards a node reads.
+        ///
+        /// \param node int - index of the node.
+        ///
+        /// \return int - a bit mask of positions.
+        int nodeSeats(int node);
+
+        /// \brief
+        /// Checks a node against the hands dealt.
+        ///
+        /// \param node int - index of the node.
+        /// \param deal const CardSet[] - the cards held by each position, at least those the node reads.
+        ///
+        /// \return bool - true if the node is satisfied.
+        bool evaluate(int node, const CardSet deal[NUMPOSITIONS]);
+};
+
+#endif // DEALFILTER_H
@@ -0,0 +1,157 @@
+#ifndef DEALINDEX_H
+#define DEALINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "dealfile.h"
+#include "game.h"
+#include "hand.h"
+
+using namespace std;
+
+const uint16_t DEALINDEXVERSION = 2;
+
+/// Deals evaluated and written at a time when an index is built, a multiple of 64.
+const int INDEXBLOCKDEALS = 1 << 16;
+
+/// Every column and bitmap of an index starts on a multiple of this many bytes.
+const size_t INDEXALIGNBYTES = 64;
+
+/// The header at the start of an index file, stored in little-endian byte order. Besides the size
+/// of the deal file indexed and the hash of the bidding system its bids were made by, it counts how
+/// many deals take each value of each feature, from which the number of deals passing a predicate is
+/// known before any column is read.
+struct DealIndexHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t firstBoard;
+    uint64_t numDeals;
+    uint64_t systemHash;
+    uint64_t hcpCounts[NUMPOSITIONS][MAXHCP + 1];
+    uint64_t lengthCounts[NUMPOSITIONS][NUMSUITS][NUMRANKS + 1];
+    uint64_t balancedCounts[NUMPOSITIONS];
+    uint64_t bidCounts[NUMPOSITIONS][NUMBIDCODES];
+    uint64_t openingCounts[NUMPOSITIONS][NUMBIDCODES];
+};
+
+/// This class answers questions such as "South 5-5 in the majors with 10-12 points and the opening
+/// bid 1S" over a binary deal file without reading its deals. The index is built once from the deal
+/// file and holds, for every deal, each seat's high card points, four suit lengths, balanced flag and
+/// the bid its hand would open with, and the deal's opening bid and the seat making it. Each of these
+/// is a column of one byte per deal, and the balanced flags and opening bids are also kept as bitmaps
+/// of one bit per deal. The file is mapped into memory when opened. The bids are those of the bidding
+/// system active when the index is built, and the index can only be opened while that system is active.
+///
+/// A query is predicates joined by and, each one of
+///     SEAT hcp RANGE                              high card points
+///     SEAT spades|hearts|diamonds|clubs RANGE     length of the suit
+///     SEAT balanced                               a hand the opening bid treats as balanced
+///     SEAT bid BID                                the bid the seat's hand opens with if first to speak
+///     [SEAT] opening BID                          the opening bid of the auction, made by the seat if named
+/// where a SEAT is N, E, S or W, a RANGE is written as 15-17, 5+, 12- or 7 and a BID as 1S, 3NT or pass.
+/// The predicates are checked in order of how few deals the header counts passing each, and a block
+/// of 64 deals is only read from a column while some of its deals still pass every predicate before.
+///
+class DealIndex
+{
+    public:
+
+        /// \brief
+        /// Creates an index with no file open.
+        DealIndex();
+
+        /// \brief
+        /// Unmaps the index if it is still open.
+        ~DealIndex();
+
+        /// \brief
+        /// Evaluates every deal of a binary deal file, dealt by its dealer, and writes the index.
+        ///
+        /// \param dealFile const string& - name of the binary deal file.
+        /// \param indexFile const string& - name of the index file to write.
+        /// \param error string& - receives a description of the problem if the index cannot be built.
+        ///
+        /// \return bool - true if the index was written.
+        static bool build(const string& dealFile, const string& indexFile, string& error);
+
+        /// \brief
+        /// Maps an index file into memory and checks its header, including that its bids were made by
+        /// the active bidding system.
+        ///
+        /// \param indexFile const string& - name of the index file.
+        /// \param error string& - receives a description of the problem if the index cannot be used.
+        ///
+        /// \return bool - true if the index was opened.
+        bool open(const string& indexFile, string& error);
+
+        /// \brief
+        /// Unmaps the index.
+        void close();
+
+        /// \brief
+        /// Returns the number of deals indexed.
+        ///
+        /// \return long long - count of deals.
+        long long getNumDeals();
+
+        /// \brief
+        /// Finds the deals satisfying every predicate of a query.
+        ///
+        /// \param query const string& - predicates joined by and.
+        /// \param matches vector<long long>& - receives the positions in the deal file of the deals found, in order.
+        /// \param error string& - receives a description of the first error found in the query.
+        ///
+        /// \return bool - true if the query was valid.
+        bool find(const string& query, vector<long long>& matches, string& error);
+
+    private:
+
+        // A predicate is either a bitmap or a range of values of a column
+        struct Predicate {
+            int bitmap = -1;
+            int column = -1;
+            int low = 0;
+            int high = 0;
+            uint64_t estimate = 0;
+        };
+
+        const uint8_t* mapped = NULL;
+        size_t mappedBytes = 0;
+        const DealIndexHeader* header = NULL;
+        vector<const uint8_t*> columns;
+        vector<const uint64_t*> bitmaps;
+
+        /// \brief
+        /// Works out where each column and bitmap of an index of the given size starts.
+        ///
+        /// \param numDeals uint64_t - number of deals indexed.
+        /// \param columnOffsets vector<size_t>& - receives the offset of each column.
+        /// \param bitmapOffsets vector<size_t>& - receives the offset of each bitmap.
+        ///
+        /// \return size_t - size of the whole file.
+        static size_t layout(uint64_t numDeals, vector<size_t>& columnOffsets, vector<size_t>& bitmapOffsets);
+
+        /// \brief
+        /// Reads a query into predicates, working out how many deals each passes.
+        ///
+        /// \param query const string& - predicates joined by and.
+        /// \param predicates vector<Predicate>& - receives the predicates.
+        /// \param error string& - receives a description of the first error found.
+        ///
+        /// \return bool - true if the query was valid.
+        bool parse(const string& query, vector<Predicate>& predicates, string& error);
+
+        /// \brief
+        /// Clears the bits of the deals in one block of 64 that fail a predicate.
+        ///
+        /// \param predicate const Predicate& - the predicate.
+        /// \param word size_t - the block, deals 64 * word onwards.
+        /// \param bits uint64_t - the deals of the block still passing.
+        ///
+        /// \return uint64_t - the deals of the block passing the predicate as well.
+        uint64_t match(const Predicate& predicate, size_t word, uint64_t bits);
+};
+
+#endif // DEALINDEX_H
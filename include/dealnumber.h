@@ -0,0 +1,100 @@
+#ifndef DEALNUMBER_H
+#define DEALNUMBER_H
+
+#include <cstdint>
+#include <string>
+#include "cardset.h"
+#include "game.h"
+#include "random.h"
+
+using namespace std;
+
+/// The number of a deal, from 0 to NUMDEALNUMBERS - 1, which needs 96 bits.
+typedef unsigned __int128 DealNumber;
+
+/// Bytes taken by a deal number when stored, lowest byte first.
+const int DEALNUMBERBYTES = 12;
+
+/// Ways of choosing 13 of 52, 13 of 39 and 13 of 26 cards.
+const uint64_t NORTHCHOICES = 635013559600ULL;
+const uint64_t EASTCHOICES = 8122425444ULL;
+const uint64_t SOUTHCHOICES = 10400600ULL;
+
+/// The number of different deals, 52! / (13!)^4.
+const DealNumber NUMDEALNUMBERS = (DealNumber) NORTHCHOICES * EASTCHOICES * SOUTHCHOICES;
+
+/// Binomial coefficients up to 52 choose 13.
+struct BinomialTable {
+    uint64_t choose[NUMCARDS + 1][NUMRANKS + 1];
+
+    constexpr BinomialTable() : choose() {
+        for (int n = 0; n <= NUMCARDS; n++) {
+            choose[n][0] = 1;
+            for (int k = 1; k <= NUMRANKS && k <= n; k++) {
+                choose[n][k] = choose[n - 1][k - 1] + choose[n - 1][k];
+            }
+        }
+    }
+};
+
+/// The binomial coefficients, worked out when the program is compiled.
+extern const BinomialTable BINOMIALS;
+
+/// \brief
+/// Numbers a deal. North's cards are numbered among the 52 cards, east's among the 39 left and south's
+/// among the 26 left after that, each set of 13 by the combinatorial number system, and the three
+/// numbers are combined so that every deal has a different number below NUMDEALNUMBERS.
+///
+/// \param deal const CardSet[] - the cards held by each position, 13 each.
+///
+/// \return DealNumber - the number of the deal.
+DealNumber rankDeal(const CardSet deal[NUMPOSITIONS]);
+
+/// \brief
+/// Builds the deal with the given number.
+///
+/// \param number DealNumber - a number below NUMDEALNUMBERS.
+/// \param deal CardSet[] - receives the cards held by each position.
+void unrankDeal(DealNumber number, CardSet deal[NUMPOSITIONS]);
+
+/// \brief
+/// Draws a deal number uniformly, so that unranking it gives every deal with equal chance.
+///
+/// \param randomizer Random& - source of the random bits.
+///
+/// \return DealNumber - a number below NUMDEALNUMBERS.
+DealNumber randomDealNumber(Random& randomizer);
+
+/// \brief
+/// Writes a deal number in decimal.
+///
+/// \param number DealNumber - the number.
+///
+/// \return string - the decimal digits.
+string dealNumberToString(DealNumber number);
+
+/// \brief
+/// Reads a deal number written in decimal.
+///
+/// \param text const string& - the decimal digits.
+/// \param number DealNumber& - receives the number.
+///
+/// \return bool - true if the text is a number below NUMDEALNUMBERS.
+bool parseDealNumber(const string& text, DealNumber& number);
+
+/// \brief
+/// Stores a deal number in DEALNUMBERBYTES bytes, lowest byte first.
+///
+/// \param number DealNumber - the number.
+/// \param bytes uint8_t[] - receives the stored number.
+void storeDealNumber(DealNumber number, uint8_t bytes[DEALNUMBERBYTES]);
+
+/// \brief
+/// Loads a deal number stored by storeDealNumber.
+///
+/// \param bytes const uint8_t[] - the stored number.
+///
+/// \return DealNumber - the number.
+DealNumber loadDealNumber(const uint8_t bytes[DEALNUMBERBYTES]);
+
+#endif // DEALNUMBER_H
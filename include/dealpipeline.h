@@ -0,0 +1,157 @@
+#ifndef DEALPIPELINE_H
+#define DEALPIPELINE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "cardset.h"
+#include "dealrenderer.h"
+#include "game.h"
+#include "handbatch.h"
+#include "spscring.h"
+
+using namespace std;
+
+/// The stages of the pipeline, in the order a batch of deals passes through them.
+enum PipelineStage {
+    GENERATESTAGE,
+    EVALUATESTAGE,
+    FORMATSTAGE,
+    WRITESTAGE
+};
+
+const int NUMSTAGES = 4;
+
+/// Deals passed between stages at a time.
+const int PIPELINEBATCH = 256;
+
+/// What the threads of one stage have done, so that the stage holding the others up can be found.
+struct StageCounters {
+    long long batches = 0;
+
+    // Time spent working, waiting for a batch to arrive and waiting for room in the next stage's queue
+    double busySeconds = 0;
+    double starvedSeconds = 0;
+    double blockedSeconds = 0;
+
+    // Fraction of the input queue filled each time a batch is taken, added up
+    double fillTotal = 0;
+};
+
+/// This class deals, bids and writes a large number of deals through a pipeline of four stages:
+/// generation shuffles and deals each deal from the random stream numbered by the deal, evaluation
+/// finds each deal's opening bid, formatting lays the deals out as text and writing sends the text
+/// out in deal order. Each of the first three stages runs on as many threads as asked, and every
+/// thread of one stage is joined to every thread of the next by its own single-producer single-consumer
+/// ring of batches. Batch b is handled by thread b modulo the thread count at each stage and each
+/// thread takes its batches in order, so every ring delivers exactly the batch its consumer wants next
+/// and the output is the same whatever the parallelism. A full ring holds its producer back, which
+/// bounds the batches in flight, and written batches are handed back to their generator for reuse.
+///
+class DealPipeline
+{
+    public:
+
+        /// \brief
+        /// Sets up a pipeline for the given number of deals, with one thread per stage.
+        ///
+        /// \param numDeals long long - total number of deals.
+        /// \param seed unsigned long long - seed from which every deal's random stream is derived.
+        /// \param layout Layout - how each deal is laid out.
+        DealPipeline(long long numDeals, unsigned long long seed, Layout layout);
+
+        /// \brief
+        /// Sets the number of threads of the generation, evaluation or formatting stage. Writing
+        /// always has one thread, as the output is written in order.
+        ///
+        /// \param stage PipelineStage - the stage.
+        /// \param numThreads int - number of threads, at least one.
+        void setParallelism(PipelineStage stage, int numThreads);
+
+        /// \brief
+        /// Runs every stage, writing on the calling thread.
+        ///
+        /// \param out ostream& - output stream receiving the deals.
+        void run(ostream& out);
+
+        /// \brief
+        /// Returns the throughput of the last run.
+        ///
+        /// \return double - deals written per second.
+        double getDealsPerSecond();
+
+        /// \brief
+        /// Writes a table of each stage's threads, batches, share of time busy, starved and blocked,
+        /// how full its input queue ran and the deals per second it could manage if never kept waiting.
+        ///
+        /// \param out ostream& - output stream receiving the table.
+        void printCounters(ostream& out);
+
+    private:
+        struct DealBatch {
+            long long index;
+            int count;
+            CardSet deals[PIPELINEBATCH][NUMPOSITIONS];
+            BidCode bids[PIPELINEBATCH];
+            Position openers[PIPELINEBATCH];
+            string text;
+        };
+
+        long long numDeals;
+        unsigned long long seed;
+        Layout layout;
+        long long numBatches = 0;
+        int numThreads[NUMSTAGES] = { 1, 1, 1, 1 };
+        double seconds = 0;
+
+        // rings[s] joins each thread of stage s - 1 to each thread of stage s, and rings[GENERATESTAGE]
+        // returns written batches from the writer to their generator
+        vector<SpscRing<DealBatch*>> rings[NUMSTAGES];
+
+        // One set of counters for each thread of each stage
+        vector<StageCounters> counters[NUMSTAGES];
+
+        /// \brief
+        /// Shuffles and deals the batches of one generation thread.
+        ///
+        /// \param thread int - index of the thread within the stage.
+        void generate(int thread);
+
+        /// \brief
+        /// Finds the opening bids of the batches of one evaluation thread.
+        ///
+        /// \param thread int - index of the thread within the stage.
+        void evaluate(int thread);
+
+        /// \brief
+        /// Lays out the batches of one formatting thread.
+        ///
+        /// \param thread int - index of the thread within the stage.
+        void format(int thread);
+
+        /// \brief
+        /// Writes every batch in order and hands each back to its generator.
+        ///
+        /// \param out ostream& - output stream receiving the deals.
+        void write(ostream& out);
+
+        /// \brief
+        /// Waits for a batch to arrive from the stage before.
+        ///
+        /// \param stage PipelineStage - the stage receiving the batch.
+        /// \param batchIndex long long - the batch wanted.
+        /// \param thread int - index of the receiving thread within the stage.
+        ///
+        /// \return DealBatch* - the batch.
+        DealBatch* receive(PipelineStage stage, long long batchIndex, int thread);
+
+        /// \brief
+        /// Waits for room to pass a batch on to the stage after.
+        ///
+        /// \param stage PipelineStage - the stage sending the batch.
+        /// \param batch DealBatch* - the batch.
+        /// \param thread int - index of the sending thread within the stage.
+        void send(PipelineStage stage, DealBatch* batch, int thread);
+};
+
+#endif // DEALPIPELINE_H
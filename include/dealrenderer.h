@@ -0,0 +1,94 @@
+#ifndef DEALRENDERER_H
+#define DEALRENDERER_H
+
+#include <iostream>
+#include <string>
+#include "cardset.h"
+#include "game.h"
+
+using namespace std;
+
+/// Ways of laying out a deal as text.
+enum Layout {
+
+    // The four hands one suit per line with the opening bid, as the game is displayed, followed by a separator line
+    DIAGRAM,
+
+    // One PBN deal tag per line, the hands given clockwise from the dealer
+    PBN,
+
+    // One line per deal: the north, east, south and west hands then the opening bid and its maker
+    COMPACT
+};
+
+const int RENDERBUFFERBYTES = 1 << 20;
+
+/// This class formats deals as text into a buffer kept between batches, so that a batch of deals
+/// is written out with one large write instead of a stream operation per card and a flush per line.
+/// Each suit is written from the ranks of its holding rendered when the program is compiled.
+///
+class DealRenderer
+{
+    public:
+
+        /// \brief
+        /// Creates a renderer for the given layout.
+        ///
+        /// \param layout Layout - how each deal is laid out.
+        DealRenderer(Layout layout);
+
+        /// \brief
+        /// Adds a dealt and bid game to the buffer.
+        ///
+        /// \param game Game& - a game whose cards have been dealt and auction held.
+        void add(Game& game);
+
+        /// \brief
+        /// Adds a deal to the buffer.
+        ///
+        /// \param deal const CardSet[] - the cards held by each position.
+        /// \param dealer Position - the player dealing.
+        /// \param openingBid BidCode - the opening bid, or PASSBID if all hands passed.
+        /// \param opener Position - the player making the opening bid.
+        void add(const CardSet deal[NUMPOSITIONS], Position dealer, BidCode openingBid, Position opener);
+
+        /// \brief
+        /// Returns whether the buffer has grown past its usual size and should be written out.
+        ///
+        /// \return bool - true if the buffer is full.
+        bool full();
+
+        /// \brief
+        /// Writes the buffered text to the output stream with one write and empties the buffer,
+        /// keeping its memory for the next batch.
+        ///
+        /// \param out ostream& - output stream receiving the text.
+        void write(ostream& out);
+
+        /// \brief
+        /// Hands the buffered text over by exchanging it with a string, which is emptied first so that
+        /// its memory is reused for the next batch, leaving the buffer empty.
+        ///
+        /// \param text string& - receives the buffered text.
+        void takeText(string& text);
+
+    private:
+        Layout layout;
+        string buffer;
+
+        /// \brief
+        /// Appends the ranks held in one suit.
+        ///
+        /// \param cards CardSet - the hand.
+        /// \param suit Suit - the suit to write.
+        /// \param suitChar char - letter written after every rank, or zero to write the ranks alone.
+        void appendSuit(CardSet cards, Suit suit, char suitChar);
+
+        /// \brief
+        /// Appends a hand as its spade, heart, diamond and club ranks separated by dots.
+        ///
+        /// \param cards CardSet - the hand.
+        void appendDotted(CardSet cards);
+};
+
+#endif // DEALRENDERER_H
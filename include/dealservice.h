@@ -0,0 +1,189 @@
+#ifndef DEALSERVICE_H
+#define DEALSERVICE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cardset.h"
+#include "dealrenderer.h"
+#include "game.h"
+#include "handbatch.h"
+
+using namespace std;
+
+/// Requests the service answers, the latency of each being recorded separately.
+enum RequestKind {
+    GENERATEREQUEST,
+    BIDREQUEST,
+    PARSEREQUEST,
+    STATSREQUEST,
+    SHUTDOWNREQUEST,
+    UNKNOWNREQUEST
+};
+
+/// Requests whose latencies are reported by the stats request.
+const int NUMTIMEDREQUESTS = 4;
+
+/// Most requests a worker takes from the queue at once.
+const int SERVICEBATCH = 64;
+
+/// Most hands or deals following one request, and most deals generated by one request.
+const int MAXREQUESTLINES = 100000;
+const int MAXSERVICEDEALS = 1000000;
+
+/// Latencies kept for each kind of request, the oldest being replaced once this many are held.
+const int LATENCYSAMPLES = 65536;
+
+/// This class keeps the dealer and bidder running as a service so that tools send requests instead of
+/// starting a process per job. Clients connect to a Unix domain socket, or a single client talks over
+/// standard input and output. Each request is one line, followed by the hands or deals it names:
+///
+///     GENERATE N SEED [FIRST]     deals FIRST to FIRST + N - 1 of the seed, each dealt by the player its board gives
+///     BID N                       followed by N hands such as AK32.QJ4.T9.8765, evaluated and opened
+///     PARSE N                     followed by N deals of 52 cards as written by --generate
+///     STATS                       request counts and latency percentiles in microseconds
+///     SHUTDOWN                    stops the service once the requests already queued are answered
+///
+/// Every answer starts with "OK N" followed by N lines, or is the single line "ERROR message". Deals
+/// are answered in the compact layout. One thread reads every connection and queues each complete
+/// request, and a fixed pool of workers takes queued requests in batches, evaluating the hands of all
+/// bid requests in a batch together. A connection's next request is only queued once its last one is
+/// answered, so answers come back in the order the requests were sent.
+///
+class DealService
+{
+    public:
+
+        /// \brief
+        /// Sets up a service with the given number of workers.
+        ///
+        /// \param numWorkers int - number of worker threads answering requests.
+        DealService(int numWorkers);
+
+        /// \brief
+        /// Closes the socket and removes its file.
+        ~DealService();
+
+        /// \brief
+        /// Opens the Unix domain socket clients connect to, or takes standard input and output as the
+        /// only client when the path is "-".
+        ///
+        /// \param path const string& - file name of the socket, or "-".
+        /// \param error string& - receives a description of the problem if the socket cannot be opened.
+        ///
+        /// \return bool - true if the service is ready to run.
+        bool open(const string& path, string& error);
+
+        /// \brief
+        /// Answers requests until a shutdown request, or until standard input ends when it is the client.
+        void run();
+
+    private:
+        struct Connection {
+            int inFd;
+            int outFd;
+            string input;
+
+            // A request of the connection is queued or being answered
+            bool busy = false;
+
+            // The client has stopped sending
+            bool closed = false;
+        };
+
+        struct Request {
+            Connection* connection;
+            vector<string> lines;
+            chrono::steady_clock::time_point arrived;
+        };
+
+        struct LatencyRecord {
+            long long count = 0;
+            vector<double> samples;
+        };
+
+        int numWorkers;
+        string socketPath;
+        int listenFd = -1;
+        bool useStandardStreams = false;
+        int wakeFds[2] = { -1, -1 };
+        vector<Connection*> connections;
+
+        // Shared between the reading thread and the workers
+        mutex queueLock;
+        condition_variable queueChanged;
+        deque<Request> queue;
+        vector<Connection*> finished;
+        bool stopping = false;
+        bool shutdownRequested = false;
+
+        mutex statsLock;
+        LatencyRecord latencies[NUMTIMEDREQUESTS];
+
+        /// \brief
+        /// Queues the next request of a connection if all its lines have arrived.
+        ///
+        /// \param connection Connection* - a connection with no request queued or being answered.
+        ///
+        /// \return bool - true if a request was queued.
+        bool queueRequest(Connection* connection);
+
+        /// \brief
+        /// Takes batches of requests from the queue and answers them until the service stops.
+        void worker();
+
+        /// \brief
+        /// Evaluates the hands of every bid request in a batch with one call to the hand evaluator.
+        ///
+        /// \param requests vector<Request>& - the batch.
+        /// \param evaluator HandBatch& - the worker's hand evaluator.
+        /// \param hands vector<CardSet>& - receives the hands of the bid requests one after another.
+        /// \param features vector<HandFeatures>& - receives the features of each hand.
+        /// \param errors vector<string>& - receives the problem with each request's hands, empty if they could all be read.
+        void evaluateBids(vector<Request>& requests, HandBatch& evaluator, vector<CardSet>& hands,
+                          vector<HandFeatures>& features, vector<string>& errors);
+
+        /// \brief
+        /// Writes the answer to a generate request.
+        ///
+        /// \param request Request& - the request.
+        /// \param out ostream& - stream to the client.
+        /// \param game Game& - the worker's game.
+        /// \param renderer DealRenderer& - the worker's compact renderer.
+        void generate(Request& request, ostream& out, Game& game, DealRenderer& renderer);
+
+        /// \brief
+        /// Writes the answer to a parse request.
+        ///
+        /// \param request Request& - the request.
+        /// \param out ostream& - stream to the client.
+        /// \param evaluator HandBatch& - the worker's hand evaluator.
+        /// \param renderer DealRenderer& - the worker's compact renderer.
+        void parse(Request& request, ostream& out, HandBatch& evaluator, DealRenderer& renderer);
+
+        /// \brief
+        /// Writes the request counts and latency percentiles.
+        ///
+        /// \param out ostream& - stream to the client.
+        void writeStats(ostream& out);
+
+        /// \brief
+        /// Records how long a request took from arriving to being answered.
+        ///
+        /// \param kind RequestKind - the kind of request.
+        /// \param microseconds double - the latency.
+        void recordLatency(RequestKind kind, double microseconds);
+
+        /// \brief
+        /// Works out which request a line starts.
+        ///
+        /// \param line const string& - the first line of a request.
+        ///
+        /// \return RequestKind - the kind of request.
+        static RequestKind requestKind(const string& line);
+};
+
+#endif // DEALSERVICE_H
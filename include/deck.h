@@ -3,13 +3,16 @@
 
 #include <iostream>
 #include "card.h"
+#include "random.h"
 
 using namespace std;
 
 const int NUMCARDS = 52;
-const int NUMSHUFFLESWAPS = 1000;
+const int NUMRANKS = 13;
 
-/// This class creates an array representing a deck that contains pointers to cards.
+/// This class creates an array representing a deck that contains pointers to cards. The cards
+/// themselves are the 52 of a single pack shared by every deck and never change, so decks can be
+/// shuffled, dealt and read from files without creating or deleting any cards.
 ///
 class Deck {
 public:
@@ -19,7 +22,7 @@ public:
     Deck();
 
     /// \brief
-    /// Iterates through the array deleting each card pointer and then deletes the array itself.
+    /// Does nothing as the cards belong to the shared pack.
     ~Deck();
 
     /// \brief
@@ -33,22 +36,43 @@ public:
     Card* dealNextCard();
 
     /// \brief
-    /// Randomly shuffles the card pointers in the deck.
+    /// Randomly shuffles the card pointers in the deck using the deck's own randomizer,
+    /// which is seeded once when the deck is created.
     void shuffle();
 
+    /// \brief
+    /// Randomly shuffles the card pointers in the deck with a Fisher-Yates shuffle using numbers drawn
+    /// from the given randomizer, so that each thread can shuffle its own deck from its own stream.
+    ///
+    /// \param randomizer Random& - the randomizer supplying the swap positions.
+    void shuffle(Random& randomizer);
+
+    /// \brief
+    /// Arranges the deck and shuffles it from the random stream numbered by the deal, so that deal k of
+    /// a seed can be regenerated directly without shuffling deals 0 to k-1 first.
+    ///
+    /// \param seed unsigned long long - seed of the run the deal belongs to.
+    /// \param dealNumber unsigned long long - number of the deal within the run.
+    void shuffle(unsigned long long seed, unsigned long long dealNumber);
+
+    /// \brief
+    /// Puts the card pointers back into new deck order (clubs to spades, two to ace) and resets the cards dealt.
+    void arrange();
+
     /// \brief
     /// Creates an output stream for deck class by overloading << operator.
     /// This output will create a string representation of the deck in its current state, shuffled or not.
     friend ostream& operator<<(ostream& out, Deck& deck);
 
     /// \brief
-    /// Creates 52 cards and adds them to a deck using an input stream.
-    /// This input stream contains a string representing a card to be created (eg. 2C, 5D).
+    /// Reads 52 cards into a deck using an input stream, pointing each position of the deck at the card of the pack read.
+    /// This input stream contains a string representing a card (eg. 2C, 5D).
     friend istream& operator>>(istream& in, Deck& deck);
 
 private:
-    Card **cards;
+    Card* cards[NUMCARDS];
     int cardsDealt = 0;
+    Random randomizer;
 };
 
 #endif
@@ -0,0 +1,244 @@
+#ifndef DOUBLEDUMMY_H
+#define DOUBLEDUMMY_H
+
+#include <vector>
+#include "cardset.h"
+#include "game.h"
+
+using namespace std;
+
+/// Trump strains: the four suits use their Suit values and no trumps follows them.
+const int NOTRUMP = NUMSUITS;
+const int NUMSTRAINS = 5;
+const int NUMTRICKS = 13;
+const int BUCKETBITS = 16;
+const int MAXENTRIES = 1 << 20;
+
+/// This class solves a deal double dummy: with every hand visible and best play from both sides
+/// it finds the number of tricks the side on lead takes. The search is a fail-soft alpha-beta search run
+/// with null windows, ordering moves by cheap play heuristics and trying only one card from each run of
+/// touching cards. Each search also reports the cards whose ranks decided its result, so the bounds
+/// stored at the start of a trick in the transposition table apply to every position with the same
+/// suit lengths and the same owners of those top cards, whatever the smaller cards are. The table
+/// keeps a list of such bounds for each leader and set of suit lengths. The same reasoning lets a
+/// player skip any card of a suit lower than every card that decided the result of a card already tried.
+///
+class DoubleDummy
+{
+    public:
+
+        /// \brief
+        /// Creates a solver and its transposition table.
+        DoubleDummy();
+
+        /// \brief
+        /// Solves a dealt game for the given strain and opening leader.
+        ///
+        /// \param game Game& - a game whose cards have been dealt.
+        /// \param strain int - trump suit as a Suit value, or NOTRUMP.
+        /// \param leader Position - the player making the opening lead.
+        ///
+        /// \return int - tricks taken by the opening leader and their partner.
+        int solve(Game& game, int strain, Position leader);
+
+        /// \brief
+        /// Solves a deal given as four card sets of equal size for the given strain and opening leader.
+        ///
+        /// \param deal const CardSet[] - the cards held by each position.
+        /// \param strain int - trump suit as a Suit value, or NOTRUMP.
+        /// \param leader Position - the player making the opening lead.
+        /// \param guess int - expected result, tried first and then stepped from, or -1 to bisect.
+        ///
+        /// \return int - tricks taken by the opening leader and their partner.
+        int solve(const CardSet deal[NUMPOSITIONS], int strain, Position leader, int guess = -1);
+
+        /// \brief
+        /// Fills the double dummy table of a dealt game with the tricks each position takes as declarer
+        /// in each strain, the opening lead being made by the player to declarer's left.
+        ///
+        /// \param game Game& - a game whose cards have been dealt.
+        /// \param table int[][] - receives the declarer's tricks indexed by strain and declarer.
+        void calculateTable(Game& game, int table[NUMSTRAINS][NUMPOSITIONS]);
+
+        /// \brief
+        /// Returns the number of positions searched since the solver was created.
+        ///
+        /// \return long long - count of card plays tried.
+        long long getNodes();
+
+    private:
+        struct PositionKey {
+            uint64_t lengths;
+            uint64_t owners[2];
+            int leader;
+        };
+
+        struct Entry {
+            uint64_t owners[2];
+            uint64_t masks[2];
+            uint8_t depths[NUMSUITS];
+            int8_t lower;
+            int8_t upper;
+        };
+
+        struct Bucket {
+            uint64_t lengths;
+            uint32_t generation = 0;
+            int leader;
+            vector<Entry> entries;
+        };
+
+        vector<Bucket> buckets;
+        int numBuckets = 0;
+        int numEntries = 0;
+        uint32_t generation = 0;
+        int lastStrain;
+        CardSet hands[NUMPOSITIONS];
+        CardSet tableCards;
+        int trump;
+        int maxSide;
+        long long nodes = 0;
+        int killers[NUMTRICKS + 1][NUMPOSITIONS];
+
+        /// \brief
+        /// Searches a position at the start of a trick, using and updating the stored bounds.
+        ///
+        /// \param leader int - position leading to the trick.
+        /// \param tricksLeft int - number of tricks still to be played.
+        /// \param target int - tricks the searching side still needs.
+        /// \param relevant CardSet& - receives the cards whose ranks decided the result.
+        ///
+        /// \return int - tricks the searching side takes from here: a lower bound if at least the target, otherwise an upper bound.
+        int searchTrick(int leader, int tricksLeft, int target, CardSet& relevant);
+
+        /// \brief
+        /// Searches the choice of card for one player within a trick.
+        ///
+        /// \param seat int - position of the player to play.
+        /// \param cardsPlayed int - number of cards already played to the trick.
+        /// \param ledSuit int - suit led to the trick.
+        /// \param winningCard int - bit index of the card currently winning the trick.
+        /// \param winningSeat int - position of the player who played the winning card.
+        /// \param tricksLeft int - number of tricks still to be completed, including this one.
+        /// \param target int - tricks the searching side still needs.
+        /// \param relevant CardSet& - receives the cards whose ranks decided the result.
+        ///
+        /// \return int - tricks the searching side takes from here: a lower bound if at least the target, otherwise an upper bound.
+        int searchCard(int seat, int cardsPlayed, int ledSuit, int winningCard, int winningSeat,
+                        int tricksLeft, int target, CardSet& relevant);
+
+        /// \brief
+        /// Counts the tricks the leader can take by cashing cards higher than any the opponents hold. Outside
+        /// the trump suit winners only count while both opponents must follow, unless neither holds a trump.
+        ///
+        /// \param leader int - position leading to the trick.
+        /// \param tricksLeft int - number of tricks still to be played.
+        /// \param relevant CardSet& - receives the lowest winner counted in each suit.
+        ///
+        /// \return int - a lower bound on the tricks of the leader's side.
+        int quickTricks(int leader, int tricksLeft, CardSet& relevant);
+
+        /// \brief
+        /// Counts the trumps held by one player of a side that are higher than every trump of the other side.
+        ///
+        /// \param side int - the side, zero for north and south or one for east and west.
+        /// \param relevant CardSet& - receives the lowest trump counted.
+        ///
+        /// \return int - a lower bound on the tricks of the side.
+        int trumpTricks(int side, CardSet& relevant);
+
+        /// \brief
+        /// Works out which side takes the final trick once each player holds a single card.
+        ///
+        /// \param leader int - position leading to the last trick.
+        /// \param relevant CardSet& - receives the winning card if it won on rank.
+        ///
+        /// \return int - the position winning the last trick.
+        int lastTrickWinner(int leader, CardSet& relevant);
+
+        /// \brief
+        /// Lists the cards worth trying for a player, leaving out all but the lowest of
+        /// cards that are touching once played cards are ignored.
+        ///
+        /// \param seat int - position of the player to play.
+        /// \param cardsPlayed int - number of cards already played to the trick.
+        /// \param ledSuit int - suit led to the trick.
+        /// \param moves int[] - receives the bit indexes of the cards.
+        ///
+        /// \return int - number of cards listed.
+        int generateMoves(int seat, int cardsPlayed, int ledSuit, int moves[NUMTRICKS]);
+
+        /// \brief
+        /// Orders the listed cards so that the plays most likely to be best are tried first.
+        ///
+        /// \param seat int - position of the player to play.
+        /// \param cardsPlayed int - number of cards already played to the trick.
+        /// \param ledSuit int - suit led to the trick.
+        /// \param winningCard int - bit index of the card currently winning the trick.
+        /// \param winningSeat int - position of the player who played the winning card.
+        /// \param tricksLeft int - number of tricks still to be completed, including this one.
+        /// \param moves int[] - the cards to be ordered.
+        /// \param numMoves int - number of cards listed.
+        void orderMoves(int seat, int cardsPlayed, int ledSuit, int winningCard, int winningSeat,
+                        int tricksLeft, int moves[NUMTRICKS], int numMoves);
+
+        /// \brief
+        /// Checks whether a player still to play to the trick holds a card that would beat the given card.
+        ///
+        /// \param seat int - position of the player still to play.
+        /// \param card int - bit index of the card to be beaten.
+        /// \param ledSuit int - suit led to the trick.
+        ///
+        /// \return bool - true if the player could take the trick from the card.
+        bool canBeat(int seat, int card, int ledSuit);
+
+        /// \brief
+        /// Checks whether a card beats the card currently winning the trick.
+        ///
+        /// \param card int - bit index of the card played.
+        /// \param winningCard int - bit index of the card currently winning.
+        ///
+        /// \return bool - true if the new card wins the trick so far.
+        bool beats(int card, int winningCard);
+
+        /// \brief
+        /// Builds the transposition key of the position at the start of a trick: the length of every
+        /// suit in every hand and, for each suit, the owner of each remaining card from the top down.
+        ///
+        /// \param leader int - position leading to the trick.
+        /// \param key PositionKey& - receives the key.
+        void positionKey(int leader, PositionKey& key);
+
+        /// \brief
+        /// Finds the transposition table bucket holding the bounds for a position's suit lengths and leader.
+        ///
+        /// \param key const PositionKey& - key of the position.
+        /// \param create bool - whether to add the bucket if it is not yet in the table.
+        ///
+        /// \return Bucket* - pointer to the bucket, or NULL if there is none.
+        Bucket* findBucket(const PositionKey& key, bool create);
+
+        /// \brief
+        /// Empties the transposition table.
+        void clearTable();
+
+        /// \brief
+        /// Stores a bound found by a search, keeping only the owners of cards at or above the lowest
+        /// relevant card of each suit so that the bound is shared by every position that matches them.
+        ///
+        /// \param key const PositionKey& - key of the searched position.
+        /// \param relevant CardSet - cards whose ranks decided the result.
+        /// \param lower int - lower bound on the tricks of the side on lead.
+        /// \param upper int - upper bound on the tricks of the side on lead.
+        void storeBound(const PositionKey& key, CardSet relevant, int lower, int upper);
+
+        /// \brief
+        /// Converts the depths stored in an entry back into the cards of the current position they cover.
+        ///
+        /// \param entry const Entry& - the matching entry.
+        ///
+        /// \return CardSet - the lowest covered card of each suit.
+        CardSet entryRelevant(const Entry& entry);
+};
+
+#endif // DOUBLEDUMMY_H
@@ -26,7 +26,7 @@ class Game
         Game();
 
         /// \brief
-        /// Deletes the pointers to hand objects contained within the array before deleting the array itself.
+        /// Deletes the hand objects pointed to by the array.
         ~Game();
 
         /// \brief
@@ -35,6 +35,14 @@ class Game
         /// \param fromFile bool - true or false value indicating if a text file is being used to create a game.
         void setup(bool fromFile);
 
+        /// \brief
+        /// Sets up the game by shuffling the deck from the random stream numbered by the deal, so that
+        /// the same seed and deal number always produce the same game.
+        ///
+        /// \param seed unsigned long long - seed of the run the deal belongs to.
+        /// \param dealNumber unsigned long long - number of the deal within the run.
+        void setup(unsigned long long seed, unsigned long long dealNumber);
+
         /// \brief
         /// Deals the cards to the four players by iterating through deck and adding cards to players.
         void deal();
@@ -48,6 +56,38 @@ class Game
         /// Sets dealer position to the player clockwise of current dealer.
         void nextDealer();
 
+        /// \brief
+        /// Sets the dealer, so that a game can be dealt with the dealer its board number gives.
+        ///
+        /// \param position Position - the player dealing.
+        void setDealer(Position position);
+
+        /// \brief
+        /// Returns the hand held by the player at the given position.
+        ///
+        /// \param position Position - the player whose hand is returned.
+        ///
+        /// \return Hand* - pointer to the player's hand.
+        Hand* getHand(Position position);
+
+        /// \brief
+        /// Returns the player dealing the current game.
+        ///
+        /// \return Position - the dealer.
+        Position getDealer();
+
+        /// \brief
+        /// Returns the opening bid found by the last auction.
+        ///
+        /// \return BidCode - the opening bid, or PASSBID if all hands passed.
+        BidCode getOpeningBid();
+
+        /// \brief
+        /// Returns the player who made the opening bid in the last auction.
+        ///
+        /// \return Position - the player opening the bidding, meaningless if all hands passed.
+        Position getOpener();
+
         /// \brief
         /// Creates an output stream for game class by overloading << operator.
         /// This output will return a string represenation of the game including the player's
@@ -61,7 +101,8 @@ class Game
     private:
         Position dealer;
         Deck deck;
-        string openingBid;
+        BidCode openingBid = PASSBID;
+        Position opener = NORTH;
         Hand* hands[NUMPOSITIONS];
 
         /// \brief
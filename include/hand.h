@@ -1,41 +1,192 @@
 #ifndef HAND_H
 #define HAND_H
 
-#include <list>
+#include <cstdint>
 #include "deck.h"
 #include "card.h"
+#include "cardset.h"
+#include "suittables.h"
 
 using namespace std;
 
 const int NUMSUITS = 4;
 
-/// This class sets up a player hand by storing collections of cards for the four different suits.
+/// An opening bid packed into one byte: zero for a pass, otherwise five times one less than the level
+/// plus the strain (clubs to spades then no trumps) plus one, so 1C is 1 and 7NT is 35.
+typedef uint8_t BidCode;
+
+const BidCode PASSBID = 0;
+const int NUMBIDCODES = 36;
+
+/// Most high card points a hand can hold.
+const int MAXHCP = 37;
+
+/// The evaluations of one hand, all worked out in one pass over its four suits.
+struct HandEvaluation {
+
+    // Cards held in each suit, indexed by Suit
+    uint8_t lengths[NUMSUITS];
+
+    // Four for each ace down to one for each jack
+    uint8_t highCardPoints;
+
+    // One for every card over four in a suit
+    uint8_t lengthPoints;
+
+    // Losing trick count: the losers among the top three cards of each suit
+    uint8_t losers;
+
+    // Two for each ace and one for each king
+    uint8_t controls;
+
+    // Quick tricks counted in halves, as the defence can expect to take in the first two rounds
+    uint8_t halfQuickTricks;
+
+    // Playing tricks counted in halves, as the hand can expect to take with its longest suit as trumps
+    uint8_t halfPlayingTricks;
+};
+
+/// The evaluations of a partnership, combined from the evaluations of its two hands.
+struct PartnershipEvaluation {
+
+    // The suit the partners hold most cards in between them, the higher ranking if several tie
+    uint8_t fitSuit;
+
+    // Cards the partners hold in the fit suit
+    uint8_t fitLength;
+
+    // High card points of both hands
+    uint8_t highCardPoints;
+
+    // High card and length points of both hands
+    uint8_t strength;
+
+    // Losing trick count of both hands
+    uint8_t losers;
+
+    // Controls of both hands
+    uint8_t controls;
+
+    // Quick tricks of both hands counted in halves
+    uint8_t halfQuickTricks;
+
+    // Tricks the losing trick count expects the partnership to take with the fit suit as trumps,
+    // 24 less the losers of both hands
+    uint8_t tricks;
+};
+
+/// This class sets up a player hand by storing the cards held as a card set with one bit mask per suit.
+/// The suit lengths, high card points and strength are kept up to date as cards are added, and during
+/// play cards can be removed and put back in last-in first-out order, each in constant time.
 ///
 class Hand
 {
     public:
 
         /// \brief
-        /// Adds the first nodes of the four suit lists to an suit cards array.
+        /// Creates an empty hand.
         Hand();
 
         /// \brief
-        /// Iterates through the suit cards array starting with each suit's first node and deletes all nodes that
-        /// connect to form that suit list before moving to the next suit.
-        ~Hand();
-
-        /// \brief
-        /// Clears the lists for each suit in the hand by returning the header node for each suit to NULL.
-        /// Also resets the strength of the hand as all cards have been removed.
+        /// Clears the hand by emptying the card set so that a new hand can be dealt.
         void clear();
 
         /// \brief
-        /// Adds a card node to the correct suit list depening on card pointer given as input parameter
-        /// (eg. clubs card adds a node to the clubs list).
+        /// Adds a card to the hand by setting its bit in the card set.
         ///
-        /// \param cardToAdd Card* - used to determine which suit list the card node should be added to.
+        /// \param cardToAdd Card* - the card to be added to the hand.
         void addCard(Card* cardToAdd);
 
+        /// \brief
+        /// Returns the cards held in the hand.
+        ///
+        /// \return CardSet - the card set holding one bit mask per suit.
+        CardSet getCards();
+
+        /// \brief
+        /// Removes a card from the hand as it is played, keeping the suit lengths, points and strength up
+        /// to date and pushing the card onto the undo stack.
+        ///
+        /// \param card int - bit index of a card held in the hand.
+        void removeCard(int card);
+
+        /// \brief
+        /// Puts back the card most recently removed, undoing removals in the reverse order they were made.
+        ///
+        /// \return int - bit index of the card put back.
+        int restoreCard();
+
+        /// \brief
+        /// Returns the number of cards removed and not yet put back.
+        ///
+        /// \return int - depth of the undo stack.
+        int getNumRemoved();
+
+        /// \brief
+        /// Returns the cards the player may play to a trick: the cards of the suit led if any are held,
+        /// otherwise every card.
+        ///
+        /// \param ledSuit Suit - the suit led to the trick.
+        ///
+        /// \return CardSet - the legal cards.
+        CardSet legalCards(Suit ledSuit);
+
+        /// \brief
+        /// Returns the number of cards held in a suit.
+        ///
+        /// \param suit Suit - the suit to be counted.
+        ///
+        /// \return int - number of cards in the suit.
+        int getSuitLength(Suit suit);
+
+        /// \brief
+        /// Returns the high card points of the cards held.
+        ///
+        /// \return int - four for each ace down to one for each jack.
+        int getHighCardPoints();
+
+        /// \brief
+        /// Returns the strength of the cards held as their high card points plus one length point
+        /// for every card over four in a suit.
+        ///
+        /// \return int - the high card and length points of the hand.
+        int getStrength();
+
+        /// \brief
+        /// Evaluates the cards held: points, losing trick count, controls, quick tricks and playing tricks.
+        ///
+        /// \return HandEvaluation - the evaluations of the hand.
+        HandEvaluation evaluate();
+
+        /// \brief
+        /// Evaluates a hand given as a card set in one pass over its suits, taking every evaluation
+        /// of a suit packed into one word looked up from its holding and adding the four words, so
+        /// that all of them together cost little more than the high card points alone.
+        ///
+        /// \param cards CardSet - the cards of the hand.
+        ///
+        /// \return HandEvaluation - the evaluations of the hand.
+        static inline HandEvaluation evaluate(CardSet cards) {
+            uint64_t clubs = suitEvaluations(suitHolding(cards, CLUBS));
+            uint64_t diamonds = suitEvaluations(suitHolding(cards, DIAMONDS));
+            uint64_t hearts = suitEvaluations(suitHolding(cards, HEARTS));
+            uint64_t spades = suitEvaluations(suitHolding(cards, SPADES));
+            uint64_t sums = clubs + diamonds + hearts + spades;
+
+            return { { (uint8_t) (clubs >> 56), (uint8_t) (diamonds >> 56), (uint8_t) (hearts >> 56), (uint8_t) (spades >> 56) },
+                     (uint8_t) sums, (uint8_t) (sums >> 8), (uint8_t) (sums >> 16), (uint8_t) (sums >> 24),
+                     (uint8_t) (sums >> 32), (uint8_t) (sums >> 40) };
+        }
+
+        /// \brief
+        /// Combines the evaluations of two partners' hands.
+        ///
+        /// \param first const HandEvaluation& - the evaluations of one partner's hand.
+        /// \param second const HandEvaluation& - the evaluations of the other partner's hand.
+        ///
+        /// \return PartnershipEvaluation - the evaluations of the partnership.
+        static PartnershipEvaluation evaluatePartnership(const HandEvaluation& first, const HandEvaluation& second);
+
         /// \brief
         /// Decides what bid for the player to make depending on their hand strength and shape values.
         ///
@@ -43,64 +194,86 @@ class Hand
         string makeBid();
 
         /// \brief
-        /// Creates an output stream for hand class by overloading << operator.
-        /// This output will return a string representation of the cards within the hand divided into each suit.
-        friend ostream& operator << (ostream& out, Hand& hand);
-
-    private:
-        struct cardNode { Card* data; cardNode* next; };
-        cardNode* node;
-        cardNode* c_header = NULL;
-        cardNode* s_header = NULL;
-        cardNode* h_header = NULL;
-        cardNode* d_header = NULL;
-        cardNode* iteratorNode;
-        cardNode** suitCards[NUMSUITS];
-        string bid;
-        list<Suit> longestSuit;
-        int handStrength = 0;
+        /// Decides what bid for the player to make by looking up their hand strength and suit lengths
+        /// in the opening bid table.
+        ///
+        /// \return BidCode - the bid that the player should make.
+        BidCode makeBidCode();
 
         /// \brief
-        /// Checks if card has a high rank and adds points to hand strength
-        /// corresponding to the rank.
+        /// Looks up the opening bid for a hand with the given suit lengths and strength in the table
+        /// compiled from the active bidding system, so that hands evaluated in bulk can be bid without
+        /// creating hand objects.
+        ///
+        /// \param lengths const int[] - number of cards held in each suit, indexed by Suit.
+        /// \param strength int - the high card and length points of the hand.
         ///
-        /// \param cardToAdd Card* - card who's rank will be evaluated.
-        void checkForHighCard(Card* cardToAdd);
+        /// \return BidCode - the bid that the player should make.
+        static BidCode openingBidCode(const int lengths[NUMSUITS], int strength);
 
         /// \brief
-        /// Calculates the shape of the hand (balanced or unbalanced) depending on
-        /// the number of cards in each different suit.
+        /// Returns the name of a bid (eg. "1NT" or "PASS").
         ///
-        /// \return bool - returns true if balanced and false if not.
-        bool calculateShape();
+        /// \param code BidCode - the bid.
+        ///
+        /// \return string - the bid as written in the auction.
+        static string bidName(BidCode code);
 
         /// \brief
-        /// Determines how many suits are the longest and how many cards they have.
+        /// Reads the name of a bid as written by bidName, in either case.
+        ///
+        /// \param name const string& - the name, such as "1NT" or "pass".
+        /// \param code BidCode& - receives the bid.
         ///
-        /// \return int - returns number of cards in the longest suit/s.
-        int calculateLongestSuit();
+        /// \return bool - true if the name is a pass or a level from 1 to 7 and a strain.
+        static bool parseBidName(const string& name, BidCode& code);
 
         /// \brief
-        /// Determines the number of cards in a suit by counting the nodes it a suit list.
+        /// Calculates whether a hand with the given suit lengths is balanced, holding two to four
+        /// cards in every suit and at most one doubleton.
         ///
-        /// \param suit_headerNode cardNode* - first node of the suit list to be calculated.
+        /// \param lengths const int[] - number of cards held in each suit, indexed by Suit.
         ///
-        /// \return int - returns number of cards in the suit.
-        int suitSize(cardNode* suit_headerNode);
+        /// \return bool - returns true if balanced and false if not.
+        static bool calculateShape(const int lengths[NUMSUITS]);
 
         /// \brief
-        /// Creates a string representation of the cards in given suit to be passed to the hand class output stream.
+        /// Creates an output stream for hand class by overloading << operator.
+        /// This output will return a string representation of the cards within the hand divided into each suit.
+        friend ostream& operator << (ostream& out, Hand& hand);
+
+    private:
+        CardSet cards = 0;
+        string bid;
+
+        // Features of the cards held, updated as each card is added or removed
+        int handStrength = 0;
+        int points = 0;
+        int lengths[NUMSUITS] = {};
+
+        // Cards removed in play, most recent last
+        uint8_t removed[NUMRANKS];
+        int numRemoved = 0;
+
+        /// \brief
+        /// Puts a card into the hand and updates the features of the hand.
         ///
-        /// \param out ostream& - output stream to receive the output produced by this method.
-        /// \param suit_headerNode cardNode* - the first node of the suit to be displayed a string.
-        void displaySuit(ostream& out, cardNode* suit_headerNode);
+        /// \param card int - bit index of a card not held in the hand.
+        void insertCard(int card);
 
         /// \brief
-        /// Inserts a card node pointer to a card to the correct suit list in the correct place.
+        /// Takes a card out of the hand and updates the features of the hand.
         ///
-        /// \param suit_headerNode cardNode*& - first node of the suit list where card is to be added.
-        /// \param node cardNode* - node pointing to card to be added to list.
-        void insertCard(cardNode*& suit_headerNode, cardNode* node);
+        /// \param card int - bit index of a card held in the hand.
+        void takeCard(int card);
+
+        /// \brief
+        /// Creates a string representation of the cards in given suit to be passed to the hand class output stream.
+        /// Cards are written from highest to lowest rank using the ranks of the suit's holding rendered at compile time.
+        ///
+        /// \param out ostream& - output stream to receive the output produced by this method.
+        /// \param suit Suit - the suit to be displayed as a string.
+        void displaySuit(ostream& out, Suit suit);
 
         /// \brief
         /// Returns a string representation of the suit value (eg. 0 is Clubs, 1 is Diamonds...).
@@ -108,12 +281,7 @@ class Hand
         /// \param suitValue int - value corrosponding to SUIT enum values representing a suit.
         ///
         /// \return string - returns suit name as string that the suit value corresponds to.
-        string suitName(int suitValue);
-
-        /// \brief
-        /// Bids longest of minor suits (diamonds or clubs). However if suits are both length of four bids
-        /// bids diamonds and if length is three bids clubs.
-        void bidMinorSuit();
+        static string suitName(int suitValue);
 };
 
 #endif // HAND_H
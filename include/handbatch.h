@@ -0,0 +1,81 @@
+#ifndef HANDBATCH_H
+#define HANDBATCH_H
+
+#include <cstdint>
+#include <string>
+#include "cardset.h"
+#include "hand.h"
+
+using namespace std;
+
+/// The features of one hand used by the opening bid, packed into eight bytes so that a vector
+/// register holding four hands' card sets is turned into four results in place.
+struct HandFeatures {
+    uint8_t lengths[NUMSUITS];
+    uint8_t highCardPoints;
+    uint8_t lengthPoints;
+    uint8_t balanced;
+    uint8_t unused;
+};
+
+/// This class evaluates many hands at once, working out the high card points, length points, suit
+/// lengths and balanced flag used by Hand::makeBid for a contiguous array of card sets. On processors
+/// with AVX2 four hands are evaluated together with byte table lookups standing in for the point
+/// and bit counts; other processors use a plain loop. The implementation is chosen when the
+/// evaluator is created. Hands can also be given every evaluation of Hand::evaluate, and deals
+/// the evaluations of their partnerships.
+///
+class HandBatch
+{
+    public:
+
+        /// \brief
+        /// Creates an evaluator using AVX2 if the processor supports it.
+        ///
+        /// \param allowVector bool - false to always use the plain loop.
+        HandBatch(bool allowVector = true);
+
+        /// \brief
+        /// Evaluates an array of hands.
+        ///
+        /// \param hands const CardSet* - the cards of each hand.
+        /// \param count int - number of hands.
+        /// \param features HandFeatures* - receives the features of each hand.
+        void evaluate(const CardSet* hands, int count, HandFeatures* features);
+
+        /// \brief
+        /// Works out every evaluation of an array of hands, making one pass over the suits of each.
+        ///
+        /// \param hands const CardSet* - the cards of each hand.
+        /// \param count int - number of hands.
+        /// \param evaluations HandEvaluation* - receives the evaluations of each hand.
+        void evaluate(const CardSet* hands, int count, HandEvaluation* evaluations);
+
+        /// \brief
+        /// Combines the evaluations of the hands of whole deals into the evaluations of their partnerships.
+        ///
+        /// \param evaluations const HandEvaluation* - the evaluations of the hands, four per deal in Position order.
+        /// \param numDeals int - number of deals.
+        /// \param partnerships PartnershipEvaluation* - receives north-south then east-west for each deal.
+        static void evaluatePartnerships(const HandEvaluation* evaluations, int numDeals, PartnershipEvaluation* partnerships);
+
+        /// \brief
+        /// Returns whether the evaluator uses AVX2.
+        ///
+        /// \return bool - true if hands are evaluated four at a time.
+        bool usesVector();
+
+        /// \brief
+        /// Decides the opening bid of an evaluated hand with the rules of Hand::makeBid.
+        ///
+        /// \param features const HandFeatures& - the features of the hand.
+        ///
+        /// \return BidCode - the bid that the player should make.
+        static BidCode openingBid(const HandFeatures& features);
+
+    private:
+        void (*evaluator)(const CardSet*, int, HandFeatures*);
+        bool vectorized;
+};
+
+#endif // HANDBATCH_H
@@ -0,0 +1,118 @@
+#ifndef HANDDISTRIBUTION_H
+#define HANDDISTRIBUTION_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "cardset.h"
+#include "hand.h"
+
+using namespace std;
+
+/// Stands for every opening bid when counts are not limited to the hands making one.
+const int ANYBID = -1;
+
+/// Most high card points one suit can hold.
+const int MAXSUITHCP = 10;
+
+/// This class counts exactly how many of the hands that can be dealt from the cards not known to lie
+/// elsewhere have each suit length pattern and number of high card points. Within a suit, the hands
+/// holding a given set of the unknown ace, king, queen and jack and a given number of cards differ
+/// only in which of the suit's unknown spot cards make up the rest, so they number one binomial
+/// coefficient. Adding these up over the sets of honours gives each suit's counts by length and
+/// points, and for each of the 560 ways of splitting 13 cards among the suits the four suits' counts
+/// are multiplied and their points added by convolution. Anything that follows from a hand's suit
+/// lengths and high card points, such as its opening bid, is then known exactly, with nothing dealt.
+///
+/// Cards known to lie elsewhere, such as partner's hand, are left out of every hand counted, and the
+/// counts can be limited to hands making a given opening bid.
+///
+class HandDistribution
+{
+    public:
+
+        /// \brief
+        /// Creates a distribution over every hand that can be dealt from the whole pack.
+        HandDistribution();
+
+        /// \brief
+        /// Counts the hands that can be dealt from the cards not known to lie elsewhere.
+        ///
+        /// \param known CardSet - cards held by other hands.
+        /// \param error string& - receives a description of the problem if the cards cannot be used.
+        ///
+        /// \return bool - true if at least 13 cards are unknown.
+        bool compute(CardSet known, string& error);
+
+        /// \brief
+        /// Returns the number of hands counted.
+        ///
+        /// \return uint64_t - the number of ways of choosing 13 of the unknown cards.
+        uint64_t getNumHands();
+
+        /// \brief
+        /// Returns the number of hands with the given suit lengths and high card points.
+        ///
+        /// \param lengths const int[] - cards held in each suit, indexed by Suit.
+        /// \param highCardPoints int - the high card points.
+        ///
+        /// \return uint64_t - count of hands.
+        uint64_t getCount(const int lengths[NUMSUITS], int highCardPoints);
+
+        /// \brief
+        /// Counts the hands holding each number of high card points.
+        ///
+        /// \param pointCounts vector<uint64_t>& - receives the counts, indexed by points from 0 to MAXHCP.
+        /// \param bid int - the opening bid the hands must make, or ANYBID.
+        void countPoints(vector<uint64_t>& pointCounts, int bid = ANYBID);
+
+        /// \brief
+        /// Counts the hands holding each number of cards in a suit.
+        ///
+        /// \param suit Suit - the suit.
+        /// \param lengthCounts vector<uint64_t>& - receives the counts, indexed by length from 0 to 13.
+        /// \param bid int - the opening bid the hands must make, or ANYBID.
+        void countLengths(Suit suit, vector<uint64_t>& lengthCounts, int bid = ANYBID);
+
+        /// \brief
+        /// Counts the hands of each suit length pattern, the lengths written longest first whatever
+        /// their suits (eg. "4-4-3-2").
+        ///
+        /// \param patternCounts map<string, uint64_t>& - receives the counts of the patterns held by any hand.
+        /// \param bid int - the opening bid the hands must make, or ANYBID.
+        void countPatterns(map<string, uint64_t>& patternCounts, int bid = ANYBID);
+
+        /// \brief
+        /// Counts the hands making each opening bid by the active bidding system.
+        ///
+        /// \param bidCounts vector<uint64_t>& - receives the counts, indexed by BidCode.
+        void countBids(vector<uint64_t>& bidCounts);
+
+    private:
+        uint64_t numHands = 0;
+
+        // Hands by shape code, as used by the opening bid table, and high card points
+        vector<uint64_t> counts;
+
+        /// \brief
+        /// Works out the suit lengths of a shape code.
+        ///
+        /// \param shapeCode int - the shape code, (clubs * 14 + diamonds) * 14 + hearts.
+        /// \param lengths int[] - receives the cards held in each suit.
+        ///
+        /// \return bool - false if the code stands for more than 13 cards.
+        static bool shapeLengths(int shapeCode, int lengths[NUMSUITS]);
+
+        /// \brief
+        /// Decides whether hands with the given suit lengths and high card points make an opening bid.
+        ///
+        /// \param lengths const int[] - cards held in each suit, indexed by Suit.
+        /// \param highCardPoints int - the high card points.
+        /// \param bid int - the opening bid, or ANYBID.
+        ///
+        /// \return bool - true if the hands open with the bid, or the bid is ANYBID.
+        static bool makesBid(const int lengths[NUMSUITS], int highCardPoints, int bid);
+};
+
+#endif // HANDDISTRIBUTION_H
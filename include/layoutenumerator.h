@@ -0,0 +1,139 @@
+#ifndef LAYOUTENUMERATOR_H
+#define LAYOUTENUMERATOR_H
+
+#include <string>
+#include <vector>
+#include "cardset.h"
+#include "game.h"
+
+using namespace std;
+
+/// One layout of the unknown cards, with the features of every hand kept up to date as cards move.
+struct LayoutState {
+
+    // Cards held by each position
+    CardSet hands[NUMPOSITIONS];
+
+    // Cards held in each suit and high card points of each position
+    int lengths[NUMPOSITIONS][NUMSUITS];
+    int highCardPoints[NUMPOSITIONS];
+
+    // Place of the layout in the enumeration order, from zero
+    long long index;
+};
+
+/// Receives each layout visited by a layout enumerator. Each thread of the enumerator has its own
+/// visitor, so a visitor can count without locking and the counts can be added up afterwards.
+///
+class LayoutVisitor
+{
+    public:
+        virtual ~LayoutVisitor() {}
+
+        /// \brief
+        /// Called for each layout in turn.
+        ///
+        /// \param layout const LayoutState& - the layout, which changes once the call returns.
+        virtual void visit(const LayoutState& layout) = 0;
+};
+
+/// This class visits every way the cards of two unknown hands can lie once the other two hands are known,
+/// optionally with the suit lengths of the first unknown hand fixed. Consecutive layouts differ by one
+/// card of each unknown hand changing places, so the features of the hands are updated by one exchange
+/// instead of being worked out again. The unknown cards are split into pools, all of them together or one
+/// pool per suit when lengths are fixed. The first unknown hand's share of each pool follows the
+/// revolving door order of combinations, and the pools are stepped together in a reflected mixed-radix
+/// Gray code, so any layout can be reached directly from its index and threads can take contiguous
+/// ranges of the enumeration.
+///
+class LayoutEnumerator
+{
+    public:
+
+        /// \brief
+        /// Sets up an enumeration of the layouts of two unknown hands.
+        ///
+        /// \param deal const CardSet[] - the cards held by each position, only those of the two known positions being used.
+        /// \param first Position - the first unknown position.
+        /// \param second Position - the second unknown position.
+        /// \param error string& - receives a description of the problem if the hands cannot be used.
+        ///
+        /// \return bool - true if the known hands hold 13 different cards each.
+        bool setup(const CardSet deal[NUMPOSITIONS], Position first, Position second, string& error);
+
+        /// \brief
+        /// Fixes the number of cards the first unknown position holds in each suit.
+        ///
+        /// \param lengths const int[] - cards held in each suit, clubs first.
+        /// \param error string& - receives a description of the problem if the lengths cannot be held.
+        ///
+        /// \return bool - true if the lengths add up to 13 and each suit has enough unknown cards.
+        bool setLengths(const int lengths[NUMSUITS], string& error);
+
+        /// \brief
+        /// Returns the number of layouts the enumeration visits.
+        ///
+        /// \return long long - count of layouts.
+        long long getNumLayouts();
+
+        /// \brief
+        /// Visits every layout, splitting the enumeration into one contiguous range per visitor and
+        /// running each range on its own thread.
+        ///
+        /// \param visitors vector<LayoutVisitor*>& - one visitor for each thread.
+        void run(vector<LayoutVisitor*>& visitors);
+
+        /// \brief
+        /// Returns the throughput of the last run.
+        ///
+        /// \return double - layouts visited per second.
+        double getLayoutsPerSecond();
+
+    private:
+        struct Pool {
+
+            // Bit index of each card of the pool, lowest first
+            int cards[NUMCARDS / 2];
+            int size;
+
+            // Cards of the pool held by the first unknown position, and the number of ways of choosing them
+            int choose;
+            long long count;
+        };
+
+        CardSet known[NUMPOSITIONS];
+        Position first;
+        Position second;
+        CardSet unknown = 0;
+        Pool pools[NUMSUITS];
+        int numPools = 0;
+        long long numLayouts = 0;
+        double layoutsPerSecond = 0;
+
+        /// \brief
+        /// Visits the layouts in one range of the enumeration.
+        ///
+        /// \param firstIndex long long - index of the first layout visited.
+        /// \param lastIndex long long - index after the last layout visited.
+        /// \param visitor LayoutVisitor* - receives the layouts.
+        void enumerate(long long firstIndex, long long lastIndex, LayoutVisitor* visitor);
+
+        /// \brief
+        /// Works out the place of each pool in its revolving door order for a layout.
+        ///
+        /// \param index long long - index of the layout.
+        /// \param digits long long[] - receives the place of each pool.
+        void grayDigits(long long index, long long digits[NUMSUITS]);
+
+        /// \brief
+        /// Finds the combination at the given place of the revolving door order.
+        ///
+        /// \param number long long - place in the order.
+        /// \param size int - number of items to choose from.
+        /// \param choose int - number of items chosen.
+        ///
+        /// \return uint32_t - bit n is set when item n is chosen.
+        static uint32_t revolvingDoor(long long number, int size, int choose);
+};
+
+#endif // LAYOUTENUMERATOR_H
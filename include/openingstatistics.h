@@ -0,0 +1,121 @@
+#ifndef OPENINGSTATISTICS_H
+#define OPENINGSTATISTICS_H
+
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include "game.h"
+
+using namespace std;
+
+/// Ranges of the opener's high card points counted separately: up to 9, 10-11, 12-14, 15-17, 18-19, 20-21 and 22 up.
+const int NUMHCPBUCKETS = 7;
+
+/// Kinds of hand shape counted separately.
+enum ShapeClass {
+
+    // 4333, 4432 and 5332
+    BALANCEDSHAPE,
+
+    // 5422 and 6322
+    SEMIBALANCEDSHAPE,
+
+    // A suit of six or more and no other suit of four or more
+    ONESUITEDSHAPE,
+
+    // Two suits of four or more, one of them at least five long, not semi-balanced
+    TWOSUITEDSHAPE,
+
+    // Three suits of four or more: 4441 and 5440
+    THREESUITEDSHAPE
+};
+
+const int NUMSHAPECLASSES = 5;
+
+/// This class deals a large number of games across several threads, holds the auction of each and counts
+/// how often each opening bid is made, by dealer, seat, opener's high card points and opener's shape.
+/// Each worker counts into its own histogram, which is added to the totals once when the worker finishes,
+/// so that no state is shared while dealing and the memory used does not depend on the number of deals.
+/// Deal k is dealt from the random stream numbered k by the dealer of board k + 1, so the counts do not
+/// depend on the number of threads.
+///
+class OpeningStatistics
+{
+    public:
+
+        /// \brief
+        /// Sets up a run over the given number of deals.
+        ///
+        /// \param numDeals long long - total number of deals to be bid.
+        /// \param seed unsigned long long - seed from which every deal's random stream is derived.
+        /// \param numThreads int - number of worker threads dealing and bidding.
+        OpeningStatistics(long long numDeals, unsigned long long seed, int numThreads);
+
+        /// \brief
+        /// Deals and bids every game on the worker threads and adds up their counts.
+        void run();
+
+        /// \brief
+        /// Writes the frequency tables, each percentage given with its 95% confidence interval.
+        ///
+        /// \param out ostream& - output stream receiving the tables.
+        void print(ostream& out);
+
+        /// \brief
+        /// Returns the throughput of the last run.
+        ///
+        /// \return double - deals bid per second.
+        double getDealsPerSecond();
+
+        /// \brief
+        /// Returns the shape class of a hand from its suit lengths.
+        ///
+        /// \param lengths const int[] - number of cards held in each suit.
+        ///
+        /// \return ShapeClass - the kind of shape.
+        static ShapeClass shapeClass(const int lengths[NUMSUITS]);
+
+        /// \brief
+        /// Returns the range a count of high card points falls in.
+        ///
+        /// \param points int - high card points held.
+        ///
+        /// \return int - index of the range, from 0 for up to 9 points to NUMHCPBUCKETS - 1 for 22 or more.
+        static int hcpBucket(int points);
+
+    private:
+
+        /// The counts made by one worker, or the totals of all workers.
+        struct Histogram {
+
+            // Deals opened, indexed by dealer, seat of the opener counted from the dealer, opening bid,
+            // opener's high card points range and opener's shape class
+            long long opened[NUMPOSITIONS][NUMPOSITIONS][NUMBIDCODES][NUMHCPBUCKETS][NUMSHAPECLASSES];
+
+            // Deals passed out, indexed by dealer
+            long long passedOut[NUMPOSITIONS];
+
+            /// \brief
+            /// Adds the counts of another histogram to these.
+            ///
+            /// \param other const Histogram& - the counts to add.
+            ///
+            /// \return Histogram& - this histogram.
+            Histogram& operator+=(const Histogram& other);
+        };
+
+        long long numDeals;
+        unsigned long long seed;
+        int numThreads;
+        vector<Histogram> totals;
+        mutex totalsLock;
+        double dealsPerSecond = 0;
+
+        /// \brief
+        /// Deals and bids every chunk belonging to one worker thread, then adds its counts to the totals.
+        ///
+        /// \param threadIndex int - index of the worker, which handles every chunk equal to it modulo the thread count.
+        void worker(int threadIndex);
+};
+
+#endif // OPENINGSTATISTICS_H
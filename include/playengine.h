@@ -0,0 +1,148 @@
+#ifndef PLAYENGINE_H
+#define PLAYENGINE_H
+
+#include "cardset.h"
+#include "doubledummy.h"
+#include "game.h"
+#include "random.h"
+
+using namespace std;
+
+/// What a player can see when choosing a card: every card still held, the trump suit and the trick so far.
+struct PlayState {
+
+    // Cards still held by each position, not counting cards already played to the trick
+    CardSet hands[NUMPOSITIONS];
+
+    // Trump suit as a Suit value, or NOTRUMP
+    int trump;
+
+    // Position of the player to play and the number of cards already played to the trick
+    int seat;
+    int cardsPlayed;
+
+    // Suit led, and bit index and player of the card winning so far, meaningless when leading
+    int ledSuit;
+    int winningCard;
+    int winningSeat;
+};
+
+/// A way of choosing a card: given the state of play and the cards the player may legally play,
+/// returns the bit index of one of those cards.
+typedef int (*PlayPolicy)(const PlayState& state, CardSet legal, Random& randomizer);
+
+/// This class plays out a deal trick by trick with each player choosing cards by a cheap policy
+/// rather than by search, so that the tricks of a contract can be estimated over very large samples.
+/// Players must follow suit when they can, and a trick is won by the highest trump played or else by the
+/// highest card of the suit led. A play-out works entirely on card sets held in the engine, so no memory
+/// is allocated while playing.
+///
+class PlayEngine
+{
+    public:
+
+        /// \brief
+        /// Creates an engine with every player using the second-hand-low, third-hand-high heuristics.
+        PlayEngine();
+
+        /// \brief
+        /// Sets the policy used by every player.
+        ///
+        /// \param policy PlayPolicy - the way cards are chosen.
+        void setPolicy(PlayPolicy policy);
+
+        /// \brief
+        /// Sets the policy used by one player.
+        ///
+        /// \param position Position - the player.
+        /// \param policy PlayPolicy - the way the player chooses cards.
+        void setPolicy(Position position, PlayPolicy policy);
+
+        /// \brief
+        /// Plays out a dealt game for the given strain and opening leader.
+        ///
+        /// \param game Game& - a game whose cards have been dealt.
+        /// \param strain int - trump suit as a Suit value, or NOTRUMP.
+        /// \param leader Position - the player making the opening lead.
+        /// \param randomizer Random& - source of the random choices made by the policies.
+        ///
+        /// \return int - tricks taken by the opening leader and their partner.
+        int playOut(Game& game, int strain, Position leader, Random& randomizer);
+
+        /// \brief
+        /// Plays out a deal given as four card sets of equal size for the given strain and opening leader.
+        ///
+        /// \param deal const CardSet[] - the cards held by each position.
+        /// \param strain int - trump suit as a Suit value, or NOTRUMP.
+        /// \param leader Position - the player making the opening lead.
+        /// \param randomizer Random& - source of the random choices made by the policies.
+        ///
+        /// \return int - tricks taken by the opening leader and their partner.
+        int playOut(const CardSet deal[NUMPOSITIONS], int strain, Position leader, Random& randomizer);
+
+        /// \brief
+        /// Returns the cards a player may play: the cards of the suit led if any are held, otherwise every card.
+        ///
+        /// \param state const PlayState& - the state of play.
+        ///
+        /// \return CardSet - the legal cards.
+        static CardSet legalCards(const PlayState& state);
+
+        /// \brief
+        /// Checks whether a card beats the card currently winning the trick.
+        ///
+        /// \param card int - bit index of the card played.
+        /// \param winningCard int - bit index of the card currently winning.
+        /// \param trump int - trump suit as a Suit value, or NOTRUMP.
+        ///
+        /// \return bool - true if the new card wins the trick so far.
+        static bool beats(int card, int winningCard, int trump);
+
+        /// \brief
+        /// Plays a legal card chosen uniformly at random.
+        ///
+        /// \param state const PlayState& - the state of play.
+        /// \param legal CardSet - the cards the player may play.
+        /// \param randomizer Random& - source of random choices.
+        ///
+        /// \return int - bit index of the card played.
+        static int randomPolicy(const PlayState& state, CardSet legal, Random& randomizer);
+
+        /// \brief
+        /// Plays the highest ranking legal card.
+        ///
+        /// \param state const PlayState& - the state of play.
+        /// \param legal CardSet - the cards the player may play.
+        /// \param randomizer Random& - source of random choices.
+        ///
+        /// \return int - bit index of the card played.
+        static int highestPolicy(const PlayState& state, CardSet legal, Random& randomizer);
+
+        /// \brief
+        /// Plays the lowest ranking legal card.
+        ///
+        /// \param state const PlayState& - the state of play.
+        /// \param legal CardSet - the cards the player may play.
+        /// \param randomizer Random& - source of random choices.
+        ///
+        /// \return int - bit index of the card played.
+        static int lowestPolicy(const PlayState& state, CardSet legal, Random& randomizer);
+
+        /// \brief
+        /// Plays by simple rules of thumb. The leader cashes a card no one can beat in a side suit, or else
+        /// leads low from their longest suit. Second hand plays low. Third and fourth hand play low when
+        /// partner is winning, otherwise the cheapest card that wins the trick so far, ruffing when
+        /// void, and otherwise discard their lowest card outside trumps.
+        ///
+        /// \param state const PlayState& - the state of play.
+        /// \param legal CardSet - the cards the player may play.
+        /// \param randomizer Random& - source of random choices.
+        ///
+        /// \return int - bit index of the card played.
+        static int heuristicPolicy(const PlayState& state, CardSet legal, Random& randomizer);
+
+    private:
+        PlayPolicy policies[NUMPOSITIONS];
+};
+
+#endif // PLAYENGINE_H
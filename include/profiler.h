@@ -0,0 +1,114 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <iostream>
+
+using namespace std;
+
+/// The hot paths timed when the program is built with BRIDGE_PROFILING defined.
+enum ProfileCounter {
+    SHUFFLECOUNTER,
+    DEALCOUNTER,
+    EVALUATECOUNTER,
+    BIDCOUNTER,
+    PARSECOUNTER,
+    RENDERCOUNTER
+};
+
+const int NUMPROFILECOUNTERS = 6;
+
+/// This class gathers the time spent and calls made in each hot path, kept by each thread in its own
+/// counters so that timing takes no lock, and reports them added up and per thread. Times are read
+/// from the processor's time stamp counter where there is one and converted to seconds when reported.
+/// Code is timed with PROFILE_SCOPE, which only does anything when the program is built with
+/// BRIDGE_PROFILING defined, so an ordinary build pays nothing for it.
+///
+class Profiler
+{
+    public:
+
+        /// \brief
+        /// Reads the clock used for timing.
+        ///
+        /// \return uint64_t - processor cycles, or nanoseconds where there is no cycle counter.
+        static inline uint64_t ticks() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            return __builtin_ia32_rdtsc();
+#else
+            return steadyNanoseconds();
+#endif
+        }
+
+        /// \brief
+        /// Adds time and calls to the calling thread's counter.
+        ///
+        /// \param counter ProfileCounter - the hot path.
+        /// \param elapsed uint64_t - ticks spent.
+        /// \param calls long long - calls made.
+        static void record(ProfileCounter counter, uint64_t elapsed, long long calls);
+
+        /// \brief
+        /// Writes the counters of every thread and their totals as JSON.
+        ///
+        /// \param out ostream& - output stream receiving the JSON.
+        static void writeJson(ostream& out);
+
+        /// \brief
+        /// Writes a table of the calls, total time, time per call and cycles per call of each hot path.
+        ///
+        /// \param out ostream& - output stream receiving the table.
+        static void printSummary(ostream& out);
+
+        /// \brief
+        /// Arranges for the counters to be written to standard error when the program exits, as JSON
+        /// if the BRIDGE_PROFILE environment variable is "json", not at all if it is "off" and as
+        /// a table otherwise. Does nothing unless the program is built with BRIDGE_PROFILING defined.
+        static void reportAtExit();
+
+    private:
+
+        /// \brief
+        /// Reads a steady clock in nanoseconds.
+        ///
+        /// \return uint64_t - nanoseconds since an arbitrary point.
+        static uint64_t steadyNanoseconds();
+};
+
+/// Times the rest of the enclosing block under a counter, counting the given number of calls.
+class ProfileScope
+{
+    public:
+        ProfileScope(ProfileCounter counter, long long calls) :
+            counter(counter), calls(calls), start(Profiler::ticks()) {
+        }
+
+        ~ProfileScope() {
+            Profiler::record(counter, Profiler::ticks() - start, calls);
+        }
+
+        /// \brief
+        /// Changes the number of calls counted, for a batch whose size is only known once it is done.
+        ///
+        /// \param batchCalls long long - calls made.
+        void setCalls(long long batchCalls) {
+            calls = batchCalls;
+        }
+
+    private:
+        ProfileCounter counter;
+        long long calls;
+        uint64_t start;
+};
+
+#ifdef BRIDGE_PROFILING
+#define PROFILE_SCOPE(counter) ProfileScope profileScope(counter, 1)
+#define PROFILE_BATCH(counter, calls) ProfileScope profileScope(counter, calls)
+#define PROFILE_BATCH_CALLS(calls) profileScope.setCalls(calls)
+#else
+#define PROFILE_SCOPE(counter)
+#define PROFILE_BATCH(counter, calls)
+#define PROFILE_BATCH_CALLS(calls)
+#endif
+
+#endif // PROFILER_H
@@ -1,8 +1,11 @@
 #ifndef _random_h
 #define _random_h
 
+#include <cstdint>
 
 /// This class provides several functions for generating pseud-random numbers.
+/// Numbers come from a xoshiro256** generator whose 256-bit state is filled by SplitMix64,
+/// so every randomizer owns its own stream and no global state is shared between threads.
 ///
 class Random {
 public:
@@ -13,13 +16,33 @@ public:
    ///
    Random();
 
+   /// \brief
+   ///
+   /// Initialize the randomizer with a reproducible stream. Randomizers created with the same seed
+   /// and stream produce the same numbers, while different streams of one seed are independent.
+   /// The state is derived directly from the pair, so stream k can be started without generating
+   /// streams 0 to k-1 first.
+   ///
+   /// \param seed unsigned long long - seed shared by all streams of a run.
+   /// \param stream unsigned long long - index of the stream to be generated from the seed.
+   ///
+   Random(unsigned long long seed, unsigned long long stream);
+
+   /// \brief
+   ///
+   /// Generates the next 64 random bits of the stream.
+   /// \return uint64_t - a uniformly distributed 64-bit value.
+   ///
+   uint64_t next();
+
 
    /// \brief
    ///
-   /// Generates a random integer number greater than or equal to low and less than high.
+   /// Generates a random integer number greater than or equal to low and less than or equal to high.
+   /// Every value in the range is equally likely.
    /// \param low int - lower bound for range (inclusive).
-   /// \param high int - upper bound for range (exclusive).
-   /// \return int - A random integer number greater than or equal to low and less than high.
+   /// \param high int - upper bound for range (inclusive).
+   /// \return int - A random integer number greater than or equal to low and less than or equal to high.
    ///
    int randomInteger(int low, int high);
 
@@ -42,6 +65,7 @@ public:
    bool randomChance(double p);
 
 private:
+   uint64_t state[4];
 
    /// \brief
    ///
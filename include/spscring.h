@@ -0,0 +1,94 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/// Slots in a ring unless another capacity is given.
+const size_t RINGCAPACITY = 8;
+
+/// Bytes in a cache line, keeping the two ends of a ring from sharing one.
+const size_t CACHELINEBYTES = 64;
+
+/// This class is a bounded queue between exactly one producing thread and one consuming thread. The
+/// producer only writes the tail and the consumer only writes the head, so neither end takes a lock:
+/// a push or pop is a load of the other end, a copy and a release store. A push into a full ring or a
+/// pop from an empty one fails rather than waiting, leaving the caller to decide how to wait.
+///
+template <typename T>
+class SpscRing
+{
+    public:
+
+        /// \brief
+        /// Creates an empty ring.
+        ///
+        /// \param capacity size_t - most items held, rounded up to a power of two.
+        SpscRing(size_t capacity = RINGCAPACITY) {
+            size_t size = 1;
+            while (size < capacity) {
+                size *= 2;
+            }
+            slots.resize(size);
+            mask = size - 1;
+        }
+
+        /// \brief
+        /// Adds an item at the tail. Only the producing thread may call this.
+        ///
+        /// \param item const T& - the item.
+        ///
+        /// \return bool - false if the ring is full.
+        bool push(const T& item) {
+            size_t position = tail.load(memory_order_relaxed);
+            if (position - head.load(memory_order_acquire) == slots.size()) {
+                return false;
+            }
+            slots[position & mask] = item;
+            tail.store(position + 1, memory_order_release);
+            return true;
+        }
+
+        /// \brief
+        /// Takes the item at the head. Only the consuming thread may call this.
+        ///
+        /// \param item T& - receives the item.
+        ///
+        /// \return bool - false if the ring is empty.
+        bool pop(T& item) {
+            size_t position = head.load(memory_order_relaxed);
+            if (position == tail.load(memory_order_acquire)) {
+                return false;
+            }
+            item = slots[position & mask];
+            head.store(position + 1, memory_order_release);
+            return true;
+        }
+
+        /// \brief
+        /// Returns the number of items held, which may already be out of date when read by a third thread.
+        ///
+        /// \return size_t - items in the ring.
+        size_t size() {
+            return tail.load(memory_order_acquire) - head.load(memory_order_acquire);
+        }
+
+        /// \brief
+        /// Returns the most items the ring holds.
+        ///
+        /// \return size_t - the capacity.
+        size_t capacity() {
+            return slots.size();
+        }
+
+    private:
+        vector<T> slots;
+        size_t mask;
+        alignas(CACHELINEBYTES) atomic<size_t> head { 0 };
+        alignas(CACHELINEBYTES) atomic<size_t> tail { 0 };
+};
+
+#endif // SPSCRING_H
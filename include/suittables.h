@@ -0,0 +1,122 @@
+#ifndef SUITTABLES_H
+#define SUITTABLES_H
+
+#include <cstdint>
+#include "cardset.h"
+
+/// Number of different holdings a suit can have, one for each set of its 13 ranks.
+const int NUMHOLDINGS = 1 << 13;
+
+/// The features of one suit holding used to evaluate a hand.
+struct SuitInfo {
+
+    // Cards held in the suit
+    uint8_t length;
+
+    // Four for the ace, three for the king, two for the queen and one for the jack
+    uint8_t highCardPoints;
+
+    // Two for the ace and one for the king
+    uint8_t controls;
+
+    // Losing trick count: the top three cards, or all of a shorter suit, less the ace, the
+    // king if there are two cards and the queen if there are three
+    uint8_t losers;
+
+    // Quick tricks counted in halves: AK 4, AQ 3, A or KQ 2, Kx 1
+    uint8_t halfQuickTricks;
+
+    // Playing tricks counted in halves: the honours by the usual table, AKQ 6, AKJ or AQJ 5,
+    // AK, AQT or KQJ 4, AQ, AJT, KQT or KJT 3, A, KQ, KJ or QJT 2, Kx or QJ 1, and two for
+    // every card after the third
+    uint8_t halfPlayingTricks;
+
+    // Ace to ten held, the ace in bit 4 and the ten in bit 0
+    uint8_t topHonours;
+
+    // Ranks held from highest to lowest as characters (eg. "AQT4"), ending in a null
+    char ranks[14];
+};
+
+/// This class holds the features of every possible suit holding, worked out when the program is
+/// compiled so that evaluating a hand takes one lookup per suit and nothing has to be set up at startup.
+///
+struct SuitTables {
+    SuitInfo entries[NUMHOLDINGS];
+
+    // The evaluations of each holding packed one to a byte, from the lowest: high card points,
+    // length points, losers, controls, half quick tricks, half playing tricks, nothing and the length.
+    // None can reach a byte's limit even when added up over four suits, so the evaluations of a
+    // whole hand are the sum of the words of its suits.
+    uint64_t evaluations[NUMHOLDINGS];
+
+    constexpr SuitTables() : entries(), evaluations() {
+        const char rankNames[] = "23456789TJQKA";
+
+        for (int holding = 0; holding < NUMHOLDINGS; holding++) {
+            SuitInfo& info = entries[holding];
+            bool ace = (holding >> (ACE - TWO)) & 1;
+            bool king = (holding >> (KING - TWO)) & 1;
+            bool queen = (holding >> (QUEEN - TWO)) & 1;
+            bool jack = (holding >> (JACK - TWO)) & 1;
+            bool ten = (holding >> (TEN - TWO)) & 1;
+
+            int next = 0;
+            for (int rank = ACE; rank >= TWO; rank--) {
+                if ((holding >> (rank - TWO)) & 1) {
+                    info.ranks[next++] = rankNames[rank - TWO];
+                }
+            }
+            int length = next;
+
+            // Every character is set, as a constant may not leave any part of itself unwritten
+            while (next < 14) {
+                info.ranks[next++] = '\0';
+            }
+
+            info.length = length;
+            info.highCardPoints = 4 * ace + 3 * king + 2 * queen + jack;
+            info.controls = 2 * ace + king;
+            info.losers = (length < 3 ? length : 3) - ace - (king && length >= 2) - (queen && length >= 3);
+            info.halfQuickTricks = ace ? (king ? 4 : queen ? 3 : 2) : king ? (queen ? 2 : length >= 2) : 0;
+            info.topHonours = holding >> (TEN - TWO);
+
+            // A king needs one card beside it and a queen without the ace or king one more
+            int honourTricks = ace ? (king ? (queen ? 6 : jack ? 5 : 4) : queen ? (jack ? 5 : ten ? 4 : 3) : jack && ten ? 3 : 2)
+                             : king ? (length < 2 ? 0 : queen ? (jack ? 4 : ten ? 3 : 2) : jack ? (ten ? 3 : 2) : 1)
+                             : queen && jack && length >= 2 ? (ten ? 2 : 1) : 0;
+            info.halfPlayingTricks = honourTricks + 2 * (length > 3 ? length - 3 : 0);
+
+            evaluations[holding] = (uint64_t) info.highCardPoints | (uint64_t) (length > 4 ? length - 4 : 0) << 8
+                                 | (uint64_t) info.losers << 16 | (uint64_t) info.controls << 24
+                                 | (uint64_t) info.halfQuickTricks << 32 | (uint64_t) info.halfPlayingTricks << 40
+                                 | (uint64_t) length << 56;
+        }
+    }
+};
+
+/// The features of every suit holding, indexed by the holding's 13 rank bits.
+extern const SuitTables SUITTABLES;
+
+/// \brief
+/// Returns the features of one suit's holding.
+///
+/// \param holding Holding - the suit mask, bit n set when the card of rank n is held.
+///
+/// \return const SuitInfo& - the features of the holding.
+inline const SuitInfo& suitInfo(Holding holding) {
+    return SUITTABLES.entries[holding >> TWO];
+}
+
+/// \brief
+/// Returns the evaluations of one suit's holding packed into a word, ready to be added to those of
+/// the other suits.
+///
+/// \param holding Holding - the suit mask, bit n set when the card of rank n is held.
+///
+/// \return uint64_t - the evaluations one to a byte, in the order of SuitTables::evaluations.
+inline uint64_t suitEvaluations(Holding holding) {
+    return SUITTABLES.evaluations[holding >> TWO];
+}
+
+#endif // SUITTABLES_H
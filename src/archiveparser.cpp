@@ -0,0 +1,716 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "archiveparser.h"
+#include "profiler.h"
+
+/// This class reads the deals of a PBN or LIN archive, splitting the mapped file into chunks at
+/// record boundaries, parsing the chunks on several threads straight into packed deals and checking
+/// every deal, reporting any that fail with the line and column where they went wrong.
+///
+
+/// Lookup tables giving the rank, suit letter and seat letter a character stands for, or -1.
+struct ArchiveTables {
+    int8_t ranks[256];
+    int8_t suits[256];
+    int8_t seats[256];
+
+    constexpr ArchiveTables() : ranks(), suits(), seats() {
+        const char* rankChars = "23456789TJQKA";
+        for (int i = 0; i < 256; i++) {
+            ranks[i] = suits[i] = seats[i] = -1;
+        }
+        for (int i = 0; i < NUMRANKS; i++) {
+            ranks[(unsigned char) rankChars[i]] = TWO + i;
+        }
+        suits['C'] = suits['c'] = CLUBS;
+        suits['D'] = suits['d'] = DIAMONDS;
+        suits['H'] = suits['h'] = HEARTS;
+        suits['S'] = suits['s'] = SPADES;
+        seats['N'] = seats['n'] = NORTH;
+        seats['E'] = seats['e'] = EAST;
+        seats['S'] = seats['s'] = SOUTH;
+        seats['W'] = seats['w'] = WEST;
+    }
+};
+
+static constexpr ArchiveTables ARCHIVETABLES;
+
+static const char* POSITIONNAMES[NUMPOSITIONS] = { "North", "East", "South", "West" };
+
+/// Kept as the dealer of a deal whose archive gives neither its dealer nor its board.
+const uint8_t UNKNOWNDEALER = NUMPOSITIONS;
+
+/// \brief
+/// Names a card as the game input stream writes it, such as "AS".
+///
+/// \param rank int - the rank.
+/// \param suit int - the suit.
+///
+/// \return string - the card's name.
+static string cardName(int rank, int suit) {
+    const char* rankChars = "23456789TJQKA";
+    const char* suitChars = "CDHS";
+    return string(1, rankChars[rank - TWO]) + suitChars[suit];
+}
+
+/// \brief
+/// Describes a character found where it does not belong.
+///
+/// \param c char - the character.
+///
+/// \return string - the character quoted, or its code if it cannot be printed.
+static string describeChar(char c) {
+    if (c >= ' ' && c <= '~') {
+        return string("'") + c + "'";
+    }
+    return "character " + to_string((unsigned char) c);
+}
+
+/// \brief
+/// Reads a decimal number.
+///
+/// \param c const char*& - the first digit, left after the last.
+/// \param end const char* - end of the text.
+/// \param number uint32_t& - receives the number.
+///
+/// \return bool - true if there was at least one digit and the number fits.
+static bool readNumber(const char*& c, const char* end, uint32_t& number) {
+    uint64_t value = 0;
+    const char* start = c;
+    while (c < end && *c >= '0' && *c <= '9') {
+        value = value * 10 + (*c - '0');
+        if (value > UINT32_MAX) {
+            return false;
+        }
+        c++;
+    }
+    number = (uint32_t) value;
+    return c > start;
+}
+
+/// \brief
+/// Creates a parser with no archive open.
+ArchiveParser::ArchiveParser() {}
+
+/// \brief
+/// Unmaps the archive if it is still open.
+ArchiveParser::~ArchiveParser() {
+    close();
+}
+
+/// \brief
+/// Maps an archive into memory and tells PBN from LIN by its first character, PBN files
+/// starting with a tag or a comment.
+///
+/// \param fileName const string& - name of the archive.
+/// \param error string& - receives a description of the problem if the archive cannot be used.
+///
+/// \return bool - true if the archive was opened.
+bool ArchiveParser::open(const string& fileName, string& error) {
+    close();
+
+    mapped = mapFile(fileName, mappedBytes, error);
+    if (mapped == NULL) {
+        return false;
+    }
+
+    // A byte order mark may come before the first character
+    size_t first = mappedBytes >= 3 && memcmp(mapped, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+    while (first < mappedBytes && isspace(mapped[first])) {
+        first++;
+    }
+    format = first < mappedBytes && (mapped[first] == '[' || mapped[first] == '%' || mapped[first] == ';')
+        ? PBNFORMAT : LINFORMAT;
+    return true;
+}
+
+/// \brief
+/// Unmaps the archive and forgets its deals.
+void ArchiveParser::close() {
+    unmapFile(mapped, mappedBytes);
+    mapped = NULL;
+    mappedBytes = 0;
+    chunks.clear();
+    records.clear();
+    boards.clear();
+    dealers.clear();
+    errors.clear();
+    numErrors = 0;
+}
+
+/// \brief
+/// Returns the format of the open archive.
+///
+/// \return ArchiveFormat - PBN or LIN.
+ArchiveFormat ArchiveParser::getFormat() {
+    return format;
+}
+
+/// \brief
+/// Reads every deal of the archive. The deals and problems found are the same whatever
+/// the number of threads.
+///
+/// \param numThreads int - number of threads parsing chunks.
+///
+/// \return bool - true if no problem was found.
+bool ArchiveParser::parse(int numThreads) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    split();
+
+    vector<thread> workers;
+    nextChunk = 0;
+    for (int i = 0; i < min(numThreads, (int) chunks.size()); i++) {
+        workers.push_back(thread(&ArchiveParser::worker, this));
+    }
+    if (workers.empty()) {
+        worker();
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    // Joins the chunks' deals and problems in file order
+    size_t numDeals = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        numDeals += chunks[i].boards.size();
+    }
+    records.clear();
+    boards.clear();
+    dealers.clear();
+    records.reserve(numDeals * DEALBYTES);
+    boards.reserve(numDeals);
+    dealers.reserve(numDeals);
+    errors.clear();
+    numErrors = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        records.insert(records.end(), chunks[i].records.begin(), chunks[i].records.end());
+        boards.insert(boards.end(), chunks[i].boards.begin(), chunks[i].boards.end());
+        dealers.insert(dealers.end(), chunks[i].dealers.begin(), chunks[i].dealers.end());
+        for (size_t j = 0; j < chunks[i].errors.size() && errors.size() < (size_t) MAXARCHIVEERRORS; j++) {
+            errors.push_back(chunks[i].errors[j]);
+        }
+        numErrors += chunks[i].numErrors;
+    }
+    chunks.clear();
+
+    // Lines and columns are only counted for the problems kept, in one pass up to the last of them
+    const uint8_t* lineStart = mapped;
+    long long line = 1;
+    for (size_t i = 0; i < errors.size(); i++) {
+        const uint8_t* at = mapped + errors[i].offset;
+        const uint8_t* newline;
+        if (at < lineStart) {
+            lineStart = mapped;
+            line = 1;
+        }
+        while ((newline = (const uint8_t*) memchr(lineStart, '\n', at - lineStart)) != NULL) {
+            lineStart = newline + 1;
+            line++;
+        }
+        errors[i].line = line;
+        errors[i].column = at - lineStart + 1;
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    seconds = elapsed.count();
+    return numErrors == 0;
+}
+
+/// \brief
+/// Returns the number of valid deals read.
+///
+/// \return long long - count of deals.
+long long ArchiveParser::getNumDeals() {
+    return boards.size();
+}
+
+/// \brief
+/// Unpacks one deal read.
+///
+/// \param index long long - position of the deal among the valid deals, starting from zero.
+/// \param deal CardSet[] - receives the cards held by each position.
+void ArchiveParser::getDeal(long long index, CardSet deal[NUMPOSITIONS]) {
+    unpackDeal(records.data() + index * DEALBYTES, deal);
+}
+
+/// \brief
+/// Returns the board number of one deal read.
+///
+/// \param index long long - position of the deal among the valid deals, starting from zero.
+///
+/// \return long long - the board number, or zero if the archive gives none.
+long long ArchiveParser::getBoard(long long index) {
+    return boards[index];
+}
+
+/// \brief
+/// Returns the dealer of one deal read, following the board number where the archive names none.
+///
+/// \param index long long - position of the deal among the valid deals, starting from zero.
+///
+/// \return Position - the player dealing, or north if the archive gives neither dealer nor board.
+Position ArchiveParser::getDealer(long long index) {
+    return dealers[index] == UNKNOWNDEALER ? NORTH : (Position) dealers[index];
+}
+
+/// \brief
+/// Tells whether the archive gives the dealer of one deal read, by name or by its board number.
+///
+/// \param index long long - position of the deal among the valid deals, starting from zero.
+///
+/// \return bool - true if the dealer is given.
+bool ArchiveParser::hasDealer(long long index) {
+    return dealers[index] != UNKNOWNDEALER;
+}
+
+/// \brief
+/// Returns the first problems found, in the order they appear in the archive.
+///
+/// \return const vector<ArchiveError>& - at most MAXARCHIVEERRORS problems.
+const vector<ArchiveError>& ArchiveParser::getErrors() {
+    return errors;
+}
+
+/// \brief
+/// Returns the number of problems found, including those not kept.
+///
+/// \return long long - count of problems.
+long long ArchiveParser::getNumErrors() {
+    return numErrors;
+}
+
+/// \brief
+/// Returns the size of the open archive.
+///
+/// \return size_t - bytes in the file.
+size_t ArchiveParser::getBytes() {
+    return mappedBytes;
+}
+
+/// \brief
+/// Returns the speed of the last parse.
+///
+/// \return double - bytes of archive parsed per second.
+double ArchiveParser::getBytesPerSecond() {
+    return mappedBytes / max(seconds, 1e-9);
+}
+
+/// \brief
+/// Splits the archive into chunks of about ARCHIVECHUNKBYTES, each starting at a record boundary.
+void ArchiveParser::split() {
+    const char* begin = (const char*) mapped;
+    const char* end = begin + mappedBytes;
+    chunks.clear();
+
+    const char* chunkStart = begin;
+    while (chunkStart < end) {
+        const char* boundary = end;
+        if ((size_t) (end - chunkStart) > ARCHIVECHUNKBYTES) {
+            const char* c = chunkStart + ARCHIVECHUNKBYTES;
+            while ((c = (const char*) memchr(c, '\n', end - c)) != NULL) {
+                c++;
+
+                // A LIN record ends at any line end and a PBN game at a blank line
+                if (format == LINFORMAT) {
+                    boundary = c;
+                    break;
+                }
+                const char* next = c;
+                while (next < end && (*next == ' ' || *next == '\t' || *next == '\r')) {
+                    next++;
+                }
+                if (next < end && *next == '\n') {
+                    boundary = next + 1;
+                    break;
+                }
+            }
+            if (c == NULL) {
+                boundary = end;
+            }
+        }
+        Chunk chunk;
+        chunk.begin = chunkStart;
+        chunk.end = boundary;
+        chunks.push_back(chunk);
+        chunkStart = boundary;
+    }
+}
+
+/// \brief
+/// Parses chunks until none are left.
+void ArchiveParser::worker() {
+    size_t i;
+    while ((i = nextChunk++) < chunks.size()) {
+
+        // Each chunk is timed as one batch, counting the deals read once they are known
+        PROFILE_BATCH(PARSECOUNTER, 0);
+        if (format == PBNFORMAT) {
+            parsePbn(chunks[i]);
+        }
+        else {
+            parseLin(chunks[i]);
+        }
+        PROFILE_BATCH_CALLS(chunks[i].boards.size());
+    }
+}
+
+/// \brief
+/// Reads the games of a chunk of a PBN archive.
+///
+/// \param chunk Chunk& - the chunk, receiving its deals and problems.
+void ArchiveParser::parsePbn(Chunk& chunk) {
+    CardSet deal[NUMPOSITIONS];
+    bool haveDeal = false;
+    uint32_t board = 0;
+    int dealer = -1;
+
+    // A game ends at a blank line, or where a Board or Deal tag follows a game's deal
+    auto endGame = [&]() {
+        if (haveDeal) {
+            uint8_t gameDealer = dealer >= 0 ? dealer
+                : board > 0 ? (board - 1) % NUMPOSITIONS : UNKNOWNDEALER;
+            addDeal(chunk, deal, board, gameDealer);
+        }
+        haveDeal = false;
+        board = 0;
+        dealer = -1;
+    };
+
+    const char* line = chunk.begin;
+    while (line < chunk.end) {
+        const char* lineEnd = (const char*) memchr(line, '\n', chunk.end - line);
+        if (lineEnd == NULL) {
+            lineEnd = chunk.end;
+        }
+        const char* c = line;
+        while (c < lineEnd && (*c == ' ' || *c == '\t' || *c == '\r')) {
+            c++;
+        }
+        line = lineEnd + 1;
+        if (c == lineEnd) {
+            endGame();
+            continue;
+        }
+        if (*c != '[') {
+            continue;
+        }
+
+        // Only the Board, Dealer and Deal tags matter, and each sits on one line
+        const char* name = c + 1;
+        const char* nameEnd = name;
+        while (nameEnd < lineEnd && *nameEnd != ' ' && *nameEnd != '"' && *nameEnd != ']') {
+            nameEnd++;
+        }
+        size_t nameLength = nameEnd - name;
+        bool isBoard = nameLength == 5 && memcmp(name, "Board", 5) == 0;
+        bool isDealer = nameLength == 6 && memcmp(name, "Dealer", 6) == 0;
+        bool isDeal = nameLength == 4 && memcmp(name, "Deal", 4) == 0;
+        if (!isBoard && !isDealer && !isDeal) {
+            continue;
+        }
+        const char* value = (const char*) memchr(nameEnd, '"', lineEnd - nameEnd);
+        const char* valueEnd = value == NULL ? NULL : (const char*) memchr(value + 1, '"', lineEnd - value - 1);
+        if (valueEnd == NULL) {
+            addError(chunk, c, string(name, nameLength) + " tag has no quoted value");
+            continue;
+        }
+        value++;
+
+        if (haveDeal && (isBoard || isDeal)) {
+            endGame();
+        }
+        if (isBoard) {
+            const char* digit = value;
+            if (!readNumber(digit, valueEnd, board) || digit != valueEnd) {
+                addError(chunk, value, "board number expected");
+                board = 0;
+            }
+        }
+        else if (isDealer) {
+            if (valueEnd - value == 1 && ARCHIVETABLES.seats[(unsigned char) *value] >= 0) {
+                dealer = ARCHIVETABLES.seats[(unsigned char) *value];
+            }
+            else if (valueEnd > value && *value != '?' && *value != '-') {
+                addError(chunk, value, "dealer must be N, E, S or W");
+            }
+        }
+        else {
+            haveDeal = readPbnDeal(chunk, value, valueEnd, deal);
+        }
+    }
+    endGame();
+}
+
+/// \brief
+/// Reads the md tags of a chunk of a LIN archive.
+///
+/// \param chunk Chunk& - the chunk, receiving its deals and problems.
+void ArchiveParser::parseLin(Chunk& chunk) {
+    CardSet deal[NUMPOSITIONS];
+    Position dealer;
+
+    // A board named by qx goes with the next deal on its line, and one named by ah with the last
+    uint32_t nextBoard = 0;
+    long long lastDeal = -1;
+
+    const char* c = chunk.begin;
+    while (c < chunk.end) {
+        while (c < chunk.end && (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')) {
+            if (*c == '\n') {
+                nextBoard = 0;
+                lastDeal = -1;
+            }
+            c++;
+        }
+        if (c == chunk.end) {
+            break;
+        }
+
+        // Each tag is written as its name and value, each followed by a bar
+        const char* name = c;
+        while (c < chunk.end && *c != '|' && *c != '\n') {
+            c++;
+        }
+        if (c == chunk.end || *c == '\n') {
+            addError(chunk, name, "tag has no value");
+            continue;
+        }
+        size_t nameLength = c - name;
+        const char* value = ++c;
+        while (c < chunk.end && *c != '|' && *c != '\n') {
+            c++;
+        }
+        const char* valueEnd = c;
+        if (c < chunk.end && *c == '|') {
+            c++;
+        }
+
+        if (nameLength == 2 && memcmp(name, "md", 2) == 0) {
+            if (readLinDeal(chunk, value, valueEnd, deal, dealer)) {
+                lastDeal = chunk.boards.size();
+                addDeal(chunk, deal, nextBoard, dealer);
+            }
+            else {
+                lastDeal = -1;
+            }
+            nextBoard = 0;
+        }
+        else if (nameLength == 2 && memcmp(name, "ah", 2) == 0) {
+            const char* digit = value + 6;
+            uint32_t board;
+            if (lastDeal >= 0 && valueEnd - value > 6 && memcmp(value, "Board ", 6) == 0
+                && readNumber(digit, valueEnd, board)) {
+                chunk.boards[lastDeal] = board;
+                lastDeal = -1;
+            }
+        }
+        else if (nameLength == 2 && memcmp(name, "qx", 2) == 0) {
+            const char* digit = value + 1;
+            if (valueEnd - value < 2 || !readNumber(digit, valueEnd, nextBoard)) {
+                nextBoard = 0;
+            }
+        }
+    }
+}
+
+/// \brief
+/// Reads the value of a PBN Deal tag, such as "N:AKQ.JT9.876.5432 ...".
+///
+/// \param chunk Chunk& - the chunk, receiving any problem.
+/// \param value const char* - first character of the value.
+/// \param end const char* - the closing quote.
+/// \param deal CardSet[] - receives the cards held by each position.
+///
+/// \return bool - true if the value is a whole valid deal.
+bool ArchiveParser::readPbnDeal(Chunk& chunk, const char* value, const char* end, CardSet deal[NUMPOSITIONS]) {
+    if (end - value < 2 || ARCHIVETABLES.seats[(unsigned char) value[0]] < 0 || value[1] != ':') {
+        addError(chunk, value, "deal must start with N:, E:, S: or W:");
+        return false;
+    }
+    int first = ARCHIVETABLES.seats[(unsigned char) value[0]];
+    const char* handStarts[NUMPOSITIONS];
+    CardSet seen = 0;
+
+    // The hands follow clockwise from the first, each written spades to clubs with dots between suits
+    const char* c = value + 2;
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        int position = (first + i) % NUMPOSITIONS;
+        while (c < end && (*c == ' ' || *c == '\t')) {
+            c++;
+        }
+        handStarts[position] = c;
+        deal[position] = 0;
+        if (c < end && *c == '-') {
+            addError(chunk, c, "hand of " + string(POSITIONNAMES[position]) + " is not given");
+            return false;
+        }
+
+        int suit = SPADES;
+        for (; c < end && *c != ' ' && *c != '\t'; c++) {
+            if (*c == '.') {
+                if (--suit < CLUBS) {
+                    addError(chunk, c, "hand of " + string(POSITIONNAMES[position]) + " has more than four suits");
+                    return false;
+                }
+                continue;
+            }
+            int rank = ARCHIVETABLES.ranks[(unsigned char) *c];
+            if (rank < 0) {
+                addError(chunk, c, "unexpected " + describeChar(*c) + " in deal");
+                return false;
+            }
+            CardSet bit = cardBit((Rank) rank, (Suit) suit);
+            if ((seen & bit) != 0) {
+                addError(chunk, c, "card " + cardName(rank, suit) + " appears twice");
+                return false;
+            }
+            seen |= bit;
+            deal[position] |= bit;
+        }
+        if (suit != CLUBS) {
+            addError(chunk, handStarts[position], "hand of " + string(POSITIONNAMES[position]) + " has fewer than four suits");
+            return false;
+        }
+    }
+    while (c < end && (*c == ' ' || *c == '\t')) {
+        c++;
+    }
+    if (c != end) {
+        addError(chunk, c, "unexpected text after the fourth hand");
+        return false;
+    }
+    return checkHands(chunk, deal, handStarts);
+}
+
+/// \brief
+/// Reads the value of a LIN md tag, such as "3SAKQHJT9D876C5432,S...,S...,".
+///
+/// \param chunk Chunk& - the chunk, receiving any problem.
+/// \param value const char* - first character of the value.
+/// \param end const char* - the bar or line end after the value.
+/// \param deal CardSet[] - receives the cards held by each position.
+/// \param dealer Position& - receives the player dealing.
+///
+/// \return bool - true if the value is a whole valid deal.
+bool ArchiveParser::readLinDeal(Chunk& chunk, const char* value, const char* end, CardSet deal[NUMPOSITIONS],
+                                Position& dealer) {
+
+    // Dealers and hands both go round from south: 1 and the first hand are south, 2 west, 3 north, 4 east
+    if (end == value || *value < '1' || *value > '4') {
+        addError(chunk, value, "deal must start with the dealer, 1 to 4");
+        return false;
+    }
+    dealer = (Position) ((SOUTH + *value - '1') % NUMPOSITIONS);
+
+    const char* handStarts[NUMPOSITIONS];
+    CardSet seen = 0;
+    int hand = 0;
+    int suit = -1;
+    const char* c = value + 1;
+    handStarts[SOUTH] = c;
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        deal[i] = 0;
+    }
+    for (; c < end; c++) {
+        int position = (SOUTH + hand) % NUMPOSITIONS;
+        if (*c == ',') {
+            if (++hand == NUMPOSITIONS) {
+
+                // A comma may follow the last hand
+                if (c + 1 == end) {
+                    break;
+                }
+                addError(chunk, c, "more than four hands");
+                return false;
+            }
+            handStarts[(SOUTH + hand) % NUMPOSITIONS] = c + 1;
+            suit = -1;
+            continue;
+        }
+        if (ARCHIVETABLES.suits[(unsigned char) *c] >= 0) {
+            suit = ARCHIVETABLES.suits[(unsigned char) *c];
+            continue;
+        }
+        int rank = ARCHIVETABLES.ranks[(unsigned char) *c];
+        if (rank < 0) {
+            addError(chunk, c, "unexpected " + describeChar(*c) + " in deal");
+            return false;
+        }
+        if (suit < 0) {
+            addError(chunk, c, "rank before any suit in hand of " + string(POSITIONNAMES[position]));
+            return false;
+        }
+        CardSet bit = cardBit((Rank) rank, (Suit) suit);
+        if ((seen & bit) != 0) {
+            addError(chunk, c, "card " + cardName(rank, suit) + " appears twice");
+            return false;
+        }
+        seen |= bit;
+        deal[position] |= bit;
+    }
+    for (int i = hand + 1; i < NUMPOSITIONS; i++) {
+        handStarts[(SOUTH + i) % NUMPOSITIONS] = end;
+    }
+
+    // The last hand is often left out, as it holds the cards the others do not
+    int east = (SOUTH + NUMPOSITIONS - 1) % NUMPOSITIONS;
+    if (deal[east] == 0 && cardCount(seen) == NUMCARDS - NUMRANKS) {
+        deal[east] = ALLCARDS & ~seen;
+    }
+    return checkHands(chunk, deal, handStarts);
+}
+
+/// \brief
+/// Checks that each hand holds 13 cards, reporting the first that does not.
+///
+/// \param chunk Chunk& - the chunk, receiving any problem.
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param handStarts const char* const[] - where each position's hand is written.
+///
+/// \return bool - true if every hand holds 13 cards.
+bool ArchiveParser::checkHands(Chunk& chunk, const CardSet deal[NUMPOSITIONS], const char* const handStarts[NUMPOSITIONS]) {
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        if (cardCount(deal[i]) != NUMRANKS) {
+            addError(chunk, handStarts[i], "hand of " + string(POSITIONNAMES[i]) + " has "
+                     + to_string(cardCount(deal[i])) + (cardCount(deal[i]) == 1 ? " card" : " cards"));
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \brief
+/// Adds a valid deal to a chunk.
+///
+/// \param chunk Chunk& - the chunk.
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param board uint32_t - the board number, or zero if none was given.
+/// \param dealer uint8_t - the player dealing, or UNKNOWNDEALER if the archive gives none.
+void ArchiveParser::addDeal(Chunk& chunk, const CardSet deal[NUMPOSITIONS], uint32_t board, uint8_t dealer) {
+    size_t size = chunk.records.size();
+    chunk.records.resize(size + DEALBYTES);
+    packDeal(deal, chunk.records.data() + size);
+    chunk.boards.push_back(board);
+    chunk.dealers.push_back(dealer);
+}
+
+/// \brief
+/// Records a problem found in a chunk.
+///
+/// \param chunk Chunk& - the chunk.
+/// \param at const char* - the character where the problem was found.
+/// \param message const string& - what is wrong.
+void ArchiveParser::addError(Chunk& chunk, const char* at, const string& message) {
+    chunk.numErrors++;
+    if (chunk.errors.size() < (size_t) MAXARCHIVEERRORS) {
+        ArchiveError error;
+        error.offset = at - (const char*) mapped;
+        error.line = 0;
+        error.column = 0;
+        error.message = message;
+        chunk.errors.push_back(error);
+    }
+}
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "biddingsystem.h"
+
+/// This class holds a system of opening bids read from rules, each a bid and the ranges of hand
+/// values it needs, compiled into a table giving the bid for every shape and strength.
+///
+
+// The rules of the standard system, which bids as hands have always been bid
+static const char* STANDARDRULES =
+    "# Strong hands open 2C whatever their shape\n"
+    "2C            strength 22+\n"
+    "\n"
+    "# Balanced hands open a minor or no trumps by strength\n"
+    "pass          balanced strength 12-\n"
+    "1minor        balanced strength 13-14\n"
+    "1NT           balanced strength 15-17\n"
+    "1minor        balanced strength 18-19\n"
+    "2NT           balanced strength 20-21\n"
+    "\n"
+    "# Unbalanced hands open their longest suit, the lowest of 4-4-4-1 and the highest of two longer suits\n"
+    "1longest      strength 13-21 longest 4-\n"
+    "1longest-high strength 13-21\n"
+    "\n"
+    "# Weak hands preempt at the level their longest suit allows, but never in clubs at the two level\n"
+    "2longest-high strength 12- longest 6 longest-suits 2\n"
+    "pass          strength 12- longest 6 clubs 6\n"
+    "2longest      strength 12- longest 6\n"
+    "3longest      strength 12- longest 7\n"
+    "4longest      strength 12- longest 8\n";
+
+// The offset basis and prime of the 64-bit FNV-1a hash
+const uint64_t FNVOFFSETBASIS = 0xCBF29CE484222325ULL;
+const uint64_t FNVPRIME = 0x100000001B3ULL;
+
+// Points at the standard system from the start so looking up a bid takes no call; a hand bid
+// before this is initialised still finds the standard system through active()
+const BiddingSystem* BiddingSystem::activeSystem = &BiddingSystem::standard();
+
+/// \brief
+/// Reads a range of values such as 15-17, 5+, 12- or 7.
+///
+/// \param range const string& - the range.
+/// \param low int& - receives the lowest value in the range.
+/// \param high int& - receives the highest value in the range.
+///
+/// \return bool - true if the range was read.
+static bool parseRange(const string& range, int& low, int& high) {
+    size_t digits = 0;
+    while (digits < range.size() && isdigit(range[digits])) {
+        digits++;
+    }
+    if (digits == 0 || digits > 2) {
+        return false;
+    }
+
+    low = stoi(range.substr(0, digits));
+    high = low;
+    string rest = range.substr(digits);
+    if (rest == "+") {
+        high = UINT8_MAX;
+    }
+    else if (rest == "-") {
+        high = low;
+        low = 0;
+    }
+    else if (rest.size() > 1 && rest[0] == '-' && rest.size() <= 3
+             && all_of(rest.begin() + 1, rest.end(), ::isdigit)) {
+        high = stoi(rest.substr(1));
+    }
+    else if (!rest.empty()) {
+        return false;
+    }
+    return true;
+}
+
+/// \brief
+/// Creates a system holding the standard rules.
+BiddingSystem::BiddingSystem() {
+    string error;
+    compile(STANDARDRULES, error);
+}
+
+/// \brief
+/// Reads the rules of a system from a file and compiles them.
+///
+/// \param fileName const string& - name of the file.
+/// \param error string& - receives a description of the first error found.
+///
+/// \return bool - true if the rules were compiled, false leaving the system unchanged.
+bool BiddingSystem::load(const string& fileName, string& error) {
+    ifstream file(fileName);
+    if (!file) {
+        error = "Error: Could not open " + fileName;
+        return false;
+    }
+    stringstream text;
+    text << file.rdbuf();
+    if (!compile(text.str(), error)) {
+        error += " in " + fileName;
+        return false;
+    }
+    return true;
+}
+
+/// \brief
+/// Compiles the rules of a system, replacing the rules compiled before.
+///
+/// \param text const string& - the rules, one per line.
+/// \param error string& - receives a description of the first error found.
+///
+/// \return bool - true if the rules were compiled, false leaving the system unchanged.
+bool BiddingSystem::compile(const string& text, string& error) {
+    vector<Condition> newConditions;
+    vector<Rule> newRules;
+    int newMaxStrength = 0;
+
+    istringstream lines(text);
+    string line;
+    for (int lineNumber = 1; getline(lines, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        transform(line.begin(), line.end(), line.begin(), ::tolower);
+        istringstream tokens(line);
+        string token;
+        if (!(tokens >> token)) {
+            continue;
+        }
+
+        auto fail = [&](const string& message) {
+            error = "Error: " + message + " at '" + token + "' on line " + to_string(lineNumber);
+            return false;
+        };
+
+        // The bid, either written out or a level and a strain chosen by the hand's lengths
+        Rule rule;
+        rule.firstCondition = newConditions.size();
+        BidCode code;
+        if (Hand::parseBidName(token, code)) {
+            rule.level = code == PASSBID ? 0 : (code - 1) / 5 + 1;
+            rule.strain = code == PASSBID ? 0 : (code - 1) % 5;
+        }
+        else if (token.size() > 1 && token[0] >= '1' && token[0] <= '7') {
+            rule.level = token[0] - '0';
+            string strain = token.substr(1);
+            if (strain == "longest") {
+                rule.strain = LONGESTSTRAIN;
+            }
+            else if (strain == "longest-high") {
+                rule.strain = LONGESTHIGHSTRAIN;
+            }
+            else if (strain == "minor") {
+                rule.strain = MINORSTRAIN;
+            }
+            else {
+                return fail("expected a strain of C, D, H, S, NT, longest, longest-high or minor");
+            }
+        }
+        else {
+            return fail("expected a bid such as 1NT, 1minor, 2longest or pass");
+        }
+
+        // The conditions, each a feature and the range it must lie in
+        while (tokens >> token) {
+            Condition condition;
+            int low = 0;
+            int high = 0;
+            if (token == "balanced" || token == "unbalanced") {
+                condition.feature = BALANCEDFEATURE;
+                low = high = token == "balanced" ? 1 : 0;
+            }
+            else {
+                const char* featureNames[] = { "clubs", "diamonds", "hearts", "spades", "strength", "", "longest", "longest-suits" };
+                auto found = find(begin(featureNames), end(featureNames), token);
+                if (found == end(featureNames)) {
+                    return fail("expected a condition such as balanced or strength 15-17");
+                }
+                condition.feature = found - begin(featureNames);
+                if (!(tokens >> token) || !parseRange(token, low, high) || low > high) {
+                    return fail("expected a range such as 15-17, 5+, 12- or 7");
+                }
+
+                // Strengths past the highest bound named all bid alike, so the table stops there
+                if (condition.feature == STRENGTHFEATURE) {
+                    newMaxStrength = max(newMaxStrength, high < UINT8_MAX ? high + 1 : low);
+                }
+            }
+            condition.low = low;
+            condition.high = high;
+            newConditions.push_back(condition);
+        }
+        rule.numConditions = newConditions.size() - rule.firstCondition;
+        newRules.push_back(rule);
+    }
+
+    conditions = newConditions;
+    rules = newRules;
+    maxStrength = newMaxStrength;
+    buildTable();
+    return true;
+}
+
+/// \brief
+/// Returns the number of rules in the system.
+///
+/// \return int - count of rules.
+int BiddingSystem::getNumRules() {
+    return rules.size();
+}
+
+/// \brief
+/// Returns a hash of the bids the system makes, which differs between systems bidding any
+/// hand differently and is kept in files holding bids so that they can tell which system made them.
+///
+/// \return uint64_t - the FNV-1a hash of the bid table and the highest strength it tells apart.
+uint64_t BiddingSystem::getHash() const {
+    return hash;
+}
+
+/// \brief
+/// Returns the rules of the standard system, which every system starts with.
+///
+/// \return string - the rules, one per line.
+string BiddingSystem::standardRules() {
+    return STANDARDRULES;
+}
+
+/// \brief
+/// Makes every hand decide its opening bid by a system. It should be set before any
+/// thread starts bidding, and the system must be kept for as long as hands are bid.
+///
+/// \param system const BiddingSystem& - the system.
+void BiddingSystem::setActive(const BiddingSystem& system) {
+    activeSystem = &system;
+}
+
+/// \brief
+/// Returns the standard system, compiling it the first time it is needed.
+///
+/// \return const BiddingSystem& - the standard system.
+const BiddingSystem& BiddingSystem::standard() {
+    static const BiddingSystem system;
+    return system;
+}
+
+/// \brief
+/// Runs the rules for a hand with the given features and works out the bid of the first that matches.
+///
+/// \param features const int[] - the value of each SystemFeature.
+///
+/// \return BidCode - the bid, or PASSBID if no rule matches.
+BidCode BiddingSystem::decide(const int features[NUMSYSTEMFEATURES]) const {
+    for (const Rule& rule : rules) {
+        bool matches = true;
+        for (int i = rule.firstCondition; i < rule.firstCondition + rule.numConditions && matches; i++) {
+            const Condition& condition = conditions[i];
+            int value = features[condition.feature];
+            matches = value >= condition.low && value <= condition.high;
+        }
+        if (!matches) {
+            continue;
+        }
+        if (rule.level == 0) {
+            return PASSBID;
+        }
+
+        int strain = rule.strain;
+        if (strain == LONGESTSTRAIN || strain == LONGESTHIGHSTRAIN) {
+            for (int suit = 0; suit < NUMSUITS; suit++) {
+                if (features[suit] == features[LONGESTFEATURE]) {
+                    strain = suit;
+                    if (rule.strain == LONGESTSTRAIN) {
+                        break;
+                    }
+                }
+            }
+        }
+        else if (strain == MINORSTRAIN) {
+            int clubs = features[CLUBSFEATURE];
+            int diamonds = features[DIAMONDSFEATURE];
+            strain = diamonds > clubs || (diamonds == clubs && diamonds >= 4) ? DIAMONDS : CLUBS;
+        }
+        return (rule.level - 1) * 5 + strain + 1;
+    }
+    return PASSBID;
+}
+
+/// \brief
+/// Fills the table with the bid for every shape and strength, and hashes it.
+void BiddingSystem::buildTable() {
+    table.assign(NUMBIDSHAPES * (maxStrength + 1), PASSBID);
+
+    for (int clubs = 0; clubs <= NUMRANKS; clubs++) {
+        for (int diamonds = 0; clubs + diamonds <= NUMRANKS; diamonds++) {
+            for (int hearts = 0; clubs + diamonds + hearts <= NUMRANKS; hearts++) {
+                int lengths[NUMSUITS] = { clubs, diamonds, hearts, NUMRANKS - clubs - diamonds - hearts };
+                int shapeCode = (clubs * 14 + diamonds) * 14 + hearts;
+
+                int features[NUMSYSTEMFEATURES] = {};
+                copy(lengths, lengths + NUMSUITS, features);
+                features[BALANCEDFEATURE] = Hand::calculateShape(lengths);
+                features[LONGESTFEATURE] = *max_element(lengths, lengths + NUMSUITS);
+                features[LONGESTSUITSFEATURE] = count(lengths, lengths + NUMSUITS, features[LONGESTFEATURE]);
+
+                for (int strength = 0; strength <= maxStrength; strength++) {
+                    features[STRENGTHFEATURE] = strength;
+                    table[shapeCode * (maxStrength + 1) + strength] = decide(features);
+                }
+            }
+        }
+    }
+
+    hash = (FNVOFFSETBASIS ^ maxStrength) * FNVPRIME;
+    for (BidCode bid : table) {
+        hash = (hash ^ bid) * FNVPRIME;
+    }
+}
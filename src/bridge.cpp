@@ -1,25 +1,101 @@
 /// File: bridge.cpp
 /// Creates a deck of cards, shuffles them and displays them.
+///
+/// Usage: bridge [file]
+///        bridge --generate N [--seed S] [--threads T]
+///        bridge --ddtable N [--seed S]
+///        bridge --filter EXPRESSION N [--seed S] [--attempts A]
+///        bridge --classify N [--seed S] [--scalar]
+///        bridge --evaluate N [--seed S]
+///        bridge --stats N [--seed S] [--threads T]
+///        bridge --playout N [--seed S] [--strain C|D|H|S|NT] [--declarer N|E|S|W]
+///                          [--policy heuristic|random|highest|lowest] [--compare]
+///        bridge --render N [--seed S] [--layout diagram|pbn|compact] [--sequential|--stream]
+///                          [--generators G] [--evaluators E] [--formatters F]
+///        bridge --tobinary TEXTFILE DEALFILE
+///        bridge --totext DEALFILE TEXTFILE
+///        bridge --import ARCHIVE DEALFILE [--threads T]
+///        bridge --index DEALFILE INDEXFILE
+///        bridge --query INDEXFILE QUERY
+///        bridge --tonumbers TEXTFILE
+///        bridge --fromnumber NUMBER [COUNT]
+///        bridge --layouts NORTHHAND SOUTHHAND [--lengths S,H,D,C] [--threads T]
+///        bridge --exact [--known HAND]... [--opening BID]
+///        bridge --serve SOCKET|- [--workers W]
+///
+/// Any of these may be preceded by --system RULESFILE to open every hand by the bidding system
+/// in the file instead of the standard one. An index keeps the bids of the system it was built
+/// with, so --query needs the same --system as --index.
+///
+/// A build with BRIDGE_PROFILING defined writes the time spent in each hot path to standard error
+/// on exit, as a table, as JSON if BRIDGE_PROFILE=json or not at all if BRIDGE_PROFILE=off.
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <vector>
 #include "game.h"
+#include "archiveparser.h"
+#include "biddingsystem.h"
+#include "bulkdealer.h"
+#include "dealfile.h"
+#include "dealnumber.h"
+#include "dealpipeline.h"
+#include "dealfilter.h"
+#include "dealindex.h"
+#include "dealrenderer.h"
+#include "dealservice.h"
+#include "doubledummy.h"
+#include "handbatch.h"
+#include "handdistribution.h"
+#include "layoutenumerator.h"
+#include "openingstatistics.h"
+#include "playengine.h"
+#include "profiler.h"
 
 const int NUM_DEALS = 4;
+const int MAX_POINTS = 37;
 
 using namespace std;
 
-int main(int argc, char *argv[]) {
+/// \brief
+/// Reads the number of deals a mode is asked for, reporting an error unless it is a whole number of at least 1.
+///
+/// \param text const char* - the number as given on the command line.
+/// \param numDeals long long& - receives the number of deals.
+/// \return bool - true if the number was read.
+bool readNumDeals(const char* text, long long& numDeals) {
+   char* end;
+   numDeals = strtoll(text, &end, 10);
+   if (end == text || *end != '\0' || numDeals < 1) {
+      cerr << "Error: The number of deals must be a whole number of at least 1" << endl;
+      return false;
+   }
+   return true;
+}
+
+/// \brief
+/// Plays the fixed number of deals, either shuffled or read from the file given, and displays them.
+///
+/// \param fileName const char* - file to read the deals from, or NULL to shuffle new deals.
+/// \return int - exit status of the program.
+int playDeals(const char* fileName) {
 
    Game game;
    ifstream infile;
    bool fromFile = false;
 
-   if (argc == 2) {
+   if (fileName != NULL) {
 
       // open the file and check it exists
-      infile.open(argv[1]);
+      infile.open(fileName);
       if (infile.fail()) {
          cerr <<  "Error: Could not find file" << endl;
          return 1;
@@ -42,10 +118,1132 @@ int main(int argc, char *argv[]) {
 
 
    // close the file
-   if (argc ==2) {
+   if (fromFile) {
       infile.close();
    }
 
    return 0;
 }
 
+/// \brief
+/// Generates the requested number of deals on all cores and writes them to standard output,
+/// reporting the throughput on standard error.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --generate N.
+/// \return int - exit status of the program.
+int generateDeals(int argc, char *argv[]) {
+   long long numDeals;
+   if (!readNumDeals(argv[2], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+   int numThreads = thread::hardware_concurrency();
+
+   for (int i = 3; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--seed") == 0) {
+         seed = strtoull(argv[i + 1], NULL, 10);
+      }
+      else if (strcmp(argv[i], "--threads") == 0) {
+         numThreads = atoi(argv[i + 1]);
+      }
+   }
+   if (numThreads < 1) {
+      numThreads = 1;
+   }
+
+   BulkDealer dealer(numDeals, seed, numThreads);
+   dealer.run(cout);
+   cerr << "Generated " << numDeals << " deals with seed " << seed << " on " << numThreads << " threads ("
+        << fixed << setprecision(0) << dealer.getDealsPerSecond() << " deals/sec)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Writes a double dummy table with one row per strain and one column per declarer.
+///
+/// \param out ostream& - output stream receiving the table.
+/// \param table int[][] - the declarer's tricks indexed by strain and declarer.
+void printTable(ostream& out, int table[NUMSTRAINS][NUMPOSITIONS]) {
+   const char* strainNames[NUMSTRAINS] = { "C", "D", "H", "S", "NT" };
+
+   out << "      N  E  S  W" << endl;
+   for (int strain = NUMSTRAINS - 1; strain >= 0; strain--) {
+      out << setw(4) << strainNames[strain];
+      for (int declarer = 0; declarer < NUMPOSITIONS; declarer++) {
+         out << setw(3) << table[strain][declarer];
+      }
+      out << endl;
+   }
+}
+
+/// \brief
+/// Deals the requested number of games from a seed, fills the double dummy table of each and writes
+/// them to standard output, reporting the time taken per table on standard error.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --ddtable N.
+/// \return int - exit status of the program.
+int solveDeals(int argc, char *argv[]) {
+   long long numDeals;
+   if (!readNumDeals(argv[2], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+
+   for (int i = 3; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--seed") == 0) {
+         seed = strtoull(argv[i + 1], NULL, 10);
+      }
+   }
+
+   Game game;
+   DoubleDummy solver;
+   int table[NUMSTRAINS][NUMPOSITIONS];
+   double totalSeconds = 0;
+   double worstSeconds = 0;
+
+   for (long long deal = 0; deal < numDeals; deal++) {
+      game.setup(seed, deal);
+      game.deal();
+
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      solver.calculateTable(game, table);
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      totalSeconds += elapsed.count();
+      worstSeconds = max(worstSeconds, elapsed.count());
+
+      game.auction();
+      cout << game << endl;
+      printTable(cout, table);
+      cout << endl << "==============================================================" << endl << endl;
+   }
+
+   cerr << "Solved " << numDeals << " tables with seed " << seed << " (" << fixed << setprecision(3)
+        << (numDeals > 0 ? totalSeconds / numDeals : 0) << " sec average, " << worstSeconds << " sec worst, "
+        << solver.getNodes() << " nodes)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Deals random deals from a seed until the requested number satisfy the constraint expression given,
+/// writing the accepted deals to standard output and reporting the acceptance rate and throughput
+/// on standard error.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --filter EXPRESSION N.
+/// \return int - exit status of the program.
+int filterDeals(int argc, char *argv[]) {
+   long long numDeals;
+   if (!readNumDeals(argv[3], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+   long long maxAttempts = 100000000;
+
+   for (int i = 4; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--seed") == 0) {
+         seed = strtoull(argv[i + 1], NULL, 10);
+      }
+      else if (strcmp(argv[i], "--attempts") == 0) {
+         maxAttempts = atoll(argv[i + 1]);
+      }
+   }
+
+   DealFilter filter;
+   string error;
+   if (!filter.compile(argv[2], error)) {
+      cerr << error << endl;
+      return 1;
+   }
+
+   CardSet deal[NUMPOSITIONS];
+   long long accepted = 0;
+   long long attempts = 0;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+   while (accepted < numDeals && attempts < maxAttempts) {
+      if (filter.generate(seed, attempts++, deal)) {
+         writeTextDeal(cout, (Position) (accepted % NUMPOSITIONS), deal);
+         accepted++;
+      }
+   }
+   cout.flush();
+   chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+   cerr << "Accepted " << accepted << " of " << attempts << " deals with seed " << seed << " ("
+        << fixed << setprecision(4) << (attempts > 0 ? 100.0 * accepted / attempts : 0) << "% accepted, "
+        << setprecision(2) << (attempts > 0 ? (double) filter.getHandsDealt() / attempts : 0) << " hands dealt per deal, "
+        << setprecision(0) << accepted / elapsed.count() << " accepted deals/sec)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Deals the hands of the requested number of games from a seed, evaluates them all in one batch and
+/// writes how often each opening bid is chosen, reporting the evaluation throughput on standard error.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --classify N.
+/// \return int - exit status of the program.
+int classifyHands(int argc, char *argv[]) {
+   long long numDeals;
+   if (!readNumDeals(argv[2], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+   bool allowVector = true;
+
+   for (int i = 3; i < argc; i++) {
+      if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+         seed = strtoull(argv[++i], NULL, 10);
+      }
+      else if (strcmp(argv[i], "--scalar") == 0) {
+         allowVector = false;
+      }
+   }
+
+   Game game;
+   vector<CardSet> hands;
+   for (long long deal = 0; deal < numDeals; deal++) {
+      game.setup(seed, deal);
+      game.deal();
+      for (int i = 0; i < NUMPOSITIONS; i++) {
+         hands.push_back(game.getHand((Position) i)->getCards());
+      }
+   }
+
+   HandBatch batch(allowVector);
+   vector<HandFeatures> features(hands.size());
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   batch.evaluate(hands.data(), hands.size(), features.data());
+   chrono::duration<double> evaluated = chrono::steady_clock::now() - start;
+
+   long long bids[NUMBIDCODES] = { 0 };
+   for (size_t i = 0; i < features.size(); i++) {
+      bids[HandBatch::openingBid(features[i])]++;
+   }
+   chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+   for (int code = 0; code < NUMBIDCODES; code++) {
+      if (bids[code] > 0) {
+         cout << setw(6) << Hand::bidName(code) << setw(12) << bids[code] << endl;
+      }
+   }
+
+   cerr << "Classified " << hands.size() << " hands with seed " << seed << " using "
+        << (batch.usesVector() ? "AVX2" : "scalar code") << " (" << fixed << setprecision(0)
+        << hands.size() / max(evaluated.count(), 1e-9) << " hands/sec evaluated, "
+        << hands.size() / max(elapsed.count(), 1e-9) << " hands/sec bid)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Writes the mean, least and most of one evaluation over many hands or partnerships.
+///
+/// \param name const char* - name of the evaluation.
+/// \param counts const vector<long long>& - how many took each value.
+/// \param scale double - what one unit of the value is worth, a half for quick and playing tricks.
+void writeEvaluation(const char* name, const vector<long long>& counts, double scale) {
+   long long total = 0;
+   double sum = 0;
+   int least = -1;
+   int greatest = 0;
+   for (size_t value = 0; value < counts.size(); value++) {
+      if (counts[value] > 0) {
+         total += counts[value];
+         sum += counts[value] * (double) value;
+         least = least < 0 ? value : least;
+         greatest = value;
+      }
+   }
+   cout << left << setw(22) << name << right << fixed << setprecision(3) << setw(9) << sum * scale / max(total, 1LL)
+        << setprecision(1) << setw(8) << least * scale << setw(8) << greatest * scale << endl;
+}
+
+/// \brief
+/// Deals the hands of the requested number of games from a seed, works out every evaluation of each
+/// hand and partnership and writes their means and ranges and how often each fit length occurs,
+/// reporting the evaluation throughput on standard error against that of the features used to bid.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --evaluate N.
+/// \return int - exit status of the program.
+int evaluateHands(int argc, char *argv[]) {
+   long long numDeals;
+   if (!readNumDeals(argv[2], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+
+   for (int i = 3; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--seed") == 0) {
+         seed = strtoull(argv[i + 1], NULL, 10);
+      }
+   }
+
+   Game game;
+   vector<CardSet> hands;
+   for (long long deal = 0; deal < numDeals; deal++) {
+      game.setup(seed, deal);
+      game.deal();
+      for (int i = 0; i < NUMPOSITIONS; i++) {
+         hands.push_back(game.getHand((Position) i)->getCards());
+      }
+   }
+
+   HandBatch batch;
+   vector<HandFeatures> features(hands.size());
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   batch.evaluate(hands.data(), hands.size(), features.data());
+   chrono::duration<double> featuresTime = chrono::steady_clock::now() - start;
+
+   vector<HandEvaluation> evaluations(hands.size());
+   vector<PartnershipEvaluation> partnerships(numDeals * 2);
+   start = chrono::steady_clock::now();
+   batch.evaluate(hands.data(), hands.size(), evaluations.data());
+   chrono::duration<double> evaluationsTime = chrono::steady_clock::now() - start;
+   HandBatch::evaluatePartnerships(evaluations.data(), numDeals, partnerships.data());
+
+   vector<long long> points(MAX_POINTS + 1), losers(NUMRANKS), controls(NUMRANKS), quickTricks(2 * NUMRANKS + 1),
+                     playingTricks(2 * NUMRANKS + 1);
+   for (const HandEvaluation& hand : evaluations) {
+      points[hand.highCardPoints]++;
+      losers[hand.losers]++;
+      controls[hand.controls]++;
+      quickTricks[hand.halfQuickTricks]++;
+      playingTricks[hand.halfPlayingTricks]++;
+   }
+   vector<long long> fitLengths(NUMRANKS + 1), pairPoints(2 * MAX_POINTS + 1), pairLosers(2 * NUMRANKS),
+                     pairControls(2 * NUMRANKS), tricks(NUMRANKS + 1);
+   for (const PartnershipEvaluation& pair : partnerships) {
+      fitLengths[pair.fitLength]++;
+      pairPoints[pair.highCardPoints]++;
+      pairLosers[pair.losers]++;
+      pairControls[pair.controls]++;
+      tricks[pair.tricks]++;
+   }
+
+   cout << left << setw(22) << "Hands (" + to_string(hands.size()) + ")" << right << setw(9) << "mean"
+        << setw(8) << "least" << setw(8) << "most" << endl;
+   writeEvaluation("high card points", points, 1);
+   writeEvaluation("losers", losers, 1);
+   writeEvaluation("controls", controls, 1);
+   writeEvaluation("quick tricks", quickTricks, 0.5);
+   writeEvaluation("playing tricks", playingTricks, 0.5);
+   cout << endl << left << setw(22) << "Partnerships (" + to_string(partnerships.size()) + ")" << right
+        << setw(9) << "mean" << setw(8) << "least" << setw(8) << "most" << endl;
+   writeEvaluation("fit length", fitLengths, 1);
+   writeEvaluation("high card points", pairPoints, 1);
+   writeEvaluation("losers", pairLosers, 1);
+   writeEvaluation("controls", pairControls, 1);
+   writeEvaluation("tricks", tricks, 1);
+   cout << endl << "Fit length      count        %" << endl;
+   for (int length = 0; length <= NUMRANKS; length++) {
+      if (fitLengths[length] > 0) {
+         cout << setw(10) << length << setw(11) << fitLengths[length] << setw(9) << setprecision(3)
+              << 100.0 * fitLengths[length] / partnerships.size() << endl;
+      }
+   }
+
+   cerr << "Evaluated " << hands.size() << " hands with seed " << seed << " (" << fixed << setprecision(0)
+        << hands.size() / max(featuresTime.count(), 1e-9) << " hands/sec for the bidding features, "
+        << hands.size() / max(evaluationsTime.count(), 1e-9) << " hands/sec for every evaluation)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Deals and bids the requested number of games on all cores and writes how often each opening bid is
+/// made by seat, dealer, high card points and shape, reporting the throughput on standard error.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --stats N.
+/// \return int - exit status of the program.
+int openingStatistics(int argc, char *argv[]) {
+   long long numDeals;
+   if (!readNumDeals(argv[2], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+   int numThreads = thread::hardware_concurrency();
+
+   for (int i = 3; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--seed") == 0) {
+         seed = strtoull(argv[i + 1], NULL, 10);
+      }
+      else if (strcmp(argv[i], "--threads") == 0) {
+         numThreads = atoi(argv[i + 1]);
+      }
+   }
+   if (numThreads < 1) {
+      numThreads = 1;
+   }
+
+   OpeningStatistics statistics(numDeals, seed, numThreads);
+   statistics.run();
+   statistics.print(cout);
+   cerr << "Bid " << numDeals << " deals with seed " << seed << " on " << numThreads << " threads ("
+        << fixed << setprecision(0) << statistics.getDealsPerSecond() << " deals/sec)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Deals the requested number of games from a seed and plays each out in the given contract with the
+/// chosen play policy, writing how often declarer takes each number of tricks and reporting the throughput
+/// on standard error. When asked, each deal is also solved double dummy and the average difference given.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --playout N.
+/// \return int - exit status of the program.
+int playOutDeals(int argc, char *argv[]) {
+   const char* strainNames[NUMSTRAINS] = { "C", "D", "H", "S", "NT" };
+   const char* positionNames = "NESW";
+   const char* policyNames[] = { "heuristic", "random", "highest", "lowest" };
+   const PlayPolicy policies[] = { PlayEngine::heuristicPolicy, PlayEngine::randomPolicy,
+                                   PlayEngine::highestPolicy, PlayEngine::lowestPolicy };
+   long long numDeals;
+   if (!readNumDeals(argv[2], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+   int strain = NOTRUMP;
+   int declarer = SOUTH;
+   int policy = 0;
+   bool compare = false;
+
+   for (int i = 3; i < argc; i++) {
+      if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+         seed = strtoull(argv[++i], NULL, 10);
+      }
+      else if (strcmp(argv[i], "--strain") == 0 && i + 1 < argc) {
+         i++;
+         for (strain = 0; strain < NUMSTRAINS && strcmp(argv[i], strainNames[strain]) != 0; strain++);
+         if (strain == NUMSTRAINS) {
+            cerr << "Error: Unknown strain " << argv[i] << endl;
+            return 1;
+         }
+      }
+      else if (strcmp(argv[i], "--declarer") == 0 && i + 1 < argc) {
+         i++;
+         const char* position = strchr(positionNames, argv[i][0]);
+         if (position == NULL || argv[i][0] == '\0' || argv[i][1] != '\0') {
+            cerr << "Error: Unknown declarer " << argv[i] << endl;
+            return 1;
+         }
+         declarer = position - positionNames;
+      }
+      else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+         i++;
+         for (policy = 0; policy < 4 && strcmp(argv[i], policyNames[policy]) != 0; policy++);
+         if (policy == 4) {
+            cerr << "Error: Unknown policy " << argv[i] << endl;
+            return 1;
+         }
+      }
+      else if (strcmp(argv[i], "--compare") == 0) {
+         compare = true;
+      }
+   }
+
+   Game game;
+   PlayEngine engine;
+   DoubleDummy solver;
+   Random randomizer(seed, numDeals);
+   Position leader = (Position) ((declarer + 1) % NUMPOSITIONS);
+   long long tricks[NUMTRICKS + 1] = { 0 };
+   long long difference = 0;
+   long long distance = 0;
+   double playSeconds = 0;
+   engine.setPolicy(policies[policy]);
+
+   for (long long deal = 0; deal < numDeals; deal++) {
+      game.setup(seed, deal);
+      game.deal();
+
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      int declarerTricks = NUMTRICKS - engine.playOut(game, strain, leader, randomizer);
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      playSeconds += elapsed.count();
+      tricks[declarerTricks]++;
+
+      if (compare) {
+         int error = declarerTricks - (NUMTRICKS - solver.solve(game, strain, leader));
+         difference += error;
+         distance += abs(error);
+      }
+   }
+
+   double mean = 0;
+   cout << "Tricks taken by " << positionNames[declarer] << " in " << strainNames[strain] << " over " << numDeals
+        << " deals with " << policyNames[policy] << " play" << endl;
+   for (int i = 0; i <= NUMTRICKS; i++) {
+      cout << setw(6) << i << setw(14) << tricks[i] << fixed << setprecision(3) << setw(10)
+           << 100.0 * tricks[i] / max(numDeals, 1LL) << "%" << endl;
+      mean += (double) i * tricks[i] / max(numDeals, 1LL);
+   }
+   cout << "Average " << mean << " tricks" << endl;
+   if (compare) {
+      cout << "Average " << (double) difference / max(numDeals, 1LL) << " tricks more than double dummy, "
+           << (double) distance / max(numDeals, 1LL) << " tricks from it" << endl;
+   }
+
+   cerr << "Played out " << numDeals << " deals with seed " << seed << " (" << fixed << setprecision(0)
+        << numDeals / max(playSeconds, 1e-9) << " play-outs/sec)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Deals and bids the requested number of games from a seed and writes them to standard output through
+/// the pipeline of generation, evaluation, formatting and writing stages, reporting the throughput and
+/// each stage's counters on standard error. If asked the games are instead dealt, bid and written one
+/// after another on one thread through the buffered renderer or the game output stream, so that the
+/// three can be compared.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --render N.
+/// \return int - exit status of the program.
+int renderDeals(int argc, char *argv[]) {
+   long long numDeals;
+   if (!readNumDeals(argv[2], numDeals)) {
+      return 1;
+   }
+   unsigned long long seed = time(NULL);
+   Layout layout = DIAGRAM;
+   bool useStream = false;
+   bool sequential = false;
+   int stageThreads[NUMSTAGES] = { 1, 1, 1, 1 };
+
+   for (int i = 3; i < argc; i++) {
+      if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+         seed = strtoull(argv[++i], NULL, 10);
+      }
+      else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+         i++;
+         if (strcmp(argv[i], "pbn") == 0) {
+            layout = PBN;
+         }
+         else if (strcmp(argv[i], "compact") == 0) {
+            layout = COMPACT;
+         }
+         else if (strcmp(argv[i], "diagram") != 0) {
+            cerr << "Error: Unknown layout " << argv[i] << endl;
+            return 1;
+         }
+      }
+      else if (strcmp(argv[i], "--stream") == 0) {
+         useStream = true;
+      }
+      else if (strcmp(argv[i], "--sequential") == 0) {
+         sequential = true;
+      }
+      else if (strcmp(argv[i], "--generators") == 0 && i + 1 < argc) {
+         stageThreads[GENERATESTAGE] = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "--evaluators") == 0 && i + 1 < argc) {
+         stageThreads[EVALUATESTAGE] = atoi(argv[++i]);
+      }
+      else if (strcmp(argv[i], "--formatters") == 0 && i + 1 < argc) {
+         stageThreads[FORMATSTAGE] = atoi(argv[++i]);
+      }
+   }
+
+   if (!useStream && !sequential) {
+      DealPipeline pipeline(numDeals, seed, layout);
+      for (int stage = GENERATESTAGE; stage < WRITESTAGE; stage++) {
+         pipeline.setParallelism((PipelineStage) stage, stageThreads[stage]);
+      }
+      pipeline.run(cout);
+      cerr << "Rendered " << numDeals << " deals with seed " << seed << " using the pipeline (" << fixed
+           << setprecision(0) << pipeline.getDealsPerSecond() << " deals/sec)" << endl;
+      pipeline.printCounters(cerr);
+      return 0;
+   }
+
+   Game game;
+   DealRenderer renderer(layout);
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+   for (long long deal = 0; deal < numDeals; deal++) {
+      game.setup(seed, deal);
+      game.deal();
+      game.auction();
+
+      // The game output stream only has the diagram layout
+      if (useStream) {
+         cout << game << endl;
+         cout << endl << "==============================================================" << endl << endl;
+      }
+      else {
+         renderer.add(game);
+         if (renderer.full()) {
+            renderer.write(cout);
+         }
+      }
+      game.nextDealer();
+   }
+   renderer.write(cout);
+
+   chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+   cerr << "Rendered " << numDeals << " deals with seed " << seed << " using the "
+        << (useStream ? "game output stream" : "buffered renderer") << " (" << fixed << setprecision(0)
+        << numDeals / max(elapsed.count(), 1e-9) << " deals/sec)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Converts a text file of deals, one deal of 52 cards per line as written by --generate, into a binary
+/// deal file. Deal k is numbered board k + 1 and dealt by the player that board number gives.
+///
+/// \param textFile const char* - name of the text file to read.
+/// \param dealFile const char* - name of the binary deal file to write.
+/// \return int - exit status of the program.
+int convertToBinary(const char* textFile, const char* dealFile) {
+   ifstream in(textFile);
+   if (in.fail()) {
+      cerr << "Error: Could not find file" << endl;
+      return 1;
+   }
+
+   DealWriter writer;
+   if (!writer.open(dealFile)) {
+      cerr << "Error: Could not create " << dealFile << endl;
+      return 1;
+   }
+
+   CardSet deal[NUMPOSITIONS];
+   long long numDeals = 0;
+   while (!(in >> ws).eof()) {
+      if (!readTextDeal(in, (Position) (numDeals % NUMPOSITIONS), deal)) {
+         cerr << "Error: Deal " << numDeals + 1 << " of " << textFile << " is not 52 different cards" << endl;
+         return 1;
+      }
+      writer.write(deal);
+      numDeals++;
+   }
+   if (!writer.close()) {
+      cerr << "Error: Could not write " << dealFile << endl;
+      return 1;
+   }
+
+   cerr << "Converted " << numDeals << " deals" << endl;
+   return 0;
+}
+
+/// \brief
+/// Converts a binary deal file into a text file of deals, one deal of 52 cards per line, each
+/// arranged so that the game deals it to the same hands with the dealer of its board.
+///
+/// \param dealFile const char* - name of the binary deal file to read.
+/// \param textFile const char* - name of the text file to write.
+/// \return int - exit status of the program.
+int convertToText(const char* dealFile, const char* textFile) {
+   DealReader reader;
+   string error;
+   if (!reader.open(dealFile, error)) {
+      cerr << error << endl;
+      return 1;
+   }
+
+   ofstream out(textFile);
+   if (out.fail()) {
+      cerr << "Error: Could not create " << textFile << endl;
+      return 1;
+   }
+
+   CardSet deal[NUMPOSITIONS];
+   for (long long i = 0; i < reader.getNumDeals(); i++) {
+      reader.getDeal(i, deal);
+      writeTextDeal(out, reader.getDealer(i), deal);
+   }
+
+   cerr << "Converted " << reader.getNumDeals() << " deals" << endl;
+   return 0;
+}
+
+/// \brief
+/// Reads a PBN or LIN archive on several threads and writes its valid deals to a binary deal file,
+/// reporting where each invalid deal went wrong. Each deal keeps the board and dealer the archive
+/// gives it, a deal without a board taking the one after the deal before (board 1 for the first).
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --import ARCHIVE DEALFILE.
+/// \return int - exit status of the program.
+int importArchive(int argc, char *argv[]) {
+   int numThreads = thread::hardware_concurrency();
+   for (int i = 4; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--threads") == 0) {
+         numThreads = atoi(argv[i + 1]);
+      }
+   }
+   if (numThreads < 1) {
+      numThreads = 1;
+   }
+
+   ArchiveParser parser;
+   string error;
+   if (!parser.open(argv[2], error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   bool valid = parser.parse(numThreads);
+
+   const vector<ArchiveError>& errors = parser.getErrors();
+   for (size_t i = 0; i < errors.size(); i++) {
+      cerr << "Error: " << argv[2] << ":" << errors[i].line << ":" << errors[i].column << ": " << errors[i].message << endl;
+   }
+   if (parser.getNumErrors() > (long long) errors.size()) {
+      cerr << "Error: " << parser.getNumErrors() - errors.size() << " more problems in " << argv[2] << endl;
+   }
+
+   DealWriter writer;
+   long long firstBoard = parser.getNumDeals() > 0 && parser.getBoard(0) > 0 ? parser.getBoard(0) : 1;
+   if (!writer.open(argv[3], firstBoard)) {
+      cerr << "Error: Could not create " << argv[3] << endl;
+      return 1;
+   }
+
+   // Deals the archive numbers no board for follow on from the deal before
+   long long board = firstBoard - 1;
+   CardSet deal[NUMPOSITIONS];
+   for (long long i = 0; i < parser.getNumDeals(); i++) {
+      parser.getDeal(i, deal);
+      board = parser.getBoard(i) > 0 ? parser.getBoard(i) : board + 1;
+      Position dealer = parser.hasDealer(i) ? parser.getDealer(i) : (Position) ((board + NUMPOSITIONS - 1) % NUMPOSITIONS);
+      writer.write(deal, board, dealer);
+   }
+   if (!writer.close()) {
+      cerr << "Error: Could not write " << argv[3] << endl;
+      return 1;
+   }
+
+   cerr << "Imported " << parser.getNumDeals() << " deals from " << (parser.getFormat() == PBNFORMAT ? "PBN" : "LIN")
+        << " on " << numThreads << " threads (" << fixed << setprecision(1) << parser.getBytesPerSecond() / 1e6
+        << " MB/sec)" << endl;
+   return valid ? 0 : 1;
+}
+
+/// \brief
+/// Builds the seat feature index of a binary deal file.
+///
+/// \param dealFile const char* - name of the binary deal file to read.
+/// \param indexFile const char* - name of the index file to write.
+/// \return int - exit status of the program.
+int buildIndex(const char* dealFile, const char* indexFile) {
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   string error;
+   if (!DealIndex::build(dealFile, indexFile, error)) {
+      cerr << error << endl;
+      return 1;
+   }
+
+   DealIndex index;
+   if (!index.open(indexFile, error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+   cerr << "Indexed " << index.getNumDeals() << " deals (" << fixed << setprecision(0)
+        << index.getNumDeals() / max(elapsed.count(), 1e-9) << " deals/sec)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Writes the position in the deal file of each deal satisfying a query of a seat feature index,
+/// one per line, counting from zero.
+///
+/// \param indexFile const char* - name of the index file to read.
+/// \param query const char* - predicates joined by and, such as "S spades 5 and S hearts 5 and opening 1S".
+/// \return int - exit status of the program.
+int queryIndex(const char* indexFile, const char* query) {
+   DealIndex index;
+   string error;
+   if (!index.open(indexFile, error)) {
+      cerr << error << endl;
+      return 1;
+   }
+
+   vector<long long> matches;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   if (!index.find(query, matches, error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+   for (size_t i = 0; i < matches.size(); i++) {
+      cout << matches[i] << "\n";
+   }
+   cout.flush();
+   cerr << "Found " << matches.size() << " of " << index.getNumDeals() << " deals in " << fixed << setprecision(2)
+        << elapsed.count() * 1000 << " ms" << endl;
+   return 0;
+}
+
+/// \brief
+/// Reads a text file of deals, one deal of 52 cards per line as written by --generate, and writes
+/// the number of each deal on its own line. Deal k is dealt by the player board k + 1 gives.
+///
+/// \param textFile const char* - name of the text file to read.
+/// \return int - exit status of the program.
+int numberDeals(const char* textFile) {
+   ifstream in(textFile);
+   if (in.fail()) {
+      cerr << "Error: Could not find file" << endl;
+      return 1;
+   }
+
+   CardSet deal[NUMPOSITIONS];
+   long long numDeals = 0;
+   while (!(in >> ws).eof()) {
+      if (!readTextDeal(in, (Position) (numDeals % NUMPOSITIONS), deal)) {
+         cerr << "Error: Deal " << numDeals + 1 << " of " << textFile << " is not 52 different cards" << endl;
+         return 1;
+      }
+      cout << dealNumberToString(rankDeal(deal)) << "\n";
+      numDeals++;
+   }
+   cout.flush();
+   return 0;
+}
+
+/// \brief
+/// Writes the deals with consecutive numbers starting from the one given, one deal of 52 cards per line,
+/// each arranged so that the game deals it to the same hands with the dealer of its line's board.
+/// Splitting the numbers below the count of deals into ranges shares every deal out exactly once.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --fromnumber NUMBER.
+/// \return int - exit status of the program.
+int dealsFromNumber(int argc, char *argv[]) {
+   DealNumber number;
+   if (!parseDealNumber(argv[2], number)) {
+      cerr << "Error: Deal numbers run from 0 to " << dealNumberToString(NUMDEALNUMBERS - 1) << endl;
+      return 1;
+   }
+   long long count = argc >= 4 ? atoll(argv[3]) : 1;
+
+   CardSet deal[NUMPOSITIONS];
+   for (long long i = 0; i < count && number < NUMDEALNUMBERS; i++, number++) {
+      unrankDeal(number, deal);
+      writeTextDeal(cout, (Position) (i % NUMPOSITIONS), deal);
+   }
+   cout.flush();
+   return 0;
+}
+
+/// Counts east's suit lengths and high card points over the layouts visited by one thread.
+class LayoutCounter : public LayoutVisitor
+{
+   public:
+      long long lengths[NUMSUITS][NUMRANKS + 1] = {};
+      long long points[MAX_POINTS + 1] = {};
+
+      void visit(const LayoutState& layout) {
+         for (int suit = 0; suit < NUMSUITS; suit++) {
+            lengths[suit][layout.lengths[EAST][suit]]++;
+         }
+         points[layout.highCardPoints[EAST]]++;
+      }
+};
+
+/// \brief
+/// Visits every layout of the east and west hands once north and south are known, optionally with
+/// east's suit lengths fixed, and writes how often east holds each length in each suit and each
+/// number of high card points, reporting the throughput on standard error.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --layouts NORTHHAND SOUTHHAND.
+/// \return int - exit status of the program.
+int countLayouts(int argc, char *argv[]) {
+   const char* suitNames = "CDHS";
+   CardSet deal[NUMPOSITIONS] = {};
+   if (!readDottedHand(argv[2], deal[NORTH]) || !readDottedHand(argv[3], deal[SOUTH])) {
+      cerr << "Error: Hands are written as spades.hearts.diamonds.clubs, such as AK2.QJ4.T987.654" << endl;
+      return 1;
+   }
+
+   int numThreads = thread::hardware_concurrency();
+   const char* lengthText = NULL;
+   for (int i = 4; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--lengths") == 0) {
+         lengthText = argv[i + 1];
+      }
+      else if (strcmp(argv[i], "--threads") == 0) {
+         numThreads = atoi(argv[i + 1]);
+      }
+   }
+   if (numThreads < 1) {
+      numThreads = 1;
+   }
+
+   LayoutEnumerator enumerator;
+   string error;
+   if (!enumerator.setup(deal, EAST, WEST, error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   if (lengthText != NULL) {
+      int lengths[NUMSUITS];
+      if (sscanf(lengthText, "%d,%d,%d,%d", &lengths[SPADES], &lengths[HEARTS], &lengths[DIAMONDS],
+                 &lengths[CLUBS]) != NUMSUITS) {
+         cerr << "Error: Lengths are written as spades,hearts,diamonds,clubs, such as 4,3,3,3" << endl;
+         return 1;
+      }
+      if (!enumerator.setLengths(lengths, error)) {
+         cerr << error << endl;
+         return 1;
+      }
+   }
+
+   vector<LayoutCounter> counters(numThreads);
+   vector<LayoutVisitor*> visitors;
+   for (int i = 0; i < numThreads; i++) {
+      visitors.push_back(&counters[i]);
+   }
+   enumerator.run(visitors);
+
+   LayoutCounter total;
+   for (int i = 0; i < numThreads; i++) {
+      for (int suit = 0; suit < NUMSUITS; suit++) {
+         for (int length = 0; length <= NUMRANKS; length++) {
+            total.lengths[suit][length] += counters[i].lengths[suit][length];
+         }
+      }
+      for (int point = 0; point <= MAX_POINTS; point++) {
+         total.points[point] += counters[i].points[point];
+      }
+   }
+
+   long long numLayouts = enumerator.getNumLayouts();
+   cout << "Layouts: " << numLayouts << "\n";
+   cout << "East length";
+   for (int suit = SPADES; suit >= CLUBS; suit--) {
+      cout << setw(12) << suitNames[suit];
+   }
+   cout << "\n" << fixed << setprecision(4);
+   for (int length = 0; length <= NUMRANKS; length++) {
+      if (total.lengths[SPADES][length] + total.lengths[HEARTS][length] + total.lengths[DIAMONDS][length]
+          + total.lengths[CLUBS][length] == 0) {
+         continue;
+      }
+      cout << setw(11) << length;
+      for (int suit = SPADES; suit >= CLUBS; suit--) {
+         cout << setw(12) << (double) total.lengths[suit][length] / numLayouts;
+      }
+      cout << "\n";
+   }
+   cout << "East HCP" << setw(15) << "Fraction" << "\n";
+   for (int point = 0; point <= MAX_POINTS; point++) {
+      if (total.points[point] != 0) {
+         cout << setw(8) << point << setw(15) << (double) total.points[point] / numLayouts << "\n";
+      }
+   }
+   cout.flush();
+
+   cerr << "Visited " << numLayouts << " layouts on " << numThreads << " threads (" << fixed
+        << setprecision(0) << enumerator.getLayoutsPerSecond() << " layouts/sec)" << endl;
+   return 0;
+}
+
+/// \brief
+/// Counts exactly how many hands that can be dealt from the cards not known to lie elsewhere hold
+/// each number of high card points and suit length pattern and make each opening bid, optionally
+/// only among the hands making a given opening bid, reporting the time taken on standard error.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --exact.
+/// \return int - exit status of the program.
+int countExactly(int argc, char *argv[]) {
+   CardSet known = 0;
+   int bid = ANYBID;
+   for (int i = 2; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--known") == 0) {
+         CardSet hand;
+         if (!readDottedHand(argv[i + 1], hand)) {
+            cerr << "Error: Hands are written as spades.hearts.diamonds.clubs, such as AK2.QJ4.T987.654" << endl;
+            return 1;
+         }
+         if ((known & hand) != 0) {
+            cerr << "Error: A card is known to lie in two hands" << endl;
+            return 1;
+         }
+         known |= hand;
+      }
+      else if (strcmp(argv[i], "--opening") == 0) {
+         BidCode code;
+         if (!Hand::parseBidName(argv[i + 1], code)) {
+            cerr << "Error: Bids are written as pass or a level and strain, such as 1NT or 2S" << endl;
+            return 1;
+         }
+         bid = code;
+      }
+   }
+
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   HandDistribution distribution;
+   string error;
+   if (!distribution.compute(known, error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   vector<uint64_t> points;
+   distribution.countPoints(points, bid);
+   map<string, uint64_t> patterns;
+   distribution.countPatterns(patterns, bid);
+   vector<uint64_t> bids;
+   distribution.countBids(bids);
+   chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+   uint64_t numHands = distribution.getNumHands();
+   uint64_t numMatching = bid == ANYBID ? numHands : bids[bid];
+   cout << "Hands: " << numHands << "\n" << fixed << setprecision(6);
+   if (bid != ANYBID) {
+      cout << "Opening " << Hand::bidName(bid) << ": " << numMatching << " ("
+           << (double) numMatching / numHands << ")\n";
+      if (numMatching == 0) {
+         cout.flush();
+         return 0;
+      }
+   }
+
+   cout << "HCP" << setw(20) << "Hands" << setw(12) << "Fraction" << "\n";
+   for (int point = 0; point <= MAXHCP; point++) {
+      if (points[point] != 0) {
+         cout << setw(3) << point << setw(20) << points[point] << setw(12)
+              << (double) points[point] / numMatching << "\n";
+      }
+   }
+
+   // Patterns from the most to the least common
+   vector<pair<uint64_t, string>> sortedPatterns;
+   for (const auto& pattern : patterns) {
+      sortedPatterns.push_back(make_pair(pattern.second, pattern.first));
+   }
+   sort(sortedPatterns.rbegin(), sortedPatterns.rend());
+   cout << "Pattern" << setw(16) << "Hands" << setw(12) << "Fraction" << "\n";
+   for (const auto& pattern : sortedPatterns) {
+      cout << setw(7) << pattern.second << setw(16) << pattern.first << setw(12)
+           << (double) pattern.first / numMatching << "\n";
+   }
+
+   if (bid == ANYBID) {
+      cout << "Opening" << setw(16) << "Hands" << setw(12) << "Fraction" << "\n";
+      for (int code = 0; code < NUMBIDCODES; code++) {
+         if (bids[code] != 0) {
+            cout << setw(7) << Hand::bidName(code) << setw(16) << bids[code] << setw(12)
+                 << (double) bids[code] / numHands << "\n";
+         }
+      }
+   }
+   cout.flush();
+
+   cerr << "Counted " << numHands << " hands exactly in " << setprecision(3)
+        << elapsed.count() * 1000 << " ms" << endl;
+   return 0;
+}
+
+/// \brief
+/// Runs as a service answering deal and bid requests from clients of a Unix domain socket, or from
+/// standard input when the socket is given as "-", until a client asks it to shut down.
+///
+/// \param argc int - number of command line arguments.
+/// \param argv char*[] - command line arguments, starting with --serve SOCKET.
+/// \return int - exit status of the program.
+int serveRequests(int argc, char *argv[]) {
+   int numWorkers = thread::hardware_concurrency();
+
+   for (int i = 3; i + 1 < argc; i += 2) {
+      if (strcmp(argv[i], "--workers") == 0) {
+         numWorkers = atoi(argv[i + 1]);
+      }
+   }
+   if (numWorkers < 1) {
+      numWorkers = 1;
+   }
+
+   DealService service(numWorkers);
+   string error;
+   if (!service.open(argv[2], error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   cerr << "Serving on " << argv[2] << " with " << numWorkers << " workers" << endl;
+   service.run();
+   return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+   // Builds with BRIDGE_PROFILING defined report the time spent in each hot path on exit
+   Profiler::reportAtExit();
+
+   // A bidding system named first replaces the standard one for the whole run
+   BiddingSystem system;
+   if (argc >= 3 && strcmp(argv[1], "--system") == 0) {
+      string error;
+      if (!system.load(argv[2], error)) {
+         cerr << error << endl;
+         return 1;
+      }
+      BiddingSystem::setActive(system);
+      argv[2] = argv[0];
+      argv += 2;
+      argc -= 2;
+   }
+
+   if (argc >= 3 && strcmp(argv[1], "--generate") == 0) {
+      return generateDeals(argc, argv);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--ddtable") == 0) {
+      return solveDeals(argc, argv);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--classify") == 0) {
+      return classifyHands(argc, argv);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--evaluate") == 0) {
+      return evaluateHands(argc, argv);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--stats") == 0) {
+      return openingStatistics(argc, argv);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--playout") == 0) {
+      return playOutDeals(argc, argv);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--render") == 0) {
+      return renderDeals(argc, argv);
+   }
+   if (argc >= 4 && strcmp(argv[1], "--tobinary") == 0) {
+      return convertToBinary(argv[2], argv[3]);
+   }
+   if (argc >= 4 && strcmp(argv[1], "--totext") == 0) {
+      return convertToText(argv[2], argv[3]);
+   }
+   if (argc >= 4 && strcmp(argv[1], "--import") == 0) {
+      return importArchive(argc, argv);
+   }
+   if (argc >= 4 && strcmp(argv[1], "--index") == 0) {
+      return buildIndex(argv[2], argv[3]);
+   }
+   if (argc >= 4 && strcmp(argv[1], "--query") == 0) {
+      return queryIndex(argv[2], argv[3]);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--tonumbers") == 0) {
+      return numberDeals(argv[2]);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--fromnumber") == 0) {
+      return dealsFromNumber(argc, argv);
+   }
+   if (argc >= 3 && strcmp(argv[1], "--serve") == 0) {
+      return serveRequests(argc, argv);
+   }
+   if (argc >= 4 && strcmp(argv[1], "--layouts") == 0) {
+      return countLayouts(argc, argv);
+   }
+   if (argc >= 2 && strcmp(argv[1], "--exact") == 0) {
+      return countExactly(argc, argv);
+   }
+   if (argc >= 4 && strcmp(argv[1], "--filter") == 0) {
+      return filterDeals(argc, argv);
+   }
+
+   return playDeals(argc == 2 ? argv[1] : NULL);
+}
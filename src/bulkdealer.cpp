@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include "bulkdealer.h"
+#include "profiler.h"
+
+/// This class generates a large number of shuffled deals across several threads. Deals are produced in
+/// chunks by workers each owning their own deck, every deal shuffled from the random stream numbered
+/// by the deal, and the chunks are written out in deal order.
+///
+
+/// \brief
+/// Sets up a generator for the given number of deals.
+///
+/// \param numDeals long long - total number of deals to be generated.
+/// \param seed unsigned long long - seed from which every deal's random stream is derived.
+/// \param numThreads int - number of worker threads shuffling deals.
+BulkDealer::BulkDealer(long long numDeals, unsigned long long seed, int numThreads) :
+
+    // Two slots per worker lets each one fill its next chunk while the previous one is written
+    chunks(2 * numThreads) {
+    this->numDeals = numDeals;
+    this->seed = seed;
+    this->numThreads = numThreads;
+    this->numChunks = (numDeals + DEALSPERCHUNK - 1) / DEALSPERCHUNK;
+}
+
+/// \brief
+/// Generates every deal on the worker threads and writes them to the output stream in deal order.
+///
+/// \param out ostream& - output stream receiving the deals.
+void BulkDealer::run(ostream& out) {
+    vector<thread> workers;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(thread(&BulkDealer::worker, this, i));
+    }
+
+    // Write chunks in order as soon as each one has been filled
+    for (long long i = 0; i < numChunks; i++) {
+        Chunk& chunk = chunks[i % chunks.size()];
+        unique_lock<mutex> guard(chunk.lock);
+        chunk.changed.wait(guard, [&chunk] { return chunk.filled; });
+        out << chunk.text;
+        chunk.filled = false;
+        chunk.changed.notify_all();
+    }
+
+    for (int i = 0; i < numThreads; i++) {
+        workers[i].join();
+    }
+    out.flush();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    dealsPerSecond = numDeals / elapsed.count();
+}
+
+/// \brief
+/// Returns the throughput of the last run.
+///
+/// \return double - deals generated per second.
+double BulkDealer::getDealsPerSecond() {
+    return dealsPerSecond;
+}
+
+/// \brief
+/// Generates every chunk belonging to one worker thread, waiting for the writer to empty
+/// the chunk's slot before reusing it.
+///
+/// \param threadIndex int - index of the worker, which handles every chunk equal to it modulo the thread count.
+void BulkDealer::worker(int threadIndex) {
+    Deck deck;
+    string text;
+
+    for (long long i = threadIndex; i < numChunks; i += numThreads) {
+
+        // Format outside the lock so the writer is only held up by the swap
+        generateChunk(i, deck, text);
+
+        Chunk& chunk = chunks[i % chunks.size()];
+        unique_lock<mutex> guard(chunk.lock);
+        chunk.changed.wait(guard, [&chunk] { return !chunk.filled; });
+        chunk.text.swap(text);
+        chunk.filled = true;
+        chunk.changed.notify_all();
+    }
+}
+
+/// \brief
+/// Shuffles and formats all deals of one chunk.
+///
+/// \param chunkIndex long long - index of the chunk.
+/// \param deck Deck& - the worker's own deck.
+/// \param text string& - buffer receiving the formatted deals.
+void BulkDealer::generateChunk(long long chunkIndex, Deck& deck, string& text) {
+    ostringstream chunkOut;
+    long long firstDeal = chunkIndex * DEALSPERCHUNK;
+    long long lastDeal = min(firstDeal + DEALSPERCHUNK, numDeals);
+
+    // Each deal comes from its own stream so the output does not depend on the number of threads
+    for (long long i = firstDeal; i < lastDeal; i++) {
+        deck.shuffle(seed, i);
+        PROFILE_SCOPE(RENDERCOUNTER);
+        for (int j = 0; j < NUMCARDS; j++) {
+            if (j > 0) {
+                chunkOut << " ";
+            }
+            chunkOut << *deck.dealNextCard();
+        }
+        chunkOut << "\n";
+    }
+    text = chunkOut.str();
+}
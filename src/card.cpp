@@ -62,6 +62,11 @@ Card::Card(string cardString) {
         case 'S':
             this->cardSuit = SPADES;
             break;
+        default:
+
+            // Left past the last suit so that readers can reject the card
+            this->cardSuit = (Suit) (SPADES + 1);
+            break;
     }
 }
 
@@ -109,27 +114,9 @@ ostream& operator<<(ostream& out, Card& card) {
 ///
 /// \return string - returns card as two character string such as "TC".
 string Card::toString() {
-    string cardName = "";
-
-    if ((int)this->cardRank >= (int)TWO && (int)this->cardRank <= (int)NINE) {
-        cardName += (int)this->cardRank + '0';
-    }
-    else {
-        switch(this->cardRank) {
-            case TEN: cardName += "T"; break;
-            case JACK: cardName += "J"; break;
-            case QUEEN: cardName += "Q"; break;
-            case KING: cardName += "K"; break;
-            case ACE: cardName += "A"; break;
-        }
-    }
-
-    switch(this->cardSuit) {
-            case CLUBS: cardName += "C"; break;
-            case SPADES: cardName += "S"; break;
-            case DIAMONDS: cardName += "D"; break;
-            case HEARTS: cardName += "H"; break;
-    }
+    const char rankNames[] = "??23456789TJQKA";
+    const char suitNames[] = "CDHS";
+    char cardName[] = { rankNames[this->cardRank], suitNames[this->cardSuit], '\0' };
 
     return cardName;
 }
@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <cstring>
+#include "dealfile.h"
+#include "profiler.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// The four bytes starting every binary deal file.
+const char DEALFILEMAGIC[4] = { 'B', 'D', 'L', 'S' };
+
+/// Lookup table giving, for each byte of a packed deal, which of its four cards each position holds.
+struct UnpackTable {
+
+    // Bits 4p to 4p+3 are the cards of the byte held by position p
+    uint16_t holders[256];
+
+    constexpr UnpackTable() : holders() {
+        for (int value = 0; value < 256; value++) {
+            for (int card = 0; card < 4; card++) {
+                int position = (value >> (2 * card)) & 3;
+                holders[value] |= 1 << (4 * position + card);
+            }
+        }
+    }
+};
+
+static constexpr UnpackTable UNPACKTABLE;
+
+/// \brief
+/// Packs a deal into its binary form, card n of new deck order (clubs to spades, two to ace) taking
+/// bits 2n and 2n+1 with the position holding it.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param record uint8_t[] - receives the packed deal.
+void packDeal(const CardSet deal[NUMPOSITIONS], uint8_t record[DEALBYTES]) {
+    memset(record, 0, DEALBYTES);
+
+    // North's cards are zero so only the other three hands need setting
+    for (int position = EAST; position < NUMPOSITIONS; position++) {
+        CardSet cards = deal[position];
+        while (cards != 0) {
+            int bit = __builtin_ctzll(cards);
+            int card = (bit / SUITBITS) * NUMRANKS + bit % SUITBITS - TWO;
+            record[card / 4] |= position << (2 * (card % 4));
+            cards &= cards - 1;
+        }
+    }
+}
+
+/// \brief
+/// Unpacks a deal from its binary form.
+///
+/// \param record const uint8_t[] - the packed deal.
+/// \param deal CardSet[] - receives the cards held by each position.
+void unpackDeal(const uint8_t record[DEALBYTES], CardSet deal[NUMPOSITIONS]) {
+    uint64_t ordered[NUMPOSITIONS] = { 0 };
+
+    // Collect each position's cards in new deck order, four cards per byte
+    for (int i = 0; i < DEALBYTES; i++) {
+        uint64_t holders = UNPACKTABLE.holders[record[i]];
+        for (int position = 0; position < NUMPOSITIONS; position++) {
+            ordered[position] |= ((holders >> (4 * position)) & 0xF) << (4 * i);
+        }
+    }
+
+    // Then move each suit's thirteen cards up to its own mask
+    for (int position = 0; position < NUMPOSITIONS; position++) {
+        deal[position] = 0;
+        for (int suit = 0; suit < NUMSUITS; suit++) {
+            deal[position] |= ((ordered[position] >> (suit * NUMRANKS)) & (FULLSUIT >> TWO)) << (suit * SUITBITS + TWO);
+        }
+    }
+}
+
+/// \brief
+/// Reads a deal written as 52 cards in the format read by the game input stream.
+///
+/// \param in istream& - input stream holding the deal.
+/// \param dealer Position - the player dealing, whose left hand opponent receives the first card.
+/// \param deal CardSet[] - receives the cards held by each position.
+///
+/// \return bool - true if 52 different cards were read.
+bool readTextDeal(istream& in, Position dealer, CardSet deal[NUMPOSITIONS]) {
+    PROFILE_SCOPE(PARSECOUNTER);
+    string cardString;
+    CardSet seen = 0;
+
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        deal[i] = 0;
+    }
+    for (int i = 0; i < NUMCARDS; i++) {
+        if (!(in >> cardString) || cardString.size() != 2 || cardString[0] == '\0' || cardString[1] == '\0'
+            || strchr("23456789TJQKA", cardString[0]) == NULL || strchr("CDHS", cardString[1]) == NULL) {
+            return false;
+        }
+        Card card(cardString);
+        CardSet bit = cardBit(card.getRank(), card.getSuit());
+        if ((seen & bit) != 0) {
+            return false;
+        }
+        seen |= bit;
+        deal[(i + dealer + 1) % NUMPOSITIONS] |= bit;
+    }
+    return true;
+}
+
+/// \brief
+/// Writes a deal as one line of 52 cards in the format read by the game input stream, so that a game
+/// with the given dealer deals each card back to the hand it came from.
+///
+/// \param out ostream& - output stream receiving the deal.
+/// \param dealer Position - the player dealing, whose left hand opponent receives the first card.
+/// \param deal const CardSet[] - the cards held by each position.
+void writeTextDeal(ostream& out, Position dealer, const CardSet deal[NUMPOSITIONS]) {
+    PROFILE_SCOPE(RENDERCOUNTER);
+    CardSet remaining[NUMPOSITIONS];
+    copy(deal, deal + NUMPOSITIONS, remaining);
+
+    // The game deals the first card to the player on the dealer's left
+    for (int i = 0; i < NUMCARDS; i++) {
+        CardSet& hand = remaining[(i + dealer + 1) % NUMPOSITIONS];
+        int bit = __builtin_ctzll(hand);
+        hand &= hand - 1;
+        Card card((Rank) (bit % SUITBITS), (Suit) (bit / SUITBITS));
+        out << (i > 0 ? " " : "") << card;
+    }
+    out << "\n";
+}
+
+/// \brief
+/// Reads a hand written as its spade, heart, diamond and club ranks separated by dots, such as
+/// "AK32.QJ4.T9.8765", a void being left empty or written as a dash.
+///
+/// \param text const string& - the hand.
+/// \param hand CardSet& - receives the cards of the hand.
+///
+/// \return bool - true if the text is four suits of different ranks.
+bool readDottedHand(const string& text, CardSet& hand) {
+    PROFILE_SCOPE(PARSECOUNTER);
+    const char* rankChars = "23456789TJQKA";
+    int suit = SPADES;
+
+    hand = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '.') {
+            if (--suit < CLUBS) {
+                return false;
+            }
+            continue;
+        }
+        if (text[i] == '-') {
+            continue;
+        }
+        const char* rank = strchr(rankChars, text[i]);
+        if (rank == NULL || text[i] == '\0') {
+            return false;
+        }
+        CardSet bit = cardBit((Rank) (TWO + (rank - rankChars)), (Suit) suit);
+        if ((hand & bit) != 0) {
+            return false;
+        }
+        hand |= bit;
+    }
+    return suit == CLUBS;
+}
+
+/// \brief
+/// Maps the whole of a file into memory for reading.
+///
+/// \param fileName const string& - name of the file.
+/// \param bytes size_t& - receives the size of the file.
+/// \param error string& - receives a description of the problem if the file cannot be mapped.
+///
+/// \return const uint8_t* - the first byte of the file, or NULL if it could not be mapped or is empty.
+const uint8_t* mapFile(const string& fileName, size_t& bytes, string& error) {
+    const uint8_t* mapped = NULL;
+    bytes = 0;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER fileSize;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize)) {
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        error = "Error: Could not open " + fileName;
+        return NULL;
+    }
+    bytes = fileSize.QuadPart;
+    if (bytes > 0) {
+
+        // The view keeps the mapping alive once both handles are closed
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            mapped = (const uint8_t*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(fileName.c_str(), O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) != 0) {
+        if (file >= 0) {
+            ::close(file);
+        }
+        error = "Error: Could not open " + fileName;
+        return NULL;
+    }
+    bytes = status.st_size;
+    if (bytes > 0) {
+        void* view = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, file, 0);
+        mapped = view == MAP_FAILED ? NULL : (const uint8_t*) view;
+    }
+    ::close(file);
+#endif
+
+    if (bytes == 0) {
+        error = "Error: " + fileName + " is empty";
+    }
+    else if (mapped == NULL) {
+        error = "Error: Could not map " + fileName + " into memory";
+        bytes = 0;
+    }
+    return mapped;
+}
+
+/// \brief
+/// Unmaps a file mapped by mapFile.
+///
+/// \param mapped const uint8_t* - the first byte of the file, or NULL if nothing is mapped.
+/// \param bytes size_t - size of the file.
+void unmapFile(const uint8_t* mapped, size_t bytes) {
+    if (mapped != NULL) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapped);
+#else
+        munmap((void*) mapped, bytes);
+#endif
+    }
+}
+
+/// \brief
+/// Creates a writer with no file open.
+DealWriter::DealWriter() :
+    buffer(WRITEBUFFERBYTES) {
+}
+
+/// \brief
+/// Closes the file if it is still open.
+DealWriter::~DealWriter() {
+    close();
+}
+
+/// \brief
+/// Creates a binary deal file, replacing any file of the same name.
+///
+/// \param fileName const string& - name of the file.
+/// \param firstBoard unsigned int - board number of the first deal.
+///
+/// \return bool - true if the file was created.
+bool DealWriter::open(const string& fileName, unsigned int firstBoard) {
+    close();
+    out.open(fileName.c_str(), ios::binary | ios::trunc);
+    if (out.fail()) {
+        return false;
+    }
+
+    memcpy(header.magic, DEALFILEMAGIC, sizeof(header.magic));
+    header.version = DEALFILEVERSION;
+    header.dealBytes = DEALBYTES;
+    header.firstBoard = firstBoard;
+    header.reserved = 0;
+    header.numDeals = 0;
+    boards.clear();
+    dealers.clear();
+
+    // The count is rewritten on closing
+    out.write((const char*) &header, sizeof(header));
+    buffered = 0;
+    return !out.fail();
+}
+
+/// \brief
+/// Adds a deal to the file, numbered on from the board of the deal before.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+void DealWriter::write(const CardSet deal[NUMPOSITIONS]) {
+    unsigned int board = boards.empty() ? header.firstBoard + header.numDeals : boards.back() + 1;
+    write(deal, board, (Position) ((board + NUMPOSITIONS - 1) % NUMPOSITIONS));
+}
+
+/// \brief
+/// Adds a deal to the file with its own board number and dealer.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param board unsigned int - board number of the deal.
+/// \param dealer Position - the player dealing.
+void DealWriter::write(const CardSet deal[NUMPOSITIONS], unsigned int board, Position dealer) {
+
+    // Until a deal leaves the run of boards from the first, the boards need not be kept
+    uint32_t nextBoard = header.firstBoard + header.numDeals;
+    bool numberedOn = board == nextBoard && dealer == (nextBoard + NUMPOSITIONS - 1) % NUMPOSITIONS;
+    if (boards.empty() && !numberedOn) {
+        for (uint32_t i = header.firstBoard; i < nextBoard; i++) {
+            boards.push_back(i);
+            dealers.push_back((i + NUMPOSITIONS - 1) % NUMPOSITIONS);
+        }
+    }
+    if (!boards.empty() || !numberedOn) {
+        boards.push_back(board);
+        dealers.push_back(dealer);
+    }
+
+    if (buffered + DEALBYTES > buffer.size()) {
+        flush();
+    }
+    packDeal(deal, &buffer[buffered]);
+    buffered += DEALBYTES;
+    header.numDeals++;
+}
+
+/// \brief
+/// Writes out any buffered deals and any boards kept, records the number of deals in the header and
+/// closes the file.
+///
+/// \return bool - true if everything was written.
+bool DealWriter::close() {
+    if (!out.is_open()) {
+        return true;
+    }
+    flush();
+    if (!boards.empty()) {
+        header.version = DEALFILEBOARDSVERSION;
+        out.write((const char*) boards.data(), boards.size() * sizeof(uint32_t));
+        out.write((const char*) dealers.data(), dealers.size());
+    }
+    out.seekp(0);
+    out.write((const char*) &header, sizeof(header));
+    bool written = !out.fail();
+    out.close();
+    return written;
+}
+
+/// \brief
+/// Writes the buffered deals to the file.
+void DealWriter::flush() {
+    out.write((const char*) buffer.data(), buffered);
+    buffered = 0;
+}
+
+/// \brief
+/// Creates a reader with no file open.
+DealReader::DealReader() {}
+
+/// \brief
+/// Unmaps the file if it is still open.
+DealReader::~DealReader() {
+    close();
+}
+
+/// \brief
+/// Maps a binary deal file into memory and checks its header.
+///
+/// \param fileName const string& - name of the file.
+/// \param error string& - receives a description of the problem if the file cannot be used.
+///
+/// \return bool - true if the file was opened.
+bool DealReader::open(const string& fileName, string& error) {
+    close();
+
+    mapped = mapFile(fileName, mappedBytes, error);
+    if (mapped == NULL) {
+        return false;
+    }
+    if (mappedBytes < sizeof(DealFileHeader)) {
+        error = "Error: " + fileName + " is not a deal file";
+        close();
+        return false;
+    }
+
+    DealFileHeader header;
+    memcpy(&header, mapped, sizeof(header));
+    size_t bytesPerDeal = DEALBYTES + (header.version == DEALFILEBOARDSVERSION ? sizeof(uint32_t) + 1 : 0);
+    if (memcmp(header.magic, DEALFILEMAGIC, sizeof(header.magic)) != 0 || header.dealBytes != DEALBYTES) {
+        error = "Error: " + fileName + " is not a deal file";
+    }
+    else if (header.version != DEALFILEVERSION && header.version != DEALFILEBOARDSVERSION) {
+        error = "Error: " + fileName + " has unsupported version " + to_string(header.version);
+    }
+    else if (header.numDeals > (mappedBytes - sizeof(header)) / bytesPerDeal) {
+        error = "Error: " + fileName + " is shorter than its header says";
+    }
+    else {
+        records = mapped + sizeof(header);
+        numDeals = header.numDeals;
+        firstBoard = header.firstBoard;
+        if (header.version == DEALFILEBOARDSVERSION) {
+            boards = records + numDeals * DEALBYTES;
+            dealers = boards + numDeals * sizeof(uint32_t);
+        }
+        return true;
+    }
+    close();
+    return false;
+}
+
+/// \brief
+/// Unmaps the file.
+void DealReader::close() {
+    unmapFile(mapped, mappedBytes);
+    mapped = NULL;
+    mappedBytes = 0;
+    records = NULL;
+    boards = NULL;
+    dealers = NULL;
+    numDeals = 0;
+}
+
+/// \brief
+/// Returns the number of deals in the file.
+///
+/// \return long long - count of deals.
+long long DealReader::getNumDeals() {
+    return numDeals;
+}
+
+/// \brief
+/// Unpacks one deal of the file.
+///
+/// \param index long long - position of the deal in the file, starting from zero.
+/// \param deal CardSet[] - receives the cards held by each position.
+void DealReader::getDeal(long long index, CardSet deal[NUMPOSITIONS]) {
+    unpackDeal(records + index * DEALBYTES, deal);
+}
+
+/// \brief
+/// Returns the board number of one deal of the file.
+///
+/// \param index long long - position of the deal in the file, starting from zero.
+///
+/// \return long long - the board number.
+long long DealReader::getBoard(long long index) {
+    if (boards != NULL) {
+        uint32_t board;
+        memcpy(&board, boards + index * sizeof(uint32_t), sizeof(board));
+        return board;
+    }
+    return firstBoard + index;
+}
+
+/// \brief
+/// Returns the dealer of one deal of the file, following the board number unless the file stores it.
+///
+/// \param index long long - position of the deal in the file, starting from zero.
+///
+/// \return Position - the player dealing.
+Position DealReader::getDealer(long long index) {
+    if (dealers != NULL) {
+        return (Position) (dealers[index] % NUMPOSITIONS);
+    }
+    return (Position) ((getBoard(index) + NUMPOSITIONS - 1) % NUMPOSITIONS);
+}
@@ -0,0 +1,630 @@
+#include <algorithm>
+#include <cctype>
+#include "dealfilter.h"
+#include "random.h"
+
+/// This class compiles a constraint expression into a filter over the four hands of a deal and
+/// deals random hands that satisfy it, dealing one hand at a time and rejecting a deal as soon as
+/// one of its constraints fails.
+///
+
+/// Relative cost of dealing a hand, in units of one suit length test.
+const double DEALCOST = 13;
+
+/// \brief
+/// Puts the bit index of every card of the deck into a pool to be dealt from.
+///
+/// \param pool uint8_t[] - receives the bit indexes.
+static void fillPool(uint8_t pool[NUMCARDS]) {
+    for (int i = 0; i < NUMCARDS; i++) {
+        pool[i] = (uint8_t) ((i / NUMRANKS) * SUITBITS + TWO + i % NUMRANKS);
+    }
+}
+
+/// \brief
+/// Deals a hand of thirteen cards from the pool, moving each card taken past the end of the
+/// remaining cards as a Fisher-Yates shuffle would.
+///
+/// \param randomizer Random& - the randomizer choosing the cards.
+/// \param pool uint8_t[] - bit indexes of the cards, the undealt ones first.
+/// \param remaining int& - number of undealt cards, reduced by the hand dealt.
+///
+/// \return CardSet - the hand dealt.
+static CardSet dealHand(Random& randomizer, uint8_t pool[NUMCARDS], int& remaining) {
+    CardSet hand = 0;
+    for (int i = 0; i < NUMRANKS; i++) {
+        int index = randomizer.randomInteger(0, remaining - 1);
+        hand |= (CardSet) 1 << pool[index];
+        pool[index] = pool[--remaining];
+    }
+    return hand;
+}
+
+/// \brief
+/// Creates a filter accepting every deal.
+DealFilter::DealFilter() {
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        seatOrder[i] = i;
+    }
+}
+
+/// \brief
+/// Compiles a constraint expression, replacing any expression compiled before.
+///
+/// \param expression const string& - the constraints the deals must satisfy.
+/// \param error string& - receives a description of the first error found.
+///
+/// \return bool - true if the expression was compiled, false if it is not valid.
+bool DealFilter::compile(const string& expression, string& error) {
+    nodes.clear();
+    shapes.clear();
+    terms.clear();
+    tokens.clear();
+    nextToken = 0;
+    handsDealt = 0;
+
+    // Split into words, brackets always standing alone
+    string word;
+    for (size_t i = 0; i <= expression.size(); i++) {
+        char c = i < expression.size() ? (char) tolower(expression[i]) : ' ';
+        if (isspace(c) || c == '(' || c == ')') {
+            if (!word.empty()) {
+                tokens.push_back(word);
+                word.clear();
+            }
+            if (c == '(' || c == ')') {
+                tokens.push_back(string(1, c));
+            }
+        }
+        else {
+            word += c;
+        }
+    }
+
+    int root = -1;
+    if (!tokens.empty()) {
+        root = parseOr();
+        if (root >= 0 && nextToken < tokens.size()) {
+            root = fail("expected and, or or the end of the expression");
+        }
+        if (root < 0) {
+            error = parseError;
+            nodes.clear();
+            shapes.clear();
+            return false;
+        }
+    }
+
+    buildTerms(root);
+    planStages();
+    return true;
+}
+
+/// \brief
+/// Deals one deal from the random stream numbered by the deal and checks it against the filter,
+/// so that deal k of a seed is always the same whatever deals were tried before it.
+///
+/// \param seed unsigned long long - seed of the run the deal belongs to.
+/// \param dealNumber unsigned long long - number of the deal within the run.
+/// \param deal CardSet[] - receives the cards held by each position if the deal is accepted.
+///
+/// \return bool - true if the deal satisfies every constraint.
+bool DealFilter::generate(unsigned long long seed, unsigned long long dealNumber, CardSet deal[NUMPOSITIONS]) {
+    Random randomizer(seed, dealNumber);
+    uint8_t pool[NUMCARDS];
+    int remaining = NUMCARDS;
+    CardSet dealt = 0;
+
+    fillPool(pool);
+    for (int stage = 0; stage < NUMPOSITIONS; stage++) {
+        int seat = seatOrder[stage];
+
+        // The last hand is whatever is left over
+        if (stage < NUMPOSITIONS - 1) {
+            deal[seat] = dealHand(randomizer, pool, remaining);
+            handsDealt++;
+        }
+        else {
+            deal[seat] = ALLCARDS & ~dealt;
+        }
+        dealt |= deal[seat];
+
+        const vector<int>& checks = stageTerms[stage];
+        for (size_t i = 0; i < checks.size(); i++) {
+            if (!evaluate(terms[checks[i]].node, deal)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// \brief
+/// Checks a complete deal against the filter.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+///
+/// \return bool - true if the deal satisfies every constraint.
+bool DealFilter::accepts(const CardSet deal[NUMPOSITIONS]) {
+    for (size_t i = 0; i < terms.size(); i++) {
+        if (!evaluate(terms[i].node, deal)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \brief
+/// Returns the number of hands dealt by generate since the filter was compiled.
+///
+/// \return long long - count of hands dealt, including those of rejected deals.
+long long DealFilter::getHandsDealt() {
+    return handsDealt;
+}
+
+/// \brief
+/// Parses terms joined by or.
+///
+/// \return int - index of the node built, or -1 on error.
+int DealFilter::parseOr() {
+    int first = parseAnd();
+    if (first < 0 || peek() != "or") {
+        return first;
+    }
+
+    Node node;
+    node.kind = OR;
+    node.children.push_back(first);
+    while (peek() == "or") {
+        nextToken++;
+        int child = parseAnd();
+        if (child < 0) {
+            return -1;
+        }
+        node.children.push_back(child);
+    }
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+/// \brief
+/// Parses terms joined by and.
+///
+/// \return int - index of the node built, or -1 on error.
+int DealFilter::parseAnd() {
+    int first = parseTerm();
+    if (first < 0 || peek() != "and") {
+        return first;
+    }
+
+    Node node;
+    node.kind = AND;
+    node.children.push_back(first);
+    while (peek() == "and") {
+        nextToken++;
+        int child = parseTerm();
+        if (child < 0) {
+            return -1;
+        }
+        node.children.push_back(child);
+    }
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+/// \brief
+/// Parses a negated term, a bracketed expression or a single predicate.
+///
+/// \return int - index of the node built, or -1 on error.
+int DealFilter::parseTerm() {
+    if (peek() == "not") {
+        nextToken++;
+        int child = parseTerm();
+        if (child < 0) {
+            return -1;
+        }
+        Node node;
+        node.kind = NOT;
+        node.children.push_back(child);
+        nodes.push_back(node);
+        return nodes.size() - 1;
+    }
+
+    if (peek() == "(") {
+        nextToken++;
+        int inner = parseOr();
+        if (inner < 0) {
+            return -1;
+        }
+        if (peek() != ")") {
+            return fail("expected )");
+        }
+        nextToken++;
+        return inner;
+    }
+
+    return parsePredicate();
+}
+
+/// \brief
+/// Parses a predicate on a seat or partnership.
+///
+/// \return int - index of the node built, or -1 on error.
+int DealFilter::parsePredicate() {
+    const char* seatNames[NUMPOSITIONS] = { "n", "e", "s", "w" };
+    const char* suitNames[NUMSUITS] = { "clubs", "diamonds", "hearts", "spades" };
+    Node node;
+    string seat = peek();
+
+    if (seat == "ns") {
+        node.seats = (1 << NORTH) | (1 << SOUTH);
+    }
+    else if (seat == "ew") {
+        node.seats = (1 << EAST) | (1 << WEST);
+    }
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        if (seat == seatNames[i]) {
+            node.seats = 1 << i;
+        }
+    }
+    if (node.seats == 0) {
+        return fail("expected a seat (N, E, S, W, NS or EW)");
+    }
+    nextToken++;
+
+    string feature = peek();
+    nextToken++;
+    bool singleSeat = __builtin_popcount(node.seats) == 1;
+
+    if (feature == "hcp") {
+        node.kind = HCP;
+        if (!parseRange(node)) {
+            return -1;
+        }
+    }
+    else if (feature == "balanced" || feature == "shape") {
+        if (!singleSeat) {
+            nextToken--;
+            return fail("a shape applies to a single seat");
+        }
+        node.kind = SHAPE;
+        node.shape = shapes.size();
+        shapes.push_back(bitset<NUMSHAPECODES>());
+
+        // Balanced hands are those the bidding treats as balanced
+        if (feature == "balanced") {
+            addShape("4333", true, shapes.back());
+            addShape("4432", true, shapes.back());
+        }
+        else {
+            do {
+                if (peek() == "+") {
+                    nextToken++;
+                }
+                bool anyOrder = peek() == "any";
+                if (anyOrder) {
+                    nextToken++;
+                }
+                if (!addShape(peek(), anyOrder, shapes.back())) {
+                    return fail("expected a shape such as 5xxx or any 4432");
+                }
+                nextToken++;
+            } while (peek() == "+");
+        }
+    }
+    else {
+        node.kind = LENGTH;
+        node.suit = -1;
+        for (int i = 0; i < NUMSUITS; i++) {
+            if (feature == suitNames[i]) {
+                node.suit = i;
+            }
+        }
+        if (node.suit < 0) {
+            nextToken--;
+            return fail("expected hcp, balanced, shape or a suit name");
+        }
+        if (!parseRange(node)) {
+            return -1;
+        }
+    }
+
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+/// \brief
+/// Parses a range of values such as 15-17, 5+, 12- or 7.
+///
+/// \param node Node& - receives the lowest and highest values allowed.
+///
+/// \return bool - true if a range was read.
+bool DealFilter::parseRange(Node& node) {
+    string range = peek();
+    size_t digits = 0;
+    while (digits < range.size() && isdigit(range[digits])) {
+        digits++;
+    }
+    if (digits == 0 || digits > 2) {
+        fail("expected a range such as 15-17, 5+, 12- or 7");
+        return false;
+    }
+
+    node.low = stoi(range.substr(0, digits));
+    node.high = node.low;
+    string rest = range.substr(digits);
+    if (rest == "+") {
+        node.high = NUMCARDS;
+    }
+    else if (rest == "-") {
+        node.high = node.low;
+        node.low = 0;
+    }
+    else if (rest.size() > 1 && rest[0] == '-' && rest.size() <= 3
+             && all_of(rest.begin() + 1, rest.end(), ::isdigit)) {
+        node.high = stoi(rest.substr(1));
+    }
+    else if (!rest.empty()) {
+        fail("expected a range such as 15-17, 5+, 12- or 7");
+        return false;
+    }
+    nextToken++;
+    return true;
+}
+
+/// \brief
+/// Adds a shape pattern such as 5xxx or any 4432 to a set of allowed shapes.
+///
+/// \param pattern const string& - four lengths in spade, heart, diamond, club order, x matching any.
+/// \param anyOrder bool - whether the lengths may be held in any of the suits.
+/// \param allowed bitset& - the shape codes to add to.
+///
+/// \return bool - true if the pattern was valid.
+bool DealFilter::addShape(const string& pattern, bool anyOrder, bitset<NUMSHAPECODES>& allowed) {
+    if (pattern.size() != NUMSUITS) {
+        return false;
+    }
+    for (int i = 0; i < NUMSUITS; i++) {
+        if (!isdigit(pattern[i]) && pattern[i] != 'x') {
+            return false;
+        }
+    }
+
+    // Try every shape a hand can have against the pattern or its rearrangements
+    for (int spades = 0; spades <= NUMRANKS; spades++) {
+        for (int hearts = 0; spades + hearts <= NUMRANKS; hearts++) {
+            for (int diamonds = 0; spades + hearts + diamonds <= NUMRANKS; diamonds++) {
+                int lengths[NUMSUITS] = { spades, hearts, diamonds, NUMRANKS - spades - hearts - diamonds };
+                string order = pattern;
+                sort(order.begin(), order.end());
+                bool matched = false;
+                do {
+                    bool matches = true;
+                    for (int i = 0; i < NUMSUITS; i++) {
+                        const string& used = anyOrder ? order : pattern;
+                        if (used[i] != 'x' && used[i] - '0' != lengths[i]) {
+                            matches = false;
+                        }
+                    }
+                    matched = matched || matches;
+                } while (anyOrder && !matched && next_permutation(order.begin(), order.end()));
+
+                if (matched) {
+                    allowed.set((spades * 14 + hearts) * 14 + diamonds);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/// \brief
+/// Returns the next token without consuming it.
+///
+/// \return string - the token, or an empty string at the end of the expression.
+string DealFilter::peek() {
+    return nextToken < tokens.size() ? tokens[nextToken] : "";
+}
+
+/// \brief
+/// Records a parse error at the current token.
+///
+/// \param message const string& - description of what was expected.
+///
+/// \return int - always -1 so that parse functions can return the result directly.
+int DealFilter::fail(const string& message) {
+    if (nextToken < tokens.size()) {
+        parseError = "Error: " + message + " at '" + tokens[nextToken] + "'";
+    }
+    else {
+        parseError = "Error: " + message + " at the end of the expression";
+    }
+    return -1;
+}
+
+/// \brief
+/// Splits the top level and of the expression into separately checked terms and estimates the cost
+/// and pass rate of each.
+///
+/// \param root int - index of the root node.
+void DealFilter::buildTerms(int root) {
+    if (root < 0) {
+        return;
+    }
+    vector<int> roots;
+    if (nodes[root].kind == AND) {
+        roots = nodes[root].children;
+    }
+    else {
+        roots.push_back(root);
+    }
+
+    for (size_t i = 0; i < roots.size(); i++) {
+        Term term;
+        term.node = roots[i];
+        term.seats = nodeSeats(roots[i]);
+        term.cost = nodeCost(roots[i]);
+        term.passRate = 0;
+        terms.push_back(term);
+    }
+
+    // Count how often each term passes on a fixed sample so the plan is the same on every run
+    CardSet deal[NUMPOSITIONS];
+    for (int i = 0; i < CALIBRATIONDEALS; i++) {
+        Random randomizer(0, i);
+        uint8_t pool[NUMCARDS];
+        int remaining = NUMCARDS;
+        fillPool(pool);
+        deal[NORTH] = dealHand(randomizer, pool, remaining);
+        deal[EAST] = dealHand(randomizer, pool, remaining);
+        deal[SOUTH] = dealHand(randomizer, pool, remaining);
+        deal[WEST] = ALLCARDS & ~(deal[NORTH] | deal[EAST] | deal[SOUTH]);
+
+        for (size_t j = 0; j < terms.size(); j++) {
+            if (evaluate(terms[j].node, deal)) {
+                terms[j].passRate += 1.0 / CALIBRATIONDEALS;
+            }
+        }
+    }
+}
+
+/// \brief
+/// Chooses the seat order and the terms checked after each seat is dealt.
+void DealFilter::planStages() {
+    int order[NUMPOSITIONS] = { NORTH, EAST, SOUTH, WEST };
+    double bestCost = -1;
+
+    // Terms are checked cheapest first relative to the share of deals they reject
+    vector<int> ranked;
+    for (size_t i = 0; i < terms.size(); i++) {
+        ranked.push_back(i);
+    }
+    sort(ranked.begin(), ranked.end(), [this](int a, int b) {
+        return terms[a].cost / max(1 - terms[a].passRate, 1e-6) < terms[b].cost / max(1 - terms[b].passRate, 1e-6);
+    });
+
+    // Find the seat order with the least expected work, treating the terms as independent
+    do {
+        double cost = 0;
+        double surviving = 1;
+        int dealt = 0;
+        for (int stage = 0; stage < NUMPOSITIONS; stage++) {
+            int previous = dealt;
+            dealt |= 1 << order[stage];
+            if (stage < NUMPOSITIONS - 1) {
+                cost += surviving * DEALCOST;
+            }
+            for (size_t i = 0; i < ranked.size(); i++) {
+                const Term& term = terms[ranked[i]];
+                if ((term.seats & ~dealt) == 0 && (term.seats & ~previous) != 0) {
+                    cost += surviving * term.cost;
+                    surviving *= term.passRate;
+                }
+            }
+        }
+        if (bestCost < 0 || cost < bestCost) {
+            bestCost = cost;
+            copy(order, order + NUMPOSITIONS, seatOrder);
+        }
+    } while (next_permutation(order, order + NUMPOSITIONS));
+
+    int dealt = 0;
+    for (int stage = 0; stage < NUMPOSITIONS; stage++) {
+        int previous = dealt;
+        dealt |= 1 << seatOrder[stage];
+        stageTerms[stage].clear();
+        for (size_t i = 0; i < ranked.size(); i++) {
+            int seats = terms[ranked[i]].seats;
+            if ((seats & ~dealt) == 0 && (seats & ~previous) != 0) {
+                stageTerms[stage].push_back(ranked[i]);
+            }
+        }
+    }
+}
+
+/// \brief
+/// Estimates the work done checking a node.
+///
+/// \param node int - index of the node.
+///
+/// \return double - cost in units of one suit length test.
+double DealFilter::nodeCost(int node) {
+    const Node& current = nodes[node];
+    double cost = __builtin_popcount(current.seats) - 1;
+
+    switch (current.kind) {
+        case HCP:
+            return cost + 4;
+        case LENGTH:
+            return cost + 1;
+        case SHAPE:
+            return cost + 3;
+        default:
+            for (size_t i = 0; i < current.children.size(); i++) {
+                cost += nodeCost(current.children[i]);
+            }
+            return cost;
+    }
+}
+
+/// \brief
+/// Finds the seats whose cards a node reads.
+///
+/// \param node int - index of the node.
+///
+/// \return int - a bit mask of positions.
+int DealFilter::nodeSeats(int node) {
+    int seats = nodes[node].seats;
+    for (size_t i = 0; i < nodes[node].children.size(); i++) {
+        seats |= nodeSeats(nodes[node].children[i]);
+    }
+    return seats;
+}
+
+/// \brief
+/// Checks a node against the hands dealt.
+///
+/// \param node int - index of the node.
+/// \param deal const CardSet[] - the cards held by each position, at least those the node reads.
+///
+/// \return bool - true if the node is satisfied.
+bool DealFilter::evaluate(int node, const CardSet deal[NUMPOSITIONS]) {
+    const Node& current = nodes[node];
+    CardSet cards = 0;
+    int value;
+
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        if ((current.seats >> i) & 1) {
+            cards |= deal[i];
+        }
+    }
+
+    switch (current.kind) {
+        case AND:
+            for (size_t i = 0; i < current.children.size(); i++) {
+                if (!evaluate(current.children[i], deal)) {
+                    return false;
+                }
+            }
+            return true;
+        case OR:
+            for (size_t i = 0; i < current.children.size(); i++) {
+                if (evaluate(current.children[i], deal)) {
+                    return true;
+                }
+            }
+            return false;
+        case NOT:
+            return !evaluate(current.children[0], deal);
+        case HCP:
+            value = highCardPoints(cards);
+            break;
+        case LENGTH:
+            value = suitLength(cards, (Suit) current.suit);
+            break;
+        default:
+            return shapes[current.shape].test((suitLength(cards, SPADES) * 14 + suitLength(cards, HEARTS)) * 14
+                                              + suitLength(cards, DIAMONDS));
+    }
+    return value >= current.low && value <= current.high;
+}
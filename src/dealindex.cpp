@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "biddingsystem.h"
+#include "dealindex.h"
+#include "handbatch.h"
+
+/// This class answers queries on the seat features of the deals of a binary deal file from an index
+/// of one byte column per feature and seat, with bitmaps for the balanced flags and opening bids,
+/// built once from the deal file and mapped into memory when opened.
+///
+
+const char DEALINDEXMAGIC[4] = { 'B', 'D', 'I', 'X' };
+
+// The byte columns: high card points, suit lengths and opening bids of each seat, then the deal's
+// opening bid and opener
+const int HCPCOLUMN = 0;
+const int LENGTHCOLUMN = HCPCOLUMN + NUMPOSITIONS;
+const int BIDCOLUMN = LENGTHCOLUMN + NUMPOSITIONS * NUMSUITS;
+const int OPENINGCOLUMN = BIDCOLUMN + NUMPOSITIONS;
+const int OPENERCOLUMN = OPENINGCOLUMN + 1;
+const int NUMCOLUMNS = OPENERCOLUMN + 1;
+
+// The bitmaps: the balanced flag of each seat, then one for each opening bid of the deal
+const int BALANCEDBITMAP = 0;
+const int OPENINGBITMAP = BALANCEDBITMAP + NUMPOSITIONS;
+const int NUMBITMAPS = OPENINGBITMAP + NUMBIDCODES;
+
+/// \brief
+/// Rounds a size up to a multiple of INDEXALIGNBYTES.
+///
+/// \param bytes size_t - the size.
+///
+/// \return size_t - the size rounded up.
+static inline size_t alignBytes(size_t bytes) {
+    return (bytes + INDEXALIGNBYTES - 1) / INDEXALIGNBYTES * INDEXALIGNBYTES;
+}
+
+/// \brief
+/// Reads a range of values such as 15-17, 5+, 12- or 7.
+///
+/// \param range const string& - the range.
+/// \param low int& - receives the lowest value allowed.
+/// \param high int& - receives the highest value allowed.
+///
+/// \return bool - true if a range was read.
+static bool parseRange(const string& range, int& low, int& high) {
+    size_t digits = 0;
+    while (digits < range.size() && isdigit(range[digits])) {
+        digits++;
+    }
+    if (digits == 0 || digits > 2) {
+        return false;
+    }
+
+    low = stoi(range.substr(0, digits));
+    high = low;
+    string rest = range.substr(digits);
+    if (rest == "+") {
+        high = UINT8_MAX;
+    }
+    else if (rest == "-") {
+        high = low;
+        low = 0;
+    }
+    else if (rest.size() > 1 && rest[0] == '-' && rest.size() <= 3
+             && all_of(rest.begin() + 1, rest.end(), ::isdigit)) {
+        high = stoi(rest.substr(1));
+    }
+    else if (!rest.empty()) {
+        return false;
+    }
+    return true;
+}
+
+/// \brief
+/// Creates an index with no file open.
+DealIndex::DealIndex() {}
+
+/// \brief
+/// Unmaps the index if it is still open.
+DealIndex::~DealIndex() {
+    close();
+}
+
+/// \brief
+/// Evaluates every deal of a binary deal file, dealt by its dealer, and writes the index.
+///
+/// \param dealFile const string& - name of the binary deal file.
+/// \param indexFile const string& - name of the index file to write.
+/// \param error string& - receives a description of the problem if the index cannot be built.
+///
+/// \return bool - true if the index was written.
+bool DealIndex::build(const string& dealFile, const string& indexFile, string& error) {
+    DealReader reader;
+    if (!reader.open(dealFile, error)) {
+        return false;
+    }
+    uint64_t numDeals = reader.getNumDeals();
+    vector<size_t> columnOffsets;
+    vector<size_t> bitmapOffsets;
+    layout(numDeals, columnOffsets, bitmapOffsets);
+    size_t columnBytes = alignBytes(numDeals);
+    size_t bitmapWords = alignBytes((numDeals + 63) / 64 * sizeof(uint64_t)) / sizeof(uint64_t);
+
+    ofstream out(indexFile, ios::binary | ios::trunc);
+    if (out.fail()) {
+        error = "Error: Could not create " + indexFile;
+        return false;
+    }
+
+    // The header is written last, once the counts are known
+    DealIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DEALINDEXMAGIC, sizeof(header.magic));
+    header.version = DEALINDEXVERSION;
+    header.firstBoard = numDeals > 0 ? reader.getBoard(0) : 1;
+    header.numDeals = numDeals;
+    header.systemHash = BiddingSystem::active().getHash();
+    vector<char> zeros(alignBytes(sizeof(header)), 0);
+    out.write(zeros.data(), zeros.size());
+
+    // Each block's slice of every column is written in place, the last padded to the column's end
+    HandBatch evaluator;
+    vector<CardSet> hands(INDEXBLOCKDEALS * NUMPOSITIONS);
+    vector<HandFeatures> features(INDEXBLOCKDEALS * NUMPOSITIONS);
+    size_t columnStride = INDEXBLOCKDEALS + INDEXALIGNBYTES;
+    size_t bitmapStride = (INDEXBLOCKDEALS + INDEXALIGNBYTES * 8) / 64;
+    vector<uint8_t> columnBlock(NUMCOLUMNS * columnStride);
+    vector<uint64_t> bitmapBlock(NUMBITMAPS * bitmapStride);
+
+    for (uint64_t start = 0; start < numDeals; start += INDEXBLOCKDEALS) {
+        int count = (int) min((uint64_t) INDEXBLOCKDEALS, numDeals - start);
+        bool last = start + count == numDeals;
+        for (int i = 0; i < count; i++) {
+            reader.getDeal(start + i, &hands[i * NUMPOSITIONS]);
+        }
+        evaluator.evaluate(hands.data(), count * NUMPOSITIONS, features.data());
+        fill(columnBlock.begin(), columnBlock.end(), 0);
+        fill(bitmapBlock.begin(), bitmapBlock.end(), 0);
+
+        for (int i = 0; i < count; i++) {
+            uint64_t bit = 1ULL << (i % 64);
+            BidCode bids[NUMPOSITIONS];
+            for (int seat = 0; seat < NUMPOSITIONS; seat++) {
+                const HandFeatures& hand = features[i * NUMPOSITIONS + seat];
+                bids[seat] = HandBatch::openingBid(hand);
+                columnBlock[(HCPCOLUMN + seat) * columnStride + i] = hand.highCardPoints;
+                columnBlock[(BIDCOLUMN + seat) * columnStride + i] = bids[seat];
+                header.hcpCounts[seat][hand.highCardPoints]++;
+                header.bidCounts[seat][bids[seat]]++;
+                for (int suit = 0; suit < NUMSUITS; suit++) {
+                    columnBlock[(LENGTHCOLUMN + seat * NUMSUITS + suit) * columnStride + i] = hand.lengths[suit];
+                    header.lengthCounts[seat][suit][hand.lengths[suit]]++;
+                }
+                if (hand.balanced) {
+                    bitmapBlock[(BALANCEDBITMAP + seat) * bitmapStride + i / 64] |= bit;
+                    header.balancedCounts[seat]++;
+                }
+            }
+
+            // The auction starts with the deal's dealer, and the dealer is kept as opener if all pass
+            Position dealer = reader.getDealer(start + i);
+            BidCode opening = PASSBID;
+            int opener = dealer;
+            for (int j = 0; j < NUMPOSITIONS; j++) {
+                int seat = (dealer + j) % NUMPOSITIONS;
+                if (bids[seat] != PASSBID) {
+                    opening = bids[seat];
+                    opener = seat;
+                    break;
+                }
+            }
+            columnBlock[OPENINGCOLUMN * columnStride + i] = opening;
+            columnBlock[OPENERCOLUMN * columnStride + i] = opener;
+            bitmapBlock[(OPENINGBITMAP + opening) * bitmapStride + i / 64] |= bit;
+            header.openingCounts[opener][opening]++;
+        }
+
+        for (int column = 0; column < NUMCOLUMNS; column++) {
+            out.seekp(columnOffsets[column] + start);
+            out.write((const char*) &columnBlock[column * columnStride], last ? columnBytes - start : count);
+        }
+        for (int bitmap = 0; bitmap < NUMBITMAPS; bitmap++) {
+            size_t words = last ? bitmapWords - start / 64 : count / 64;
+            out.seekp(bitmapOffsets[bitmap] + start / 8);
+            out.write((const char*) &bitmapBlock[bitmap * bitmapStride], words * sizeof(uint64_t));
+        }
+    }
+
+    out.seekp(0);
+    out.write((const char*) &header, sizeof(header));
+    out.close();
+    if (out.fail()) {
+        error = "Error: Could not write " + indexFile;
+        return false;
+    }
+    return true;
+}
+
+/// \brief
+/// Maps an index file into memory and checks its header, including that its bids were made by
+/// the active bidding system.
+///
+/// \param indexFile const string& - name of the index file.
+/// \param error string& - receives a description of the problem if the index cannot be used.
+///
+/// \return bool - true if the index was opened.
+bool DealIndex::open(const string& indexFile, string& error) {
+    close();
+
+    mapped = mapFile(indexFile, mappedBytes, error);
+    if (mapped == NULL) {
+        return false;
+    }
+    header = (const DealIndexHeader*) mapped;
+
+    vector<size_t> columnOffsets;
+    vector<size_t> bitmapOffsets;
+    if (mappedBytes < sizeof(DealIndexHeader) || memcmp(header->magic, DEALINDEXMAGIC, sizeof(header->magic)) != 0) {
+        error = "Error: " + indexFile + " is not a deal index";
+    }
+    else if (header->version != DEALINDEXVERSION) {
+        error = "Error: " + indexFile + " has unsupported version " + to_string(header->version);
+    }
+    else if (layout(header->numDeals, columnOffsets, bitmapOffsets) > mappedBytes) {
+        error = "Error: " + indexFile + " is shorter than its header says";
+    }
+    else if (header->systemHash != BiddingSystem::active().getHash()) {
+        error = "Error: " + indexFile + " was built with another bidding system; build it again with --index";
+    }
+    else {
+        for (int i = 0; i < NUMCOLUMNS; i++) {
+            columns.push_back(mapped + columnOffsets[i]);
+        }
+        for (int i = 0; i < NUMBITMAPS; i++) {
+            bitmaps.push_back((const uint64_t*) (mapped + bitmapOffsets[i]));
+        }
+        return true;
+    }
+    close();
+    return false;
+}
+
+/// \brief
+/// Unmaps the index.
+void DealIndex::close() {
+    unmapFile(mapped, mappedBytes);
+    mapped = NULL;
+    mappedBytes = 0;
+    header = NULL;
+    columns.clear();
+    bitmaps.clear();
+}
+
+/// \brief
+/// Returns the number of deals indexed.
+///
+/// \return long long - count of deals.
+long long DealIndex::getNumDeals() {
+    return header == NULL ? 0 : header->numDeals;
+}
+
+/// \brief
+/// Finds the deals satisfying every predicate of a query.
+///
+/// \param query const string& - predicates joined by and.
+/// \param matches vector<long long>& - receives the positions in the deal file of the deals found, in order.
+/// \param error string& - receives a description of the first error found in the query.
+///
+/// \return bool - true if the query was valid.
+bool DealIndex::find(const string& query, vector<long long>& matches, string& error) {
+    vector<Predicate> predicates;
+    matches.clear();
+    if (header == NULL) {
+        error = "Error: No index is open";
+        return false;
+    }
+    if (!parse(query, predicates, error)) {
+        return false;
+    }
+
+    // The predicate passing fewest deals goes first, so later ones read few blocks of their columns
+    stable_sort(predicates.begin(), predicates.end(),
+                [](const Predicate& a, const Predicate& b) { return a.estimate < b.estimate; });
+
+    uint64_t numDeals = header->numDeals;
+    vector<uint64_t> passing((numDeals + 63) / 64, ~0ULL);
+    if (numDeals % 64 != 0) {
+        passing.back() = (1ULL << (numDeals % 64)) - 1;
+    }
+    for (size_t i = 0; i < predicates.size(); i++) {
+        for (size_t word = 0; word < passing.size(); word++) {
+            if (passing[word] != 0) {
+                passing[word] = match(predicates[i], word, passing[word]);
+            }
+        }
+    }
+
+    for (size_t word = 0; word < passing.size(); word++) {
+        for (uint64_t bits = passing[word]; bits != 0; bits &= bits - 1) {
+            matches.push_back(word * 64 + __builtin_ctzll(bits));
+        }
+    }
+    return true;
+}
+
+/// \brief
+/// Works out where each column and bitmap of an index of the given size starts.
+///
+/// \param numDeals uint64_t - number of deals indexed.
+/// \param columnOffsets vector<size_t>& - receives the offset of each column.
+/// \param bitmapOffsets vector<size_t>& - receives the offset of each bitmap.
+///
+/// \return size_t - size of the whole file.
+size_t DealIndex::layout(uint64_t numDeals, vector<size_t>& columnOffsets, vector<size_t>& bitmapOffsets) {
+    size_t columnBytes = alignBytes(numDeals);
+    size_t bitmapBytes = alignBytes((numDeals + 63) / 64 * sizeof(uint64_t));
+    size_t offset = alignBytes(sizeof(DealIndexHeader));
+
+    columnOffsets.resize(NUMCOLUMNS);
+    for (int i = 0; i < NUMCOLUMNS; i++) {
+        columnOffsets[i] = offset;
+        offset += columnBytes;
+    }
+    bitmapOffsets.resize(NUMBITMAPS);
+    for (int i = 0; i < NUMBITMAPS; i++) {
+        bitmapOffsets[i] = offset;
+        offset += bitmapBytes;
+    }
+    return offset;
+}
+
+/// \brief
+/// Reads a query into predicates, working out how many deals each passes.
+///
+/// \param query const string& - predicates joined by and.
+/// \param predicates vector<Predicate>& - receives the predicates.
+/// \param error string& - receives a description of the first error found.
+///
+/// \return bool - true if the query was valid.
+bool DealIndex::parse(const string& query, vector<Predicate>& predicates, string& error) {
+    const char* seatNames[NUMPOSITIONS] = { "n", "e", "s", "w" };
+    const char* suitNames[NUMSUITS] = { "clubs", "diamonds", "hearts", "spades" };
+
+    vector<string> tokens;
+    istringstream words(query);
+    string word;
+    while (words >> word) {
+        transform(word.begin(), word.end(), word.begin(), ::tolower);
+        tokens.push_back(word);
+    }
+
+    size_t next = 0;
+    auto fail = [&](const string& message) {
+        error = "Error: " + message + (next < tokens.size() ? " at '" + tokens[next] + "'" : " at end of query");
+        return false;
+    };
+
+    while (true) {
+        int seat = -1;
+        for (int i = 0; i < NUMPOSITIONS && next < tokens.size(); i++) {
+            if (tokens[next] == seatNames[i]) {
+                seat = i;
+            }
+        }
+        if (seat >= 0) {
+            next++;
+        }
+        if (next == tokens.size()) {
+            return fail("expected a predicate");
+        }
+        string feature = tokens[next];
+        if (seat < 0 && feature != "opening") {
+            return fail("expected a seat (N, E, S or W)");
+        }
+        next++;
+
+        int suit = -1;
+        for (int i = 0; i < NUMSUITS; i++) {
+            if (feature == suitNames[i]) {
+                suit = i;
+            }
+        }
+
+        Predicate predicate;
+        if (feature == "hcp" || suit >= 0) {
+            if (next == tokens.size() || !parseRange(tokens[next], predicate.low, predicate.high)) {
+                return fail("expected a range such as 15-17, 5+, 12- or 7");
+            }
+            next++;
+            predicate.column = suit < 0 ? HCPCOLUMN + seat : LENGTHCOLUMN + seat * NUMSUITS + suit;
+            int highest = suit < 0 ? MAXHCP : NUMRANKS;
+            for (int value = predicate.low; value <= min(predicate.high, highest); value++) {
+                predicate.estimate += suit < 0 ? header->hcpCounts[seat][value] : header->lengthCounts[seat][suit][value];
+            }
+            predicates.push_back(predicate);
+        }
+        else if (feature == "balanced") {
+            predicate.bitmap = BALANCEDBITMAP + seat;
+            predicate.estimate = header->balancedCounts[seat];
+            predicates.push_back(predicate);
+        }
+        else if (feature == "bid" || feature == "opening") {
+            BidCode bid;
+            if (next == tokens.size() || !Hand::parseBidName(tokens[next], bid)) {
+                return fail("expected a bid such as 1S, 3NT or pass");
+            }
+            next++;
+            if (feature == "bid") {
+                predicate.column = BIDCOLUMN + seat;
+                predicate.low = predicate.high = bid;
+                predicate.estimate = header->bidCounts[seat][bid];
+                predicates.push_back(predicate);
+            }
+            else {
+                predicate.bitmap = OPENINGBITMAP + bid;
+                for (int opener = 0; opener < NUMPOSITIONS; opener++) {
+                    if (seat < 0 || seat == opener) {
+                        predicate.estimate += header->openingCounts[opener][bid];
+                    }
+                }
+                predicates.push_back(predicate);
+
+                // The bitmap is shared by every opener, so one seat's openings are also checked against the opener column
+                if (seat >= 0) {
+                    Predicate opener;
+                    opener.column = OPENERCOLUMN;
+                    opener.low = opener.high = seat;
+                    opener.estimate = predicate.estimate;
+                    predicates.push_back(opener);
+                }
+            }
+        }
+        else {
+            next--;
+            return fail("expected hcp, a suit name, balanced, bid or opening");
+        }
+
+        if (next == tokens.size()) {
+            return true;
+        }
+        if (tokens[next] != "and") {
+            return fail("expected and");
+        }
+        next++;
+    }
+}
+
+/// \brief
+/// Clears the bits of the deals in one block of 64 that fail a predicate.
+///
+/// \param predicate const Predicate& - the predicate.
+/// \param word size_t - the block, deals 64 * word onwards.
+/// \param bits uint64_t - the deals of the block still passing.
+///
+/// \return uint64_t - the deals of the block passing the predicate as well.
+uint64_t DealIndex::match(const Predicate& predicate, size_t word, uint64_t bits) {
+    if (predicate.bitmap >= 0) {
+        return bits & bitmaps[predicate.bitmap][word];
+    }
+    if (predicate.low > predicate.high) {
+        return 0;
+    }
+
+    // Unsigned wrap-around tests low <= value <= high in one comparison
+    const uint8_t* values = columns[predicate.column] + word * 64;
+    unsigned span = predicate.high - predicate.low;
+    uint64_t passing = 0;
+    if (__builtin_popcountll(bits) <= 8) {
+        for (; bits != 0; bits &= bits - 1) {
+            int i = __builtin_ctzll(bits);
+            passing |= (uint64_t) ((unsigned) (values[i] - predicate.low) <= span) << i;
+        }
+        return passing;
+    }
+    for (int i = 0; i < 64; i++) {
+        passing |= (uint64_t) ((unsigned) (values[i] - predicate.low) <= span) << i;
+    }
+    return bits & passing;
+}
@@ -0,0 +1,210 @@
+#include "dealnumber.h"
+
+constexpr BinomialTable BINOMIALS;
+
+const uint64_t RANKMASK = FULLSUIT >> TWO;
+
+/// \brief
+/// Moves a card set's cards into new deck order, card n of the deck (clubs to spades, two to ace) taking bit n.
+///
+/// \param cards CardSet - the set of cards.
+///
+/// \return uint64_t - the cards as the lowest 52 bits.
+static inline uint64_t deckOrder(CardSet cards) {
+    uint64_t ordered = 0;
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        ordered |= ((cards >> (suit * SUITBITS + TWO)) & RANKMASK) << (suit * NUMRANKS);
+    }
+    return ordered;
+}
+
+/// \brief
+/// Moves cards in new deck order back into a card set.
+///
+/// \param ordered uint64_t - the cards as the lowest 52 bits.
+///
+/// \return CardSet - the set of cards.
+static inline CardSet fromDeckOrder(uint64_t ordered) {
+    CardSet cards = 0;
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        cards |= ((ordered >> (suit * NUMRANKS)) & RANKMASK) << (suit * SUITBITS + TWO);
+    }
+    return cards;
+}
+
+/// \brief
+/// Numbers a hand of 13 among the cards still to be dealt by the combinatorial number system: the
+/// hand whose cards sit at places c1 < c2 < ... < c13 of the remaining cards has the number
+/// C(c1, 1) + C(c2, 2) + ... + C(c13, 13).
+///
+/// \param hand uint64_t - the hand's cards in new deck order.
+/// \param remaining uint64_t - the cards still to be dealt in new deck order, including the hand.
+///
+/// \return uint64_t - the number of the hand.
+static uint64_t rankHand(uint64_t hand, uint64_t remaining) {
+    uint64_t number = 0;
+    int k = 1;
+    for (; hand != 0; hand &= hand - 1) {
+        uint64_t below = (hand & -hand) - 1;
+        number += BINOMIALS.choose[__builtin_popcountll(remaining & below)][k++];
+    }
+    return number;
+}
+
+/// \brief
+/// Builds the hand of 13 with the given number among the cards still to be dealt.
+///
+/// \param number uint64_t - the number of the hand.
+/// \param remaining uint64_t - the cards still to be dealt in new deck order.
+///
+/// \return uint64_t - the hand's cards in new deck order.
+static uint64_t unrankHand(uint64_t number, uint64_t remaining) {
+    int cards[NUMCARDS];
+    int numRemaining = 0;
+    for (; remaining != 0; remaining &= remaining - 1) {
+        cards[numRemaining++] = __builtin_ctzll(remaining);
+    }
+
+    // Take the highest place first, the largest whose coefficient still fits in the number
+    uint64_t hand = 0;
+    int place = numRemaining;
+    for (int k = NUMRANKS; k >= 1; k--) {
+        do {
+            place--;
+        } while (BINOMIALS.choose[place][k] > number);
+        number -= BINOMIALS.choose[place][k];
+        hand |= (uint64_t) 1 << cards[place];
+    }
+    return hand;
+}
+
+/// \brief
+/// Numbers a deal. North's cards are numbered among the 52 cards, east's among the 39 left and south's
+/// among the 26 left after that, each set of 13 by the combinatorial number system, and the three
+/// numbers are combined so that every deal has a different number below NUMDEALNUMBERS.
+///
+/// \param deal const CardSet[] - the cards held by each position, 13 each.
+///
+/// \return DealNumber - the number of the deal.
+DealNumber rankDeal(const CardSet deal[NUMPOSITIONS]) {
+    uint64_t remaining = ((uint64_t) 1 << NUMCARDS) - 1;
+    uint64_t north = deckOrder(deal[NORTH]);
+    uint64_t east = deckOrder(deal[EAST]);
+    uint64_t south = deckOrder(deal[SOUTH]);
+
+    uint64_t northNumber = rankHand(north, remaining);
+    remaining &= ~north;
+    uint64_t eastNumber = rankHand(east, remaining);
+    remaining &= ~east;
+    uint64_t southNumber = rankHand(south, remaining);
+
+    return ((DealNumber) northNumber * EASTCHOICES + eastNumber) * SOUTHCHOICES + southNumber;
+}
+
+/// \brief
+/// Builds the deal with the given number.
+///
+/// \param number DealNumber - a number below NUMDEALNUMBERS.
+/// \param deal CardSet[] - receives the cards held by each position.
+void unrankDeal(DealNumber number, CardSet deal[NUMPOSITIONS]) {
+    uint64_t southNumber = (uint64_t) (number % SOUTHCHOICES);
+    number /= SOUTHCHOICES;
+    uint64_t eastNumber = (uint64_t) (number % EASTCHOICES);
+    uint64_t northNumber = (uint64_t) (number / EASTCHOICES);
+
+    uint64_t remaining = ((uint64_t) 1 << NUMCARDS) - 1;
+    uint64_t north = unrankHand(northNumber, remaining);
+    remaining &= ~north;
+    uint64_t east = unrankHand(eastNumber, remaining);
+    remaining &= ~east;
+    uint64_t south = unrankHand(southNumber, remaining);
+    remaining &= ~south;
+
+    deal[NORTH] = fromDeckOrder(north);
+    deal[EAST] = fromDeckOrder(east);
+    deal[SOUTH] = fromDeckOrder(south);
+    deal[WEST] = fromDeckOrder(remaining);
+}
+
+/// \brief
+/// Draws a deal number uniformly, so that unranking it gives every deal with equal chance.
+///
+/// \param randomizer Random& - source of the random bits.
+///
+/// \return DealNumber - a number below NUMDEALNUMBERS.
+DealNumber randomDealNumber(Random& randomizer) {
+
+    // Two draws in three fall below the count of deals, the rest are thrown away
+    DealNumber number;
+    do {
+        number = (DealNumber) randomizer.next() | (DealNumber) (randomizer.next() >> 32) << 64;
+    } while (number >= NUMDEALNUMBERS);
+    return number;
+}
+
+/// \brief
+/// Writes a deal number in decimal.
+///
+/// \param number DealNumber - the number.
+///
+/// \return string - the decimal digits.
+string dealNumberToString(DealNumber number) {
+    char digits[40];
+    int next = sizeof(digits);
+    do {
+        digits[--next] = '0' + (int) (number % 10);
+        number /= 10;
+    } while (number != 0);
+    return string(digits + next, sizeof(digits) - next);
+}
+
+/// \brief
+/// Reads a deal number written in decimal.
+///
+/// \param text const string& - the decimal digits.
+/// \param number DealNumber& - receives the number.
+///
+/// \return bool - true if the text is a number below NUMDEALNUMBERS.
+bool parseDealNumber(const string& text, DealNumber& number) {
+    number = 0;
+    if (text.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+
+        // Stopping as soon as the count is reached keeps the value well inside 128 bits
+        number = number * 10 + (text[i] - '0');
+        if (number >= NUMDEALNUMBERS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \brief
+/// Stores a deal number in DEALNUMBERBYTES bytes, lowest byte first.
+///
+/// \param number DealNumber - the number.
+/// \param bytes uint8_t[] - receives the stored number.
+void storeDealNumber(DealNumber number, uint8_t bytes[DEALNUMBERBYTES]) {
+    for (int i = 0; i < DEALNUMBERBYTES; i++) {
+        bytes[i] = (uint8_t) (number >> (8 * i));
+    }
+}
+
+/// \brief
+/// Loads a deal number stored by storeDealNumber.
+///
+/// \param bytes const uint8_t[] - the stored number.
+///
+/// \return DealNumber - the number.
+DealNumber loadDealNumber(const uint8_t bytes[DEALNUMBERBYTES]) {
+    DealNumber number = 0;
+    for (int i = 0; i < DEALNUMBERBYTES; i++) {
+        number |= (DealNumber) bytes[i] << (8 * i);
+    }
+    return number;
+}
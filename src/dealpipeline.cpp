@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include "dealpipeline.h"
+#include "profiler.h"
+
+/// This class deals, bids and writes a large number of deals through a pipeline of generation,
+/// evaluation, formatting and writing stages joined by single-producer single-consumer rings of batches.
+///
+
+/// \brief
+/// Returns the seconds since a point in time.
+///
+/// \param start chrono::steady_clock::time_point - the point in time.
+///
+/// \return double - seconds elapsed.
+static inline double secondsSince(chrono::steady_clock::time_point start) {
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/// \brief
+/// Sets up a pipeline for the given number of deals, with one thread per stage.
+///
+/// \param numDeals long long - total number of deals.
+/// \param seed unsigned long long - seed from which every deal's random stream is derived.
+/// \param layout Layout - how each deal is laid out.
+DealPipeline::DealPipeline(long long numDeals, unsigned long long seed, Layout layout) :
+    numDeals(numDeals), seed(seed), layout(layout) {
+}
+
+/// \brief
+/// Sets the number of threads of the generation, evaluation or formatting stage. Writing
+/// always has one thread, as the output is written in order.
+///
+/// \param stage PipelineStage - the stage.
+/// \param numThreads int - number of threads, at least one.
+void DealPipeline::setParallelism(PipelineStage stage, int numThreads) {
+    if (stage != WRITESTAGE) {
+        this->numThreads[stage] = max(1, numThreads);
+    }
+}
+
+/// \brief
+/// Runs every stage, writing on the calling thread.
+///
+/// \param out ostream& - output stream receiving the deals.
+void DealPipeline::run(ostream& out) {
+    numBatches = (numDeals + PIPELINEBATCH - 1) / PIPELINEBATCH;
+
+    // Written batches go back to the generator that made them
+    rings[GENERATESTAGE] = vector<SpscRing<DealBatch*>>(numThreads[GENERATESTAGE]);
+    for (int stage = EVALUATESTAGE; stage < NUMSTAGES; stage++) {
+        rings[stage] = vector<SpscRing<DealBatch*>>(numThreads[stage - 1] * numThreads[stage]);
+    }
+    for (int stage = 0; stage < NUMSTAGES; stage++) {
+        counters[stage].assign(numThreads[stage], StageCounters());
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int i = 0; i < numThreads[GENERATESTAGE]; i++) {
+        workers.push_back(thread(&DealPipeline::generate, this, i));
+    }
+    for (int i = 0; i < numThreads[EVALUATESTAGE]; i++) {
+        workers.push_back(thread(&DealPipeline::evaluate, this, i));
+    }
+    for (int i = 0; i < numThreads[FORMATSTAGE]; i++) {
+        workers.push_back(thread(&DealPipeline::format, this, i));
+    }
+    write(out);
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    seconds = secondsSince(start);
+
+    // Every batch ends up back in a return ring or was deleted when its ring was full
+    for (size_t i = 0; i < rings[GENERATESTAGE].size(); i++) {
+        DealBatch* batch;
+        while (rings[GENERATESTAGE][i].pop(batch)) {
+            delete batch;
+        }
+    }
+}
+
+/// \brief
+/// Returns the throughput of the last run.
+///
+/// \return double - deals written per second.
+double DealPipeline::getDealsPerSecond() {
+    return numDeals / max(seconds, 1e-9);
+}
+
+/// \brief
+/// Writes a table of each stage's threads, batches, share of time busy, starved and blocked,
+/// how full its input queue ran and the deals per second it could manage if never kept waiting.
+///
+/// \param out ostream& - output stream receiving the table.
+void DealPipeline::printCounters(ostream& out) {
+    const char* stageNames[NUMSTAGES] = { "generate", "evaluate", "format", "write" };
+
+    out << left << setw(10) << "stage" << right << setw(8) << "threads" << setw(10) << "batches" << setw(8) << "busy%"
+        << setw(10) << "starved%" << setw(10) << "blocked%" << setw(12) << "queue fill%" << setw(14) << "capacity/sec"
+        << endl;
+    for (int stage = 0; stage < NUMSTAGES; stage++) {
+        StageCounters total;
+        for (size_t i = 0; i < counters[stage].size(); i++) {
+            total.batches += counters[stage][i].batches;
+            total.busySeconds += counters[stage][i].busySeconds;
+            total.starvedSeconds += counters[stage][i].starvedSeconds;
+            total.blockedSeconds += counters[stage][i].blockedSeconds;
+            total.fillTotal += counters[stage][i].fillTotal;
+        }
+
+        // Generation has no input queue, its batches coming from the return rings or new
+        double threadSeconds = max(seconds * numThreads[stage], 1e-9);
+        out << left << setw(10) << stageNames[stage] << right << setw(8) << numThreads[stage] << setw(10) << total.batches
+            << fixed << setprecision(1) << setw(8) << 100 * total.busySeconds / threadSeconds
+            << setw(10) << 100 * total.starvedSeconds / threadSeconds << setw(10) << 100 * total.blockedSeconds / threadSeconds;
+        if (stage == GENERATESTAGE) {
+            out << setw(12) << "-";
+        }
+        else {
+            out << setw(12) << 100 * total.fillTotal / max(total.batches, 1LL);
+        }
+        out << setprecision(0) << setw(14) << numDeals * numThreads[stage] / max(total.busySeconds, 1e-9) << endl;
+    }
+}
+
+/// \brief
+/// Shuffles and deals the batches of one generation thread.
+///
+/// \param thread int - index of the thread within the stage.
+void DealPipeline::generate(int thread) {
+    StageCounters& counter = counters[GENERATESTAGE][thread];
+    Deck deck;
+
+    for (long long b = thread; b < numBatches; b += numThreads[GENERATESTAGE]) {
+        DealBatch* batch;
+        if (!rings[GENERATESTAGE][thread].pop(batch)) {
+            batch = new DealBatch();
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        batch->index = b;
+        batch->count = (int) min((long long) PIPELINEBATCH, numDeals - b * PIPELINEBATCH);
+
+        // Deal k is dealt as a game with dealer k modulo four deals it, the first card going to the dealer's left
+        for (int i = 0; i < batch->count; i++) {
+            long long deal = b * PIPELINEBATCH + i;
+            CardSet* hands = batch->deals[i];
+            int first = (int) ((deal + 1) % NUMPOSITIONS);
+            deck.shuffle(seed, deal);
+            PROFILE_SCOPE(DEALCOUNTER);
+            for (int j = 0; j < NUMPOSITIONS; j++) {
+                hands[j] = 0;
+            }
+            for (int j = 0; j < NUMCARDS; j++) {
+                Card* card = deck.dealNextCard();
+                hands[(j + first) % NUMPOSITIONS] |= cardBit(card->getRank(), card->getSuit());
+            }
+        }
+        counter.busySeconds += secondsSince(start);
+        counter.batches++;
+        send(GENERATESTAGE, batch, thread);
+    }
+}
+
+/// \brief
+/// Finds the opening bids of the batches of one evaluation thread.
+///
+/// \param thread int - index of the thread within the stage.
+void DealPipeline::evaluate(int thread) {
+    StageCounters& counter = counters[EVALUATESTAGE][thread];
+    HandBatch evaluator;
+    vector<HandFeatures> features(PIPELINEBATCH * NUMPOSITIONS);
+
+    for (long long b = thread; b < numBatches; b += numThreads[EVALUATESTAGE]) {
+        DealBatch* batch = receive(EVALUATESTAGE, b, thread);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        // The hands of a batch lie one after another, so they are evaluated with one call
+        evaluator.evaluate(batch->deals[0], batch->count * NUMPOSITIONS, features.data());
+        for (int i = 0; i < batch->count; i++) {
+            PROFILE_SCOPE(BIDCOUNTER);
+            int dealer = (int) ((b * PIPELINEBATCH + i) % NUMPOSITIONS);
+            batch->bids[i] = PASSBID;
+            batch->openers[i] = (Position) dealer;
+            for (int j = 0; j < NUMPOSITIONS; j++) {
+                int seat = (dealer + j) % NUMPOSITIONS;
+                BidCode bid = HandBatch::openingBid(features[i * NUMPOSITIONS + seat]);
+                if (bid != PASSBID) {
+                    batch->bids[i] = bid;
+                    batch->openers[i] = (Position) seat;
+                    break;
+                }
+            }
+        }
+        counter.busySeconds += secondsSince(start);
+        counter.batches++;
+        send(EVALUATESTAGE, batch, thread);
+    }
+}
+
+/// \brief
+/// Lays out the batches of one formatting thread.
+///
+/// \param thread int - index of the thread within the stage.
+void DealPipeline::format(int thread) {
+    StageCounters& counter = counters[FORMATSTAGE][thread];
+    DealRenderer renderer(layout);
+
+    for (long long b = thread; b < numBatches; b += numThreads[FORMATSTAGE]) {
+        DealBatch* batch = receive(FORMATSTAGE, b, thread);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int i = 0; i < batch->count; i++) {
+            Position dealer = (Position) ((b * PIPELINEBATCH + i) % NUMPOSITIONS);
+            renderer.add(batch->deals[i], dealer, batch->bids[i], batch->openers[i]);
+        }
+        renderer.takeText(batch->text);
+        counter.busySeconds += secondsSince(start);
+        counter.batches++;
+        send(FORMATSTAGE, batch, thread);
+    }
+}
+
+/// \brief
+/// Writes every batch in order and hands each back to its generator.
+///
+/// \param out ostream& - output stream receiving the deals.
+void DealPipeline::write(ostream& out) {
+    StageCounters& counter = counters[WRITESTAGE][0];
+
+    for (long long b = 0; b < numBatches; b++) {
+        DealBatch* batch = receive(WRITESTAGE, b, 0);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        out.write(batch->text.data(), batch->text.size());
+        counter.busySeconds += secondsSince(start);
+        counter.batches++;
+
+        // A generator whose return ring is full already has batches enough
+        if (!rings[GENERATESTAGE][b % numThreads[GENERATESTAGE]].push(batch)) {
+            delete batch;
+        }
+    }
+    out.flush();
+}
+
+/// \brief
+/// Waits for a batch to arrive from the stage before.
+///
+/// \param stage PipelineStage - the stage receiving the batch.
+/// \param batchIndex long long - the batch wanted.
+/// \param thread int - index of the receiving thread within the stage.
+///
+/// \return DealBatch* - the batch.
+DealPipeline::DealBatch* DealPipeline::receive(PipelineStage stage, long long batchIndex, int thread) {
+    int producer = (int) (batchIndex % numThreads[stage - 1]);
+    SpscRing<DealBatch*>& ring = rings[stage][producer * numThreads[stage] + thread];
+    StageCounters& counter = counters[stage][thread];
+    counter.fillTotal += (double) ring.size() / ring.capacity();
+
+    DealBatch* batch;
+    if (!ring.pop(batch)) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (!ring.pop(batch)) {
+            this_thread::yield();
+        }
+        counter.starvedSeconds += secondsSince(start);
+    }
+    return batch;
+}
+
+/// \brief
+/// Waits for room to pass a batch on to the stage after.
+///
+/// \param stage PipelineStage - the stage sending the batch.
+/// \param batch DealBatch* - the batch.
+/// \param thread int - index of the sending thread within the stage.
+void DealPipeline::send(PipelineStage stage, DealBatch* batch, int thread) {
+    int next = stage + 1;
+    int consumer = (int) (batch->index % numThreads[next]);
+    SpscRing<DealBatch*>& ring = rings[next][thread * numThreads[next] + consumer];
+
+    if (!ring.push(batch)) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (!ring.push(batch)) {
+            this_thread::yield();
+        }
+        counters[stage][thread].blockedSeconds += secondsSince(start);
+    }
+}
@@ -0,0 +1,160 @@
+#include "dealrenderer.h"
+#include "profiler.h"
+#include "suittables.h"
+
+/// This class formats deals as text into a buffer kept between batches, so that a batch of deals
+/// is written out with one large write.
+///
+
+/// \brief
+/// Creates a renderer for the given layout.
+///
+/// \param layout Layout - how each deal is laid out.
+DealRenderer::DealRenderer(Layout layout) {
+    this->layout = layout;
+
+    // Leave room for a full batch past the point where the buffer counts as full
+    buffer.reserve(2 * RENDERBUFFERBYTES);
+}
+
+/// \brief
+/// Adds a dealt and bid game to the buffer.
+///
+/// \param game Game& - a game whose cards have been dealt and auction held.
+void DealRenderer::add(Game& game) {
+    CardSet deal[NUMPOSITIONS];
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        deal[i] = game.getHand((Position) i)->getCards();
+    }
+    add(deal, game.getDealer(), game.getOpeningBid(), game.getOpener());
+}
+
+/// \brief
+/// Adds a deal to the buffer.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param dealer Position - the player dealing.
+/// \param openingBid BidCode - the opening bid, or PASSBID if all hands passed.
+/// \param opener Position - the player making the opening bid.
+void DealRenderer::add(const CardSet deal[NUMPOSITIONS], Position dealer, BidCode openingBid, Position opener) {
+    PROFILE_SCOPE(RENDERCOUNTER);
+    const char* positionNames[NUMPOSITIONS] = { "NORTH", "EAST", "SOUTH", "WEST" };
+    const char* suitLabels[NUMSUITS] = { "Clubs\t :", "Diamonds :", "Hearts\t :", "Spades\t :" };
+    const char suitChars[NUMSUITS] = { 'C', 'D', 'H', 'S' };
+    const char positionChars[NUMPOSITIONS] = { 'N', 'E', 'S', 'W' };
+
+    switch (layout) {
+        case DIAGRAM:
+            for (int i = 0; i < NUMPOSITIONS; i++) {
+                buffer += positionNames[i];
+                buffer += '\n';
+                for (int suit = SPADES; suit >= CLUBS; suit--) {
+                    buffer += suitLabels[suit];
+                    appendSuit(deal[i], (Suit) suit, suitChars[suit]);
+                    buffer += '\n';
+                }
+                buffer += '\n';
+            }
+            if (openingBid != PASSBID) {
+                buffer += "Opening bid is ";
+                buffer += Hand::bidName(openingBid);
+                buffer += " made by ";
+                buffer += positionNames[opener];
+                buffer += '\n';
+            }
+            else {
+                buffer += "All hands passed\n";
+            }
+            buffer += "\n\n==============================================================\n\n";
+            break;
+
+        case PBN:
+            buffer += "[Deal \"";
+            buffer += positionChars[dealer];
+            buffer += ':';
+            for (int i = 0; i < NUMPOSITIONS; i++) {
+                if (i > 0) {
+                    buffer += ' ';
+                }
+                appendDotted(deal[(dealer + i) % NUMPOSITIONS]);
+            }
+            buffer += "\"]\n";
+            break;
+
+        case COMPACT:
+            for (int i = 0; i < NUMPOSITIONS; i++) {
+                appendDotted(deal[i]);
+                buffer += ' ';
+            }
+            if (openingBid != PASSBID) {
+                buffer += Hand::bidName(openingBid);
+                buffer += ' ';
+                buffer += positionChars[opener];
+            }
+            else {
+                buffer += "PASS";
+            }
+            buffer += '\n';
+            break;
+    }
+}
+
+/// \brief
+/// Returns whether the buffer has grown past its usual size and should be written out.
+///
+/// \return bool - true if the buffer is full.
+bool DealRenderer::full() {
+    return buffer.size() >= RENDERBUFFERBYTES;
+}
+
+/// \brief
+/// Writes the buffered text to the output stream with one write and empties the buffer,
+/// keeping its memory for the next batch.
+///
+/// \param out ostream& - output stream receiving the text.
+void DealRenderer::write(ostream& out) {
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    buffer.clear();
+}
+
+/// \brief
+/// Hands the buffered text over by exchanging it with a string, which is emptied first so that
+/// its memory is reused for the next batch, leaving the buffer empty.
+///
+/// \param text string& - receives the buffered text.
+void DealRenderer::takeText(string& text) {
+    text.clear();
+    buffer.swap(text);
+}
+
+/// \brief
+/// Appends the ranks held in one suit.
+///
+/// \param cards CardSet - the hand.
+/// \param suit Suit - the suit to write.
+/// \param suitChar char - letter written after every rank, or zero to write the ranks alone.
+void DealRenderer::appendSuit(CardSet cards, Suit suit, char suitChar) {
+    const SuitInfo& info = suitInfo(suitHolding(cards, suit));
+    if (suitChar == 0) {
+        buffer.append(info.ranks, info.length);
+        return;
+    }
+    for (int i = 0; i < info.length; i++) {
+        char card[3] = { ' ', info.ranks[i], suitChar };
+        buffer.append(card, 3);
+    }
+}
+
+/// \brief
+/// Appends a hand as its spade, heart, diamond and club ranks separated by dots.
+///
+/// \param cards CardSet - the hand.
+void DealRenderer::appendDotted(CardSet cards) {
+    for (int suit = SPADES; suit >= CLUBS; suit--) {
+        appendSuit(cards, (Suit) suit, 0);
+        if (suit != CLUBS) {
+            buffer += '.';
+        }
+    }
+}
@@ -0,0 +1,623 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "dealfile.h"
+#include "dealservice.h"
+
+/// This class keeps the dealer and bidder running as a service so that tools send requests instead of
+/// starting a process per job. One thread reads every connection and queues each complete request,
+/// and a fixed pool of workers takes queued requests in batches and writes the answers.
+///
+
+const int FILEBUFFERBYTES = 1 << 16;
+
+/// \brief
+/// Writes all of a block of bytes to a file descriptor, carrying on after partial writes.
+///
+/// \param fd int - the file descriptor.
+/// \param data const char* - the bytes.
+/// \param size size_t - number of bytes.
+///
+/// \return bool - false if the file could not be written, such as when the client has gone.
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+/// A stream buffer writing to a file descriptor, so that answers are formatted with the usual stream
+/// operators and sent in large writes.
+class FileBuffer : public streambuf {
+    public:
+        FileBuffer(int fd) : fd(fd) {
+            setp(data, data + FILEBUFFERBYTES);
+        }
+
+    protected:
+        int overflow(int c) {
+            if (!flushData()) {
+                return EOF;
+            }
+            if (c != EOF) {
+                *pptr() = (char) c;
+                pbump(1);
+            }
+            return c == EOF ? 0 : c;
+        }
+
+        int sync() {
+            return flushData() ? 0 : -1;
+        }
+
+    private:
+        int fd;
+        char data[FILEBUFFERBYTES];
+
+        bool flushData() {
+            bool written = writeAll(fd, pbase(), pptr() - pbase());
+            setp(data, data + FILEBUFFERBYTES);
+            return written;
+        }
+};
+
+/// \brief
+/// Finds the opening bid of a deal by evaluating its hands and bidding from the dealer round.
+///
+/// \param evaluator HandBatch& - the hand evaluator.
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param dealer Position - the player dealing.
+/// \param opener Position& - receives the player making the opening bid.
+///
+/// \return BidCode - the opening bid, or PASSBID if all hands passed.
+static BidCode openingBid(HandBatch& evaluator, const CardSet deal[NUMPOSITIONS], Position dealer, Position& opener) {
+    HandFeatures features[NUMPOSITIONS];
+    evaluator.evaluate(deal, NUMPOSITIONS, features);
+    opener = dealer;
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        Position seat = (Position) ((dealer + i) % NUMPOSITIONS);
+        BidCode bid = HandBatch::openingBid(features[seat]);
+        if (bid != PASSBID) {
+            opener = seat;
+            return bid;
+        }
+    }
+    return PASSBID;
+}
+
+/// \brief
+/// Sets up a service with the given number of workers.
+///
+/// \param numWorkers int - number of worker threads answering requests.
+DealService::DealService(int numWorkers) :
+    numWorkers(max(1, numWorkers)) {
+    for (int i = 0; i < NUMTIMEDREQUESTS; i++) {
+        latencies[i].samples.reserve(LATENCYSAMPLES);
+    }
+}
+
+/// \brief
+/// Closes the socket and removes its file.
+DealService::~DealService() {
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+/// \brief
+/// Opens the Unix domain socket clients connect to, or takes standard input and output as the
+/// only client when the path is "-".
+///
+/// \param path const string& - file name of the socket, or "-".
+/// \param error string& - receives a description of the problem if the socket cannot be opened.
+///
+/// \return bool - true if the service is ready to run.
+bool DealService::open(const string& path, string& error) {
+    if (path == "-") {
+        useStandardStreams = true;
+        return true;
+    }
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        error = "Error: The socket path " + path + " is too long";
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+
+    // A socket left behind by an earlier run is replaced, but no other kind of file
+    struct stat status;
+    if (stat(path.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            error = "Error: " + path + " exists and is not a socket";
+            return false;
+        }
+        unlink(path.c_str());
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, (sockaddr*) &address, sizeof(address)) != 0
+        || listen(listenFd, SOMAXCONN) != 0) {
+        error = "Error: Could not open socket " + path + " (" + strerror(errno) + ")";
+        if (listenFd >= 0) {
+            close(listenFd);
+            listenFd = -1;
+        }
+        return false;
+    }
+    socketPath = path;
+    return true;
+}
+
+/// \brief
+/// Answers requests until a shutdown request, or until standard input ends when it is the client.
+void DealService::run() {
+
+    // A client going away while being answered must not end the service
+    signal(SIGPIPE, SIG_IGN);
+    if (pipe(wakeFds) != 0) {
+        return;
+    }
+    if (useStandardStreams) {
+        Connection* connection = new Connection();
+        connection->inFd = STDIN_FILENO;
+        connection->outFd = STDOUT_FILENO;
+        connections.push_back(connection);
+    }
+
+    vector<thread> workers;
+    for (int i = 0; i < numWorkers; i++) {
+        workers.push_back(thread(&DealService::worker, this));
+    }
+
+    vector<char> data(FILEBUFFERBYTES);
+    bool stop = false;
+    while (!stop) {
+        vector<pollfd> fds;
+        vector<Connection*> polled;
+        fds.push_back({ wakeFds[0], POLLIN, 0 });
+        if (listenFd >= 0) {
+            fds.push_back({ listenFd, POLLIN, 0 });
+        }
+        size_t firstConnection = fds.size();
+        for (size_t i = 0; i < connections.size(); i++) {
+            if (!connections[i]->closed) {
+                fds.push_back({ connections[i]->inFd, POLLIN, 0 });
+                polled.push_back(connections[i]);
+            }
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        // Workers write to the wake pipe when they finish a batch
+        if (fds[0].revents != 0) {
+            if (read(wakeFds[0], data.data(), data.size()) < 0 && errno != EINTR) {
+                break;
+            }
+            lock_guard<mutex> guard(queueLock);
+            for (size_t i = 0; i < finished.size(); i++) {
+                finished[i]->busy = false;
+            }
+            finished.clear();
+            stop = shutdownRequested;
+        }
+
+        if (listenFd >= 0 && (fds[1].revents & POLLIN) != 0) {
+            int fd = accept(listenFd, NULL, NULL);
+            if (fd >= 0) {
+                Connection* connection = new Connection();
+                connection->inFd = fd;
+                connection->outFd = fd;
+                connections.push_back(connection);
+            }
+        }
+
+        for (size_t i = 0; i < polled.size(); i++) {
+            if (fds[firstConnection + i].revents != 0) {
+                ssize_t size = read(polled[i]->inFd, data.data(), data.size());
+                if (size > 0) {
+                    polled[i]->input.append(data.data(), size);
+                }
+                else if (size == 0 || errno != EINTR) {
+                    polled[i]->closed = true;
+                }
+            }
+        }
+
+        // Queue the next request of each idle connection, and let go of those that are finished with
+        for (size_t i = 0; i < connections.size();) {
+            Connection* connection = connections[i];
+            if (!connection->busy && queueRequest(connection)) {
+                connection->busy = true;
+            }
+            if (!connection->busy && connection->closed) {
+                if (!useStandardStreams) {
+                    close(connection->inFd);
+                }
+                delete connection;
+                connections.erase(connections.begin() + i);
+            }
+            else {
+                i++;
+            }
+        }
+        if (useStandardStreams && connections.empty()) {
+            stop = true;
+        }
+    }
+
+    // Workers answer whatever is already queued before stopping
+    {
+        lock_guard<mutex> guard(queueLock);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    for (size_t i = 0; i < connections.size(); i++) {
+        if (!useStandardStreams) {
+            close(connections[i]->inFd);
+        }
+        delete connections[i];
+    }
+    connections.clear();
+    close(wakeFds[0]);
+    close(wakeFds[1]);
+}
+
+/// \brief
+/// Queues the next request of a connection if all its lines have arrived.
+///
+/// \param connection Connection* - a connection with no request queued or being answered.
+///
+/// \return bool - true if a request was queued.
+bool DealService::queueRequest(Connection* connection) {
+    string& input = connection->input;
+    size_t end = input.find('\n');
+
+    // Blank lines between requests are skipped
+    while (end != string::npos && input.find_first_not_of(" \t\r") >= end) {
+        input.erase(0, end + 1);
+        end = input.find('\n');
+    }
+    if (end == string::npos) {
+        return false;
+    }
+
+    // Bid and parse requests are followed by the number of lines they give
+    Request request;
+    request.lines.push_back(input.substr(0, end));
+    RequestKind kind = requestKind(request.lines[0]);
+    long long numLines = 0;
+    if (kind == BIDREQUEST || kind == PARSEREQUEST) {
+        istringstream in(request.lines[0]);
+        string word;
+        if (!(in >> word >> numLines) || numLines < 1 || numLines > MAXREQUESTLINES) {
+            numLines = 0;
+        }
+    }
+
+    size_t start = end + 1;
+    for (long long i = 0; i < numLines; i++) {
+        end = input.find('\n', start);
+        if (end == string::npos) {
+            return false;
+        }
+        request.lines.push_back(input.substr(start, end - start));
+        start = end + 1;
+    }
+    input.erase(0, start);
+
+    request.connection = connection;
+    request.arrived = chrono::steady_clock::now();
+    {
+        lock_guard<mutex> guard(queueLock);
+        queue.push_back(move(request));
+    }
+    queueChanged.notify_one();
+    return true;
+}
+
+/// \brief
+/// Takes batches of requests from the queue and answers them until the service stops.
+void DealService::worker() {
+    Game game;
+    HandBatch evaluator;
+    DealRenderer renderer(COMPACT);
+    vector<Request> requests;
+    vector<CardSet> hands;
+    vector<HandFeatures> features;
+    vector<string> errors;
+
+    while (true) {
+        {
+            unique_lock<mutex> guard(queueLock);
+            queueChanged.wait(guard, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            while (!queue.empty() && (int) requests.size() < SERVICEBATCH) {
+                requests.push_back(move(queue.front()));
+                queue.pop_front();
+            }
+        }
+
+        evaluateBids(requests, evaluator, hands, features, errors);
+        size_t nextHand = 0;
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            Request& request = requests[i];
+            RequestKind kind = requestKind(request.lines[0]);
+            FileBuffer buffer(request.connection->outFd);
+            ostream out(&buffer);
+
+            switch (kind) {
+                case GENERATEREQUEST:
+                    generate(request, out, game, renderer);
+                    break;
+
+                case BIDREQUEST:
+                    if (!errors[i].empty()) {
+                        out << "ERROR " << errors[i] << "\n";
+                        break;
+                    }
+                    out << "OK " << request.lines.size() - 1 << "\n";
+                    for (size_t j = 1; j < request.lines.size(); j++, nextHand++) {
+                        const HandFeatures& hand = features[nextHand];
+                        out << (int) hand.highCardPoints << ' ' << hand.highCardPoints + hand.lengthPoints << ' '
+                            << (int) hand.lengths[SPADES] << '-' << (int) hand.lengths[HEARTS] << '-'
+                            << (int) hand.lengths[DIAMONDS] << '-' << (int) hand.lengths[CLUBS] << ' '
+                            << Hand::bidName(HandBatch::openingBid(hand)) << "\n";
+                    }
+                    break;
+
+                case PARSEREQUEST:
+                    parse(request, out, evaluator, renderer);
+                    break;
+
+                case STATSREQUEST:
+                    writeStats(out);
+                    break;
+
+                case SHUTDOWNREQUEST:
+                    out << "OK 0\n";
+                    {
+                        lock_guard<mutex> guard(queueLock);
+                        shutdownRequested = true;
+                    }
+                    break;
+
+                default:
+                    out << "ERROR Unknown request " << request.lines[0].substr(0, 32) << "\n";
+                    break;
+            }
+            out.flush();
+
+            if (kind < NUMTIMEDREQUESTS) {
+                chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - request.arrived;
+                recordLatency(kind, elapsed.count());
+            }
+        }
+
+        // Hand the connections back to the reading thread so their next requests can be queued
+        {
+            lock_guard<mutex> guard(queueLock);
+            for (size_t i = 0; i < requests.size(); i++) {
+                finished.push_back(requests[i].connection);
+            }
+        }
+        requests.clear();
+        char wake = 1;
+        writeAll(wakeFds[1], &wake, 1);
+    }
+}
+
+/// \brief
+/// Evaluates the hands of every bid request in a batch with one call to the hand evaluator.
+///
+/// \param requests vector<Request>& - the batch.
+/// \param evaluator HandBatch& - the worker's hand evaluator.
+/// \param hands vector<CardSet>& - receives the hands of the bid requests one after another.
+/// \param features vector<HandFeatures>& - receives the features of each hand.
+/// \param errors vector<string>& - receives the problem with each request's hands, empty if they could all be read.
+void DealService::evaluateBids(vector<Request>& requests, HandBatch& evaluator, vector<CardSet>& hands,
+                               vector<HandFeatures>& features, vector<string>& errors) {
+    hands.clear();
+    errors.assign(requests.size(), "");
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (requestKind(requests[i].lines[0]) != BIDREQUEST) {
+            continue;
+        }
+        if (requests[i].lines.size() == 1) {
+            errors[i] = "BID needs a count of hands from 1 to " + to_string(MAXREQUESTLINES);
+            continue;
+        }
+
+        // A request with a bad hand is answered with an error and its hands are dropped
+        size_t firstHand = hands.size();
+        for (size_t j = 1; j < requests[i].lines.size() && errors[i].empty(); j++) {
+            CardSet hand;
+            string text = requests[i].lines[j];
+            text.erase(text.find_last_not_of(" \t\r") + 1);
+            if (!readDottedHand(text, hand)) {
+                errors[i] = "Hand " + to_string(j) + " is not four suits of different ranks";
+            }
+            else if (cardCount(hand) != NUMRANKS) {
+                errors[i] = "Hand " + to_string(j) + " does not hold 13 cards";
+            }
+            hands.push_back(hand);
+        }
+        if (!errors[i].empty()) {
+            hands.resize(firstHand);
+        }
+    }
+
+    features.resize(hands.size());
+    if (!hands.empty()) {
+        evaluator.evaluate(hands.data(), hands.size(), features.data());
+    }
+}
+
+/// \brief
+/// Writes the answer to a generate request.
+///
+/// \param request Request& - the request.
+/// \param out ostream& - stream to the client.
+/// \param game Game& - the worker's game.
+/// \param renderer DealRenderer& - the worker's compact renderer.
+void DealService::generate(Request& request, ostream& out, Game& game, DealRenderer& renderer) {
+    istringstream in(request.lines[0]);
+    string word;
+    long long numDeals;
+    unsigned long long seed;
+    unsigned long long first = 0;
+    if (!(in >> word >> numDeals >> seed) || numDeals < 1 || numDeals > MAXSERVICEDEALS) {
+        out << "ERROR GENERATE needs a count of deals from 1 to " << MAXSERVICEDEALS << " and a seed\n";
+        return;
+    }
+    in >> first;
+
+    // Deal k is the deal the --render and --stats modes make from the same seed
+    out << "OK " << numDeals << "\n";
+    for (long long i = 0; i < numDeals; i++) {
+        game.setDealer((Position) ((first + i) % NUMPOSITIONS));
+        game.setup(seed, first + i);
+        game.deal();
+        game.auction();
+        renderer.add(game);
+        if (renderer.full()) {
+            renderer.write(out);
+        }
+    }
+    renderer.write(out);
+}
+
+/// \brief
+/// Writes the answer to a parse request.
+///
+/// \param request Request& - the request.
+/// \param out ostream& - stream to the client.
+/// \param evaluator HandBatch& - the worker's hand evaluator.
+/// \param renderer DealRenderer& - the worker's compact renderer.
+void DealService::parse(Request& request, ostream& out, HandBatch& evaluator, DealRenderer& renderer) {
+    size_t numDeals = request.lines.size() - 1;
+    if (numDeals == 0) {
+        out << "ERROR PARSE needs a count of deals from 1 to " << MAXREQUESTLINES << "\n";
+        return;
+    }
+
+    // Every deal is read before any is written so that a bad deal gives only an error
+    vector<CardSet> deals(numDeals * NUMPOSITIONS);
+    for (size_t i = 0; i < numDeals; i++) {
+        istringstream in(request.lines[i + 1]);
+        if (!readTextDeal(in, (Position) (i % NUMPOSITIONS), &deals[i * NUMPOSITIONS])) {
+            out << "ERROR Deal " << i + 1 << " is not 52 different cards\n";
+            return;
+        }
+    }
+
+    out << "OK " << numDeals << "\n";
+    for (size_t i = 0; i < numDeals; i++) {
+        Position dealer = (Position) (i % NUMPOSITIONS);
+        Position opener;
+        BidCode bid = openingBid(evaluator, &deals[i * NUMPOSITIONS], dealer, opener);
+        renderer.add(&deals[i * NUMPOSITIONS], dealer, bid, opener);
+        if (renderer.full()) {
+            renderer.write(out);
+        }
+    }
+    renderer.write(out);
+}
+
+/// \brief
+/// Writes the request counts and latency percentiles.
+///
+/// \param out ostream& - stream to the client.
+void DealService::writeStats(ostream& out) {
+    const char* requestNames[NUMTIMEDREQUESTS] = { "GENERATE", "BID", "PARSE", "STATS" };
+    const double percentiles[] = { 0.5, 0.9, 0.99 };
+
+    out << "OK " << NUMTIMEDREQUESTS + 1 << "\n";
+    out << "request count p50_us p90_us p99_us max_us\n" << fixed << setprecision(1);
+    for (int i = 0; i < NUMTIMEDREQUESTS; i++) {
+        long long count;
+        vector<double> samples;
+        {
+            lock_guard<mutex> guard(statsLock);
+            count = latencies[i].count;
+            samples = latencies[i].samples;
+        }
+        sort(samples.begin(), samples.end());
+
+        out << requestNames[i] << ' ' << count;
+        for (double percentile : percentiles) {
+            size_t rank = (size_t) (percentile * samples.size() + 0.999999);
+            out << ' ' << (samples.empty() ? 0.0 : samples[max((size_t) 1, rank) - 1]);
+        }
+        out << ' ' << (samples.empty() ? 0.0 : samples.back()) << "\n";
+    }
+}
+
+/// \brief
+/// Records how long a request took from arriving to being answered.
+///
+/// \param kind RequestKind - the kind of request.
+/// \param microseconds double - the latency.
+void DealService::recordLatency(RequestKind kind, double microseconds) {
+    lock_guard<mutex> guard(statsLock);
+    LatencyRecord& record = latencies[kind];
+    if (record.samples.size() < (size_t) LATENCYSAMPLES) {
+        record.samples.push_back(microseconds);
+    }
+    else {
+        record.samples[record.count % LATENCYSAMPLES] = microseconds;
+    }
+    record.count++;
+}
+
+/// \brief
+/// Works out which request a line starts.
+///
+/// \param line const string& - the first line of a request.
+///
+/// \return RequestKind - the kind of request.
+RequestKind DealService::requestKind(const string& line) {
+    const char* requestNames[] = { "GENERATE", "BID", "PARSE", "STATS", "SHUTDOWN" };
+
+    istringstream in(line);
+    string word;
+    in >> word;
+    for (int i = GENERATEREQUEST; i < UNKNOWNREQUEST; i++) {
+        if (word == requestNames[i]) {
+            return (RequestKind) i;
+        }
+    }
+    return UNKNOWNREQUEST;
+}
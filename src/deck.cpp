@@ -1,40 +1,44 @@
 #include "deck.h"
-#include "random.h"
+#include "profiler.h"
 
-/// This class creates an array representing a deck that contains pointers to cards.
+/// This class creates an array representing a deck that contains pointers to cards. The cards
+/// themselves are the 52 of a single pack shared by every deck and never change.
 ///
 
+/// The 52 cards of the pack in new deck order, clubs to spades and two to ace.
+struct Pack {
+    Card cards[NUMCARDS];
+
+    Pack() {
+        for (int i = 0; i < NUMCARDS; i++) {
+            cards[i] = Card((Rank) (TWO + i % NUMRANKS), (Suit) (i / NUMRANKS));
+        }
+    }
+};
+
+/// \brief
+/// Returns the shared pack, creating it the first time any deck needs it.
+///
+/// \return Card* - the 52 cards in new deck order.
+static Card* packCards() {
+    static Pack pack;
+    return pack.cards;
+}
+
 /// \brief
 /// Creates a array of 52 pointers to card objects representing a standard deck of cards.
 Deck::Deck() {
-    int cardAdded = 0;
-
-    this->cards = new Card*[NUMCARDS];
+    Card* pack = packCards();
 
     // Fills cards array with all cards in order
-    for (Suit cardSuit = CLUBS; cardSuit <= SPADES; cardSuit = (Suit) (int) (cardSuit + 1)) {
-            for (Rank cardRank = TWO; cardRank <= ACE; cardRank = (Rank) (int) (cardRank + 1)) {
-                this->cards[cardAdded] = new Card((Rank) (cardRank), (Suit) (cardSuit));
-                cardAdded++;
-            }
+    for (int i = 0; i < NUMCARDS; i++) {
+        this->cards[i] = &pack[i];
     }
 }
 
 /// \brief
-/// Iterates through the array deleting each card pointer and then deletes the array itself.
-Deck::~Deck() {
-    Card* cardPtr;
-    int i = -1;
-
-    // iterates through cards array to delete each card pointer
-    while (NUMCARDS > ++i) {
-        cardPtr = this->cards[i];
-        delete(cardPtr);
-    }
-
-    // deletes cards array itself
-    delete(this->cards);
-}
+/// Does nothing as the cards belong to the shared pack.
+Deck::~Deck() {}
 
 /// \brief
 /// Resets the cards dealt to 0 so that the deck can be re-dealt.
@@ -52,21 +56,54 @@ Card* Deck::dealNextCard() {
 }
 
 /// \brief
-/// Randomly shuffles the card pointers in the deck.
+/// Randomly shuffles the card pointers in the deck using the deck's own randomizer,
+/// which is seeded once when the deck is created.
 void Deck::shuffle() {
-    int minIndex = 0;
-    int maxIndex = NUMCARDS - 1;
-    Random randomizer;
-
-    // Swaps random pointers
-    for (int i = 0; i < NUMSHUFFLESWAPS; i++) {
-        int firstIndex = randomizer.randomInteger(minIndex, maxIndex);
-        int secondIndex = randomizer.randomInteger(minIndex, maxIndex);
-        Card* temp = cards[firstIndex];
-        cards[firstIndex] = cards[secondIndex];
-        cards[secondIndex] = temp;
+    shuffle(randomizer);
+}
+
+/// \brief
+/// Randomly shuffles the card pointers in the deck with a Fisher-Yates shuffle using numbers drawn
+/// from the given randomizer, so that each thread can shuffle its own deck from its own stream.
+///
+/// \param randomizer Random& - the randomizer supplying the swap positions.
+void Deck::shuffle(Random& randomizer) {
+    PROFILE_SCOPE(SHUFFLECOUNTER);
+
+    // Swaps each position from the top down with a random position at or below it
+    for (int i = NUMCARDS - 1; i > 0; i--) {
+        int swapIndex = randomizer.randomInteger(0, i);
+        Card* temp = cards[i];
+        cards[i] = cards[swapIndex];
+        cards[swapIndex] = temp;
     }
+}
+
+/// \brief
+/// Arranges the deck and shuffles it from the random stream numbered by the deal, so that deal k of
+/// a seed can be regenerated directly without shuffling deals 0 to k-1 first.
+///
+/// \param seed unsigned long long - seed of the run the deal belongs to.
+/// \param dealNumber unsigned long long - number of the deal within the run.
+void Deck::shuffle(unsigned long long seed, unsigned long long dealNumber) {
+    Random dealRandomizer(seed, dealNumber);
+    arrange();
+    shuffle(dealRandomizer);
+}
+
+/// \brief
+/// Puts the card pointers back into new deck order (clubs to spades, two to ace) and resets the cards dealt.
+void Deck::arrange() {
+    Card* ordered[NUMCARDS];
 
+    // Place each card at the position given by its suit and rank
+    for (int i = 0; i < NUMCARDS; i++) {
+        ordered[cards[i]->getSuit() * NUMRANKS + cards[i]->getRank() - TWO] = cards[i];
+    }
+    for (int i = 0; i < NUMCARDS; i++) {
+        cards[i] = ordered[i];
+    }
+    reset();
 }
 
 /// \brief
@@ -86,18 +123,26 @@ ostream& operator<<(ostream& out, Deck& deck) {
 }
 
 /// \brief
-/// Creates 52 cards and adds them to a deck using an input stream.
-/// This input stream contains a string representing a card to be created (eg. 2C, 5D).
+/// Reads 52 cards into a deck using an input stream, pointing each position of the deck at the card of the pack read.
+/// This input stream contains a string representing a card (eg. 2C, 5D).
 istream& operator>>(istream& in, Deck& deck) {
+    PROFILE_SCOPE(PARSECOUNTER);
     string inputString;
+    Card* pack = packCards();
 
     for (int i = 0; i < NUMCARDS; i++) {
 
-        // Creates card from string in text file
-        in >> inputString;
-        deck.cards[i] =  new Card(inputString);
+        // Finds the card in text file within the pack
+        if (!(in >> inputString) || inputString.size() != 2) {
+            in.setstate(ios::failbit);
+            return in;
+        }
+        Card card(inputString);
+        if (card.getRank() < TWO || card.getRank() > ACE || card.getSuit() > SPADES) {
+            in.setstate(ios::failbit);
+            return in;
+        }
+        deck.cards[i] = &pack[card.getSuit() * NUMRANKS + card.getRank() - TWO];
     }
     return in;
 }
-
-
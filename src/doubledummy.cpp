@@ -0,0 +1,856 @@
+#include <algorithm>
+#include "doubledummy.h"
+
+/// Lookup tables for building transposition keys seven bits of a suit at a time.
+struct KeyTables {
+
+    // Bits of x picked out by mask m and packed together at the bottom
+    uint8_t compress[128][128];
+
+    // Bit n of v moved to bit 2n
+    uint32_t spread[128];
+
+    constexpr KeyTables() : compress(), spread() {
+        for (int m = 0; m < 128; m++) {
+            for (int x = 0; x < 128; x++) {
+                int packed = 0;
+                int next = 0;
+                for (int bit = 0; bit < 7; bit++) {
+                    if ((m >> bit) & 1) {
+                        packed |= ((x >> bit) & 1) << next++;
+                    }
+                }
+                compress[m][x] = (uint8_t) packed;
+            }
+            for (int bit = 0; bit < 7; bit++) {
+                spread[m] |= (uint32_t) ((m >> bit) & 1) << (2 * bit);
+            }
+        }
+    }
+};
+
+static constexpr KeyTables KEYTABLES;
+
+/// \brief
+/// Packs the bits of a value selected by a 13 bit mask into the lowest bits.
+///
+/// \param value int - the bits to select from.
+/// \param mask int - the bits to keep.
+///
+/// \return int - the kept bits in order, lowest first.
+static inline int compressBits(int value, int mask) {
+    return KEYTABLES.compress[mask & 127][value & 127]
+           | KEYTABLES.compress[mask >> 7][(value >> 7) & 127] << __builtin_popcount(mask & 127);
+}
+
+/// \brief
+/// Spreads the lowest 13 bits of a value out to the even bits.
+///
+/// \param value int - the bits to spread.
+///
+/// \return uint64_t - bit n of the value moved to bit 2n.
+static inline uint64_t spreadBits(int value) {
+    return KEYTABLES.spread[value & 127] | (uint64_t) KEYTABLES.spread[value >> 7] << 14;
+}
+
+/// This class solves a deal double dummy: with every hand visible and best play from both sides
+/// it finds the number of tricks the side on lead takes.
+///
+
+/// \brief
+/// Creates a solver and its transposition table.
+DoubleDummy::DoubleDummy() :
+    buckets((size_t) 1 << BUCKETBITS) {
+    lastStrain = -1;
+    for (int i = 0; i <= NUMTRICKS; i++) {
+        for (int j = 0; j < NUMPOSITIONS; j++) {
+            killers[i][j] = -1;
+        }
+    }
+}
+
+/// \brief
+/// Solves a dealt game for the given strain and opening leader.
+///
+/// \param game Game& - a game whose cards have been dealt.
+/// \param strain int - trump suit as a Suit value, or NOTRUMP.
+/// \param leader Position - the player making the opening lead.
+///
+/// \return int - tricks taken by the opening leader and their partner.
+int DoubleDummy::solve(Game& game, int strain, Position leader) {
+    CardSet deal[NUMPOSITIONS];
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        deal[i] = game.getHand((Position) i)->getCards();
+    }
+    return solve(deal, strain, leader);
+}
+
+/// \brief
+/// Solves a deal given as four card sets of equal size for the given strain and opening leader.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param strain int - trump suit as a Suit value, or NOTRUMP.
+/// \param leader Position - the player making the opening lead.
+/// \param guess int - expected result, tried first and then stepped from, or -1 to bisect.
+///
+/// \return int - tricks taken by the opening leader and their partner.
+int DoubleDummy::solve(const CardSet deal[NUMPOSITIONS], int strain, Position leader, int guess) {
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        hands[i] = deal[i];
+    }
+    tableCards = 0;
+    trump = strain;
+    maxSide = leader & 1;
+
+    // Stored bounds depend only on the position and the trump suit, so they stay valid
+    // between deals and leaders until the strain changes
+    if (strain != lastStrain) {
+        clearTable();
+        lastStrain = strain;
+    }
+
+    // Narrow the trick count with null window searches, stepping from the guess when there is one
+    // as searches close to the result reuse most of each other's stored bounds
+    int tricks = cardCount(hands[leader]);
+    int low = 0;
+    int high = tricks;
+    while (low < high) {
+        int target = guess < 0 ? (low + high + 1) / 2 : max(low + 1, min(guess, high));
+        CardSet relevant;
+        int bound = searchTrick(leader, tricks, target, relevant);
+        if (bound >= target) {
+            low = bound;
+            guess = guess < 0 ? guess : bound + 1;
+        }
+        else {
+            high = bound;
+            guess = guess < 0 ? guess : bound;
+        }
+    }
+    return low;
+}
+
+/// \brief
+/// Fills the double dummy table of a dealt game with the tricks each position takes as declarer
+/// in each strain, the opening lead being made by the player to declarer's left.
+///
+/// \param game Game& - a game whose cards have been dealt.
+/// \param table int[][] - receives the declarer's tricks indexed by strain and declarer.
+void DoubleDummy::calculateTable(Game& game, int table[NUMSTRAINS][NUMPOSITIONS]) {
+    CardSet deal[NUMPOSITIONS];
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        deal[i] = game.getHand((Position) i)->getCards();
+    }
+
+    for (int strain = 0; strain < NUMSTRAINS; strain++) {
+        int guess = -1;
+        for (int declarer = 0; declarer < NUMPOSITIONS; declarer++) {
+            Position leader = (Position) ((declarer + 1) % NUMPOSITIONS);
+
+            // Consecutive leaders are on opposite sides, so the last declarer's tricks are a good guess
+            int tricks = solve(deal, strain, leader, guess);
+            table[strain][declarer] = NUMTRICKS - tricks;
+            guess = NUMTRICKS - tricks;
+        }
+    }
+}
+
+/// \brief
+/// Returns the number of positions searched since the solver was created.
+///
+/// \return long long - count of card plays tried.
+long long DoubleDummy::getNodes() {
+    return nodes;
+}
+
+/// \brief
+/// Searches a position at the start of a trick, using and updating the stored bounds.
+///
+/// \param leader int - position leading to the trick.
+/// \param tricksLeft int - number of tricks still to be played.
+/// \param target int - tricks the searching side still needs.
+/// \param relevant CardSet& - receives the cards whose ranks decided the result.
+///
+/// \return int - tricks the searching side takes from here: a lower bound if at least the target, otherwise an upper bound.
+int DoubleDummy::searchTrick(int leader, int tricksLeft, int target, CardSet& relevant) {
+    relevant = 0;
+    if (target <= 0) {
+        return 0;
+    }
+    if (target > tricksLeft) {
+        return tricksLeft;
+    }
+    if (tricksLeft == 1) {
+        return (lastTrickWinner(leader, relevant) & 1) == maxSide ? 1 : 0;
+    }
+
+    // Trumps above all of the other side's trumps each win a trick whenever they are played
+    if (trump != NOTRUMP) {
+        int sure = trumpTricks(maxSide, relevant);
+        if (sure >= target) {
+            return sure;
+        }
+        sure = trumpTricks(1 - maxSide, relevant);
+        if (tricksLeft - sure < target) {
+            return tricksLeft - sure;
+        }
+    }
+
+    // Tricks the leader can cash straight away bound the result from one side
+    int quick = quickTricks(leader, tricksLeft, relevant);
+    bool leaderSearching = (leader & 1) == maxSide;
+    if (leaderSearching && quick >= target) {
+        return quick;
+    }
+    if (!leaderSearching && tricksLeft - quick < target) {
+        return tricksLeft - quick;
+    }
+
+    // Bounds are stored for the side on lead and converted to the searching side
+    PositionKey key;
+    positionKey(leader, key);
+    Bucket* bucket = findBucket(key, false);
+
+    // Newer bounds come last and are the most likely to match
+    for (int i = bucket == NULL ? -1 : (int) bucket->entries.size() - 1; i >= 0; i--) {
+        Entry& entry = bucket->entries[i];
+        if (((entry.owners[0] ^ key.owners[0]) & entry.masks[0]) != 0
+            || ((entry.owners[1] ^ key.owners[1]) & entry.masks[1]) != 0) {
+            continue;
+        }
+        int searchLower = leaderSearching ? entry.lower : tricksLeft - entry.upper;
+        int searchUpper = leaderSearching ? entry.upper : tricksLeft - entry.lower;
+        if (searchLower >= target || searchUpper < target) {
+            relevant = entryRelevant(entry);
+            return searchLower >= target ? searchLower : searchUpper;
+        }
+    }
+
+    int result = searchCard(leader, 0, 0, 0, leader, tricksLeft, target, relevant);
+    int searchLower = result >= target ? result : 0;
+    int searchUpper = result >= target ? tricksLeft : result;
+    if (leaderSearching) {
+        storeBound(key, relevant, searchLower, searchUpper);
+    }
+    else {
+        storeBound(key, relevant, tricksLeft - searchUpper, tricksLeft - searchLower);
+    }
+    return result;
+}
+
+/// \brief
+/// Searches the choice of card for one player within a trick.
+///
+/// \param seat int - position of the player to play.
+/// \param cardsPlayed int - number of cards already played to the trick.
+/// \param ledSuit int - suit led to the trick.
+/// \param winningCard int - bit index of the card currently winning the trick.
+/// \param winningSeat int - position of the player who played the winning card.
+/// \param tricksLeft int - number of tricks still to be completed, including this one.
+/// \param target int - tricks the searching side still needs.
+/// \param relevant CardSet& - receives the cards whose ranks decided the result.
+///
+/// \return int - tricks the searching side takes from here: a lower bound if at least the target, otherwise an upper bound.
+int DoubleDummy::searchCard(int seat, int cardsPlayed, int ledSuit, int winningCard, int winningSeat,
+                             int tricksLeft, int target, CardSet& relevant) {
+    int moves[NUMTRICKS];
+    int numMoves = generateMoves(seat, cardsPlayed, ledSuit, moves);
+    orderMoves(seat, cardsPlayed, ledSuit, winningCard, winningSeat, tricksLeft, moves, numMoves);
+    bool searching = (seat & 1) == maxSide;
+    int best = searching ? -1 : NUMTRICKS + 1;
+    CardSet skipped = 0;
+    relevant = 0;
+
+    for (int i = 0; i < numMoves; i++) {
+        int card = moves[i];
+        CardSet cardMask = (CardSet) 1 << card;
+        if ((skipped & cardMask) != 0) {
+            continue;
+        }
+        int newWinningCard = winningCard;
+        int newWinningSeat = winningSeat;
+        CardSet moveRelevant;
+        int result;
+
+        if (cardsPlayed == 0 || beats(card, winningCard)) {
+            newWinningCard = card;
+            newWinningSeat = seat;
+        }
+
+        nodes++;
+        hands[seat] ^= cardMask;
+        tableCards |= cardMask;
+
+        if (cardsPlayed == NUMPOSITIONS - 1) {
+
+            // Trick complete so the winner leads to the next one with the table cleared
+            CardSet trickCards = tableCards;
+            int won = (newWinningSeat & 1) == maxSide ? 1 : 0;
+            tableCards = 0;
+            result = won + searchTrick(newWinningSeat, tricksLeft - 1, target - won, moveRelevant);
+            tableCards = trickCards;
+
+            // The winner's rank only mattered if another card of its suit was played
+            if (suitLength(trickCards, (Suit) (newWinningCard / SUITBITS)) > 1) {
+                moveRelevant |= (CardSet) 1 << newWinningCard;
+            }
+        }
+        else {
+            result = searchCard((seat + 1) % NUMPOSITIONS, cardsPlayed + 1, cardsPlayed == 0 ? card / SUITBITS : ledSuit,
+                                newWinningCard, newWinningSeat, tricksLeft, target, moveRelevant);
+        }
+
+        hands[seat] ^= cardMask;
+        tableCards &= ~cardMask;
+
+        // Cut off as soon as one card decides the position for the player to move, otherwise
+        // the result depends on every card tried
+        if ((result >= target) == searching) {
+            if (cardsPlayed == 0) {
+                killers[tricksLeft][seat] = card;
+            }
+            relevant = moveRelevant;
+            return result;
+        }
+        relevant |= moveRelevant;
+        best = searching ? max(best, result) : min(best, result);
+
+        // Playing any card of the suit below every card whose rank mattered would give the same result
+        int suit = card / SUITBITS;
+        Holding suitRelevant = suitHolding(moveRelevant, (Suit) suit);
+        Holding below = suitRelevant == 0 ? FULLSUIT : (Holding) ((suitRelevant & -suitRelevant) - 1);
+        if (((below >> (card % SUITBITS)) & 1) != 0) {
+            skipped |= (CardSet) below << (suit * SUITBITS);
+        }
+    }
+    return best;
+}
+
+/// \brief
+/// Counts the tricks the leader can take by cashing cards higher than any the opponents hold, with
+/// partner following low. Outside the trump suit winners only count while each opponent holding a trump
+/// must follow, unless the leader's top trumps draw them first. Suits in which partner would be forced
+/// to overtake pass the lead, so only the best of those is added and it is taken last. Leading low to
+/// partner's winners in a suit instead is counted on its own.
+///
+/// \param leader int - position leading to the trick.
+/// \param tricksLeft int - number of tricks still to be played.
+/// \param relevant CardSet& - receives the lowest winner counted in each suit.
+///
+/// \return int - a lower bound on the tricks of the leader's side.
+int DoubleDummy::quickTricks(int leader, int tricksLeft, CardSet& relevant) {
+    CardSet leftHand = hands[(leader + 1) % NUMPOSITIONS];
+    CardSet rightHand = hands[(leader + 3) % NUMPOSITIONS];
+    CardSet opponents = leftHand | rightHand;
+    bool leftRuffs = trump != NOTRUMP && suitHolding(leftHand, (Suit) trump) != 0;
+    bool rightRuffs = trump != NOTRUMP && suitHolding(rightHand, (Suit) trump) != 0;
+    bool trumpsDrawn = false;
+    int tricks = 0;
+    int lastSuitTricks = 0;
+    CardSet lastSuitRelevant = 0;
+    int crossTricks = 0;
+    CardSet crossRelevant = 0;
+
+    relevant = 0;
+    // Trumps come first as drawing them all makes the side suit winners safe from ruffs
+    for (int i = 0; i < NUMSUITS; i++) {
+        int suit = trump == NOTRUMP ? i : (trump + i) % NUMSUITS;
+        Holding winners = suitHolding(hands[leader], (Suit) suit);
+        if (winners == 0) {
+            continue;
+        }
+
+        // Leader's cards above the opponents' highest card in the suit
+        Holding opponentsHolding = suitHolding(opponents, (Suit) suit);
+        if (opponentsHolding != 0) {
+            winners &= (Holding) ~((2 << highestRank(opponentsHolding)) - 1);
+        }
+        int limit = holdingLength(winners);
+        if (suit != trump && !trumpsDrawn) {
+            if (leftRuffs) {
+                limit = min(limit, suitLength(leftHand, (Suit) suit));
+            }
+            if (rightRuffs) {
+                limit = min(limit, suitLength(rightHand, (Suit) suit));
+            }
+        }
+
+        // Cash from the top while partner plays their lowest card
+        Holding partnerHolding = suitHolding(hands[(leader + 2) % NUMPOSITIONS], (Suit) suit);
+        Holding played = 0;
+        bool keepsLead = true;
+        int count = 0;
+        while (count < limit && keepsLead) {
+            played = (Holding) (1 << highestRank(winners));
+            winners ^= played;
+            count++;
+            if (partnerHolding != 0) {
+                Holding partnerCard = partnerHolding & -partnerHolding;
+                partnerHolding ^= partnerCard;
+                keepsLead = partnerCard < played;
+            }
+        }
+
+        // Leading low to partner's winners instead hands partner the lead for the rest of the suit
+        Holding partnerWinners = suitHolding(hands[(leader + 2) % NUMPOSITIONS], (Suit) suit);
+        if (opponentsHolding != 0) {
+            partnerWinners &= (Holding) ~((2 << highestRank(opponentsHolding)) - 1);
+        }
+        Holding leaderHolding = suitHolding(hands[leader], (Suit) suit);
+        if (partnerWinners != 0 && (leaderHolding & -leaderHolding) < (1 << highestRank(partnerWinners))) {
+            int crossLimit = holdingLength(partnerWinners);
+            if (suit != trump) {
+                if (leftRuffs) {
+                    crossLimit = min(crossLimit, suitLength(leftHand, (Suit) suit));
+                }
+                if (rightRuffs) {
+                    crossLimit = min(crossLimit, suitLength(rightHand, (Suit) suit));
+                }
+            }
+            Holding crossPlayed = 0;
+            int crossCount = 0;
+            bool partnerLeads = true;
+            while (crossCount < crossLimit && partnerLeads) {
+                crossPlayed = (Holding) (1 << highestRank(partnerWinners));
+                partnerWinners ^= crossPlayed;
+                crossCount++;
+                if (leaderHolding != 0) {
+                    Holding leaderCard = leaderHolding & -leaderHolding;
+                    leaderHolding ^= leaderCard;
+                    partnerLeads = leaderCard < crossPlayed;
+                }
+            }
+            if (crossCount > crossTricks) {
+                crossTricks = crossCount;
+                crossRelevant = (CardSet) crossPlayed << (suit * SUITBITS);
+            }
+        }
+
+        if (count == 0) {
+            continue;
+        }
+        CardSet suitRelevant = (CardSet) played << (suit * SUITBITS);
+        if (keepsLead) {
+            tricks += count;
+            relevant |= suitRelevant;
+            if (suit == trump && count >= suitLength(leftHand, (Suit) suit) && count >= suitLength(rightHand, (Suit) suit)) {
+                trumpsDrawn = true;
+            }
+        }
+        else if (count > lastSuitTricks) {
+            lastSuitTricks = count;
+            lastSuitRelevant = suitRelevant;
+        }
+    }
+    if (crossTricks > tricks + lastSuitTricks) {
+        relevant = crossRelevant;
+        return min(crossTricks, tricksLeft);
+    }
+    relevant |= lastSuitRelevant;
+    return min(tricks + lastSuitTricks, tricksLeft);
+}
+
+/// \brief
+/// Counts the trumps held by one player of a side that are higher than every trump of the other side.
+/// The player cannot be stopped from winning a trick with each of them, as a trick to which one is
+/// played can only be taken from it by partner. The best player of the side is counted.
+///
+/// \param side int - the side, zero for north and south or one for east and west.
+/// \param relevant CardSet& - receives the lowest trump counted.
+///
+/// \return int - a lower bound on the tricks of the side.
+int DoubleDummy::trumpTricks(int side, CardSet& relevant) {
+    Holding otherTrumps = suitHolding(hands[1 - side] | hands[3 - side], (Suit) trump);
+    Holding highTrumps = (Holding) (FULLSUIT & ~((2 << (otherTrumps == 0 ? 0 : highestRank(otherTrumps))) - 1));
+    int tricks = 0;
+
+    relevant = 0;
+    for (int seat = side; seat < NUMPOSITIONS; seat += 2) {
+        Holding counted = suitHolding(hands[seat], (Suit) trump) & highTrumps;
+        if (holdingLength(counted) > tricks) {
+            tricks = holdingLength(counted);
+            relevant = (CardSet) (counted & -counted) << (trump * SUITBITS);
+        }
+    }
+    return tricks;
+}
+
+/// \brief
+/// Works out which side takes the final trick once each player holds a single card.
+///
+/// \param leader int - position leading to the last trick.
+/// \param relevant CardSet& - receives the winning card if it won on rank.
+///
+/// \return int - the position winning the last trick.
+int DoubleDummy::lastTrickWinner(int leader, CardSet& relevant) {
+    int winningSeat = leader;
+    int winningCard = __builtin_ctzll(hands[leader]);
+    bool contested = false;
+
+    for (int i = 1; i < NUMPOSITIONS; i++) {
+        int seat = (leader + i) % NUMPOSITIONS;
+        int card = __builtin_ctzll(hands[seat]);
+        if (card / SUITBITS == winningCard / SUITBITS) {
+            contested = true;
+        }
+        if (beats(card, winningCard)) {
+
+            // A trump ruffing a plain suit has not yet met another card of its suit
+            if (card / SUITBITS != winningCard / SUITBITS) {
+                contested = false;
+            }
+            winningCard = card;
+            winningSeat = seat;
+        }
+    }
+    relevant = contested ? (CardSet) 1 << winningCard : 0;
+    return winningSeat;
+}
+
+/// \brief
+/// Lists the cards worth trying for a player, leaving out all but the lowest of
+/// cards that are touching once played cards are ignored.
+///
+/// \param seat int - position of the player to play.
+/// \param cardsPlayed int - number of cards already played to the trick.
+/// \param ledSuit int - suit led to the trick.
+/// \param moves int[] - receives the bit indexes of the cards.
+///
+/// \return int - number of cards listed.
+int DoubleDummy::generateMoves(int seat, int cardsPlayed, int ledSuit, int moves[NUMTRICKS]) {
+    CardSet legal = hands[seat];
+    int numMoves = 0;
+
+    // Must follow suit when able
+    if (cardsPlayed > 0) {
+        CardSet following = legal & ((CardSet) FULLSUIT << (ledSuit * SUITBITS));
+        if (following != 0) {
+            legal = following;
+        }
+    }
+
+    // Cards on the table still separate touching cards for this trick, so only cards played
+    // in earlier tricks join runs together
+    CardSet occupied = hands[0] | hands[1] | hands[2] | hands[3] | tableCards;
+    CardSet played = ALLCARDS & ~occupied;
+    CardSet gaps = ~(legal | played);
+
+    // Keep the lowest card of each run: the carry of the addition runs up each run of played
+    // cards sitting on a gap, and a card below which lies a gap or such a run starts a new one
+    CardSet bottom = gaps << 1 & played;
+    CardSet separators = gaps | (played & ~(played + bottom));
+    CardSet candidates = legal & (separators << 1);
+
+    while (candidates != 0) {
+        moves[numMoves++] = __builtin_ctzll(candidates);
+        candidates &= candidates - 1;
+    }
+    return numMoves;
+}
+
+/// \brief
+/// Orders the listed cards so that the plays most likely to be best are tried first.
+///
+/// \param seat int - position of the player to play.
+/// \param cardsPlayed int - number of cards already played to the trick.
+/// \param ledSuit int - suit led to the trick.
+/// \param winningCard int - bit index of the card currently winning the trick.
+/// \param winningSeat int - position of the player who played the winning card.
+/// \param tricksLeft int - number of tricks still to be completed, including this one.
+/// \param moves int[] - the cards to be ordered.
+/// \param numMoves int - number of cards listed.
+void DoubleDummy::orderMoves(int seat, int cardsPlayed, int ledSuit, int winningCard, int winningSeat,
+                             int tricksLeft, int moves[NUMTRICKS], int numMoves) {
+    int scores[NUMTRICKS];
+    int partner = (seat + 2) % NUMPOSITIONS;
+    CardSet opponents = hands[(seat + 1) % NUMPOSITIONS] | hands[(seat + 3) % NUMPOSITIONS];
+    CardSet trumpMask = trump == NOTRUMP ? 0 : (CardSet) FULLSUIT << (trump * SUITBITS);
+
+    for (int i = 0; i < numMoves; i++) {
+        int card = moves[i];
+        int suit = card / SUITBITS;
+        int rank = card % SUITBITS;
+        int score;
+
+        if (cardsPlayed == 0) {
+            Holding opponentsHolding = suitHolding(opponents, (Suit) suit);
+            Holding partnerHolding = suitHolding(hands[partner], (Suit) suit);
+            score = 0;
+
+            // Cashing a winner, leading low towards partner's winner, or else leading low in a suit
+            // the opponents still have to follow
+            if (opponentsHolding == 0 || rank > highestRank(opponentsHolding)) {
+                score += 30 + rank;
+            }
+            else if (partnerHolding != 0 && highestRank(partnerHolding) > highestRank(opponentsHolding)) {
+                score += 25 - rank;
+            }
+            else {
+                score += 2 * holdingLength(opponentsHolding) - rank;
+            }
+
+            if (suit != trump && trumpMask != 0) {
+                CardSet leftHand = hands[(seat + 1) % NUMPOSITIONS];
+                CardSet rightHand = hands[(seat + 3) % NUMPOSITIONS];
+
+                // Giving partner a ruff is usually good, leading into the opponents' ruff rarely
+                if (partnerHolding == 0 && (hands[partner] & trumpMask) != 0) {
+                    score += 20;
+                }
+                if ((suitHolding(leftHand, (Suit) suit) == 0 && (leftHand & trumpMask) != 0)
+                    || (suitHolding(rightHand, (Suit) suit) == 0 && (rightHand & trumpMask) != 0)) {
+                    score -= 40;
+                }
+            }
+        }
+        else {
+            bool ruffing = suit != ledSuit && suit == trump;
+
+            // The opponent still to play after this seat, if any
+            int nextOpponent = cardsPlayed == 3 ? -1 : (seat + 1) % NUMPOSITIONS;
+
+            if (winningSeat == partner && (nextOpponent < 0 || !canBeat(nextOpponent, winningCard, ledSuit))) {
+
+                // Partner has the trick won so play low, keeping trumps
+                score = -rank - (ruffing ? 40 : 0);
+            }
+            else if (beats(card, winningCard) && winningSeat != partner) {
+                if (nextOpponent < 0 || !canBeat(nextOpponent, card, ledSuit)) {
+
+                    // Win as cheaply as possible, preferring to follow suit over ruffing
+                    score = 60 - rank - (ruffing ? 10 : 0);
+                }
+                else if (cardsPlayed == 2) {
+
+                    // Third hand high forces out the fourth hand's winner
+                    score = 20 + rank;
+                }
+                else {
+                    score = -rank - (ruffing ? 30 : 0);
+                }
+            }
+            else if (winningSeat == partner && cardsPlayed == 2 && beats(card, winningCard)
+                     && !canBeat(nextOpponent, card, ledSuit)) {
+
+                // Overtake partner when that stops the fourth hand winning
+                score = 40 - rank;
+            }
+            else {
+
+                // Cannot win so play the lowest card, discarding from outside trumps
+                score = -rank - (suit == trump ? 30 : 0);
+            }
+        }
+
+        // The last lead to succeed at the same point of the play often succeeds again
+        if (cardsPlayed == 0 && card == killers[tricksLeft][seat]) {
+            score += 40;
+        }
+        scores[i] = score;
+    }
+
+    // Insertion sort as there are never more than thirteen cards
+    for (int i = 1; i < numMoves; i++) {
+        int card = moves[i];
+        int score = scores[i];
+        int j = i - 1;
+        while (j >= 0 && scores[j] < score) {
+            moves[j + 1] = moves[j];
+            scores[j + 1] = scores[j];
+            j--;
+        }
+        moves[j + 1] = card;
+        scores[j + 1] = score;
+    }
+}
+
+/// \brief
+/// Checks whether a player still to play to the trick holds a card that would beat the given card.
+///
+/// \param seat int - position of the player still to play.
+/// \param card int - bit index of the card to be beaten.
+/// \param ledSuit int - suit led to the trick.
+///
+/// \return bool - true if the player could take the trick from the card.
+bool DoubleDummy::canBeat(int seat, int card, int ledSuit) {
+    Holding following = suitHolding(hands[seat], (Suit) ledSuit);
+    if (following != 0) {
+        return card / SUITBITS == ledSuit && highestRank(following) > card % SUITBITS;
+    }
+    if (trump == NOTRUMP) {
+        return false;
+    }
+    Holding trumps = suitHolding(hands[seat], (Suit) trump);
+    return trumps != 0 && (card / SUITBITS != trump || highestRank(trumps) > card % SUITBITS);
+}
+
+/// \brief
+/// Checks whether a card beats the card currently winning the trick.
+///
+/// \param card int - bit index of the card played.
+/// \param winningCard int - bit index of the card currently winning.
+///
+/// \return bool - true if the new card wins the trick so far.
+bool DoubleDummy::beats(int card, int winningCard) {
+    int suit = card / SUITBITS;
+    if (suit == winningCard / SUITBITS) {
+        return card > winningCard;
+    }
+    return suit == trump;
+}
+
+/// \brief
+/// Builds the transposition key of the position at the start of a trick: the length of every
+/// suit in every hand and, for each suit, the owner of each remaining card from the top down.
+///
+/// \param leader int - position leading to the trick.
+/// \param key PositionKey& - receives the key.
+void DoubleDummy::positionKey(int leader, PositionKey& key) {
+    CardSet remaining = hands[0] | hands[1] | hands[2] | hands[3];
+
+    // Positions one and three set the low owner bit, two and three the high one
+    CardSet ownerLow = hands[1] | hands[3];
+    CardSet ownerHigh = hands[2] | hands[3];
+
+    key.lengths = 0;
+    key.owners[0] = 0;
+    key.owners[1] = 0;
+    key.leader = leader;
+
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        int holding = suitHolding(remaining, (Suit) suit) >> TWO;
+        int low = compressBits(suitHolding(ownerLow, (Suit) suit) >> TWO, holding);
+        int high = compressBits(suitHolding(ownerHigh, (Suit) suit) >> TWO, holding);
+
+        // Owners are left aligned in a 26 bit field so the top cards always use the same bits
+        uint64_t owners = spreadBits(low) | spreadBits(high) << 1;
+        owners <<= 2 * (NUMTRICKS - holdingLength(holding));
+        key.owners[suit / 2] |= owners << (32 * (suit % 2));
+
+        for (int seat = 0; seat < NUMPOSITIONS; seat++) {
+            key.lengths = (key.lengths << 4) | suitLength(hands[seat], (Suit) suit);
+        }
+    }
+}
+
+/// \brief
+/// Finds the transposition table bucket holding the bounds for a position's suit lengths and leader.
+///
+/// \param key const PositionKey& - key of the position.
+/// \param create bool - whether to add the bucket if it is not yet in the table.
+///
+/// \return Bucket* - pointer to the bucket, or NULL if there is none.
+DoubleDummy::Bucket* DoubleDummy::findBucket(const PositionKey& key, bool create) {
+    uint64_t hash = (key.lengths ^ ((uint64_t) key.leader << 62)) * 0x9E3779B97F4A7C15ULL;
+    size_t mask = buckets.size() - 1;
+
+    // Open addressing, buckets from earlier generations counting as empty
+    for (size_t i = (size_t) (hash >> (64 - BUCKETBITS)); ; i = (i + 1) & mask) {
+        Bucket& bucket = buckets[i];
+        if (bucket.generation != generation) {
+            if (!create) {
+                return NULL;
+            }
+            bucket.lengths = key.lengths;
+            bucket.generation = generation;
+            bucket.leader = key.leader;
+            bucket.entries.clear();
+            numBuckets++;
+            return &bucket;
+        }
+        if (bucket.lengths == key.lengths && bucket.leader == key.leader) {
+            return &bucket;
+        }
+    }
+}
+
+/// \brief
+/// Empties the transposition table.
+void DoubleDummy::clearTable() {
+    generation++;
+    numBuckets = 0;
+    numEntries = 0;
+}
+
+/// \brief
+/// Stores a bound found by a search, keeping only the owners of cards at or above the lowest
+/// relevant card of each suit so that the bound is shared by every position that matches them.
+///
+/// \param key const PositionKey& - key of the searched position.
+/// \param relevant CardSet - cards whose ranks decided the result.
+/// \param lower int - lower bound on the tricks of the side on lead.
+/// \param upper int - upper bound on the tricks of the side on lead.
+void DoubleDummy::storeBound(const PositionKey& key, CardSet relevant, int lower, int upper) {
+    CardSet remaining = hands[0] | hands[1] | hands[2] | hands[3];
+    uint8_t depths[NUMSUITS];
+    uint64_t masks[2] = { 0, 0 };
+
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        Holding relevantHolding = suitHolding(relevant, (Suit) suit);
+        depths[suit] = 0;
+        if (relevantHolding != 0) {
+
+            // Count the remaining cards down to and including the lowest relevant one
+            Holding lowest = relevantHolding & -relevantHolding;
+            depths[suit] = holdingLength(suitHolding(remaining, (Suit) suit) & (Holding) ~(lowest - 1));
+            uint64_t fieldMask = ((uint64_t) 1 << (2 * NUMTRICKS)) - ((uint64_t) 1 << (2 * (NUMTRICKS - depths[suit])));
+            masks[suit / 2] |= fieldMask << (32 * (suit % 2));
+        }
+    }
+
+    // Start again with an empty table once it fills up
+    if (numEntries == MAXENTRIES || 4 * numBuckets >= 3 * (int) buckets.size()) {
+        clearTable();
+    }
+
+    // Merge with an entry for exactly the same cards, otherwise add a new one to the bucket
+    Bucket* bucket = findBucket(key, true);
+    Entry* entry = NULL;
+    for (size_t i = 0; i < bucket->entries.size() && entry == NULL; i++) {
+        Entry& candidate = bucket->entries[i];
+        if (candidate.masks[0] == masks[0] && candidate.masks[1] == masks[1]
+            && ((candidate.owners[0] ^ key.owners[0]) & masks[0]) == 0
+            && ((candidate.owners[1] ^ key.owners[1]) & masks[1]) == 0) {
+            entry = &candidate;
+            lower = max(lower, (int) candidate.lower);
+            upper = min(upper, (int) candidate.upper);
+        }
+    }
+    if (entry == NULL) {
+        bucket->entries.push_back(Entry());
+        entry = &bucket->entries.back();
+        numEntries++;
+    }
+
+    entry->owners[0] = key.owners[0] & masks[0];
+    entry->owners[1] = key.owners[1] & masks[1];
+    entry->masks[0] = masks[0];
+    entry->masks[1] = masks[1];
+    entry->lower = (int8_t) lower;
+    entry->upper = (int8_t) upper;
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        entry->depths[suit] = depths[suit];
+    }
+}
+
+/// \brief
+/// Converts the depths stored in an entry back into the cards of the current position they cover.
+///
+/// \param entry const Entry& - the matching entry.
+///
+/// \return CardSet - the lowest covered card of each suit.
+CardSet DoubleDummy::entryRelevant(const Entry& entry) {
+    CardSet remaining = hands[0] | hands[1] | hands[2] | hands[3];
+    CardSet relevant = 0;
+
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        Holding holding = suitHolding(remaining, (Suit) suit);
+        for (int i = 1; i < entry.depths[suit]; i++) {
+            holding ^= (Holding) (1 << highestRank(holding));
+        }
+        if (entry.depths[suit] > 0) {
+            relevant |= cardBit(highestRank(holding), (Suit) suit);
+        }
+    }
+    return relevant;
+}
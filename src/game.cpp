@@ -1,4 +1,5 @@
 #include "game.h"
+#include "profiler.h"
 
 /// This class creates a game by creating a deck and providing players with hands of cards.
 ///
@@ -14,17 +15,14 @@ Game::Game()
 }
 
 /// \brief
-/// Deletes the pointers to hand objects contained within the array before deleting the array itself.
+/// Deletes the hand objects pointed to by the array.
 Game::~Game()
 {
 
-    // Deletes each hand object for all players
+    // Deletes each hand object for all players, the array itself being part of the game
     for (int i = 0; i < NUMPOSITIONS; i++) {
         delete(hands[i]);
     }
-
-    // Deletes hands array itself
-    delete(hands);
 }
 
 /// \brief
@@ -46,9 +44,25 @@ void Game::setup(bool fromFile) {
     }
 }
 
+/// \brief
+/// Sets up the game by shuffling the deck from the random stream numbered by the deal, so that
+/// the same seed and deal number always produce the same game.
+///
+/// \param seed unsigned long long - seed of the run the deal belongs to.
+/// \param dealNumber unsigned long long - number of the deal within the run.
+void Game::setup(unsigned long long seed, unsigned long long dealNumber) {
+    deck.shuffle(seed, dealNumber);
+
+    // Clear hand objects from previous games
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        hands[i]->clear();
+    }
+}
+
 /// \brief
 /// Deals the cards to the four players by iterating through deck and adding cards to players.
 void Game::deal() {
+    PROFILE_SCOPE(DEALCOUNTER);
 
     // Finds the player to dealers left to receive first card
     int first = ((int) dealer + 1) % NUMPOSITIONS;
@@ -60,20 +74,21 @@ void Game::deal() {
 
 /// \brief
 /// Calls make bid function, from Hand class, for each player starting with dealer untill someone
-/// makes a bid other than pass.
+/// makes a bid other than pass. The result is kept as a bid code and the player who made it, and
+/// only written out as text when the game is displayed.
 void Game::auction() {
+    PROFILE_SCOPE(BIDCOUNTER);
 
     // Iterate through players and call make bid
     for (int i = (int) dealer; i < (NUMPOSITIONS + (int) dealer); i++) {
-        string bid = hands[i % NUMPOSITIONS]->makeBid();
-        if (bid != "PASS") {
-            openingBid = "Opening bid is " + bid + " made by " + PositionName(i % NUMPOSITIONS);
+        openingBid = hands[i % NUMPOSITIONS]->makeBidCode();
+        if (openingBid != PASSBID) {
+            opener = (Position) (i % NUMPOSITIONS);
 
             // Break out of loop as bid has being made
             return;
         }
     }
-    openingBid = "All hands passed";
 }
 
 /// \brief
@@ -82,17 +97,65 @@ void Game::nextDealer() {
     dealer = (Position) (((int) dealer + 1) % NUMPOSITIONS);
 }
 
+/// \brief
+/// Sets the dealer, so that a game can be dealt with the dealer its board number gives.
+///
+/// \param position Position - the player dealing.
+void Game::setDealer(Position position) {
+    dealer = position;
+}
+
+/// \brief
+/// Returns the hand held by the player at the given position.
+///
+/// \param position Position - the player whose hand is returned.
+///
+/// \return Hand* - pointer to the player's hand.
+Hand* Game::getHand(Position position) {
+    return hands[position];
+}
+
+/// \brief
+/// Returns the player dealing the current game.
+///
+/// \return Position - the dealer.
+Position Game::getDealer() {
+    return dealer;
+}
+
+/// \brief
+/// Returns the opening bid found by the last auction.
+///
+/// \return BidCode - the opening bid, or PASSBID if all hands passed.
+BidCode Game::getOpeningBid() {
+    return openingBid;
+}
+
+/// \brief
+/// Returns the player who made the opening bid in the last auction.
+///
+/// \return Position - the player opening the bidding, meaningless if all hands passed.
+Position Game::getOpener() {
+    return opener;
+}
+
 /// \brief
 /// Creates an output stream for game class by overloading << operator.
 /// This output will return a string represenation of the game including the player's
 /// names and the cards they have in their hands divided into the various suits.
 ostream& operator<<(ostream& out, Game& game) {
+    PROFILE_SCOPE(RENDERCOUNTER);
     for (int i = 0; i < NUMPOSITIONS; i++) {
         out << game.PositionName(i) << endl;
         out << *game.hands[i] << endl;
         out << endl;
     }
-    out << game.openingBid << endl;
+    if (game.openingBid != PASSBID) {
+        out << "Opening bid is " << Hand::bidName(game.openingBid) << " made by " << game.PositionName(game.opener) << endl;
+    }
+    else {
+        out << "All hands passed" << endl;
+    }
     return out;
 }
 
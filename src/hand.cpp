@@ -1,88 +1,150 @@
+#include <algorithm>
+#include "biddingsystem.h"
 #include "hand.h"
+#include "suittables.h"
 
-/// This class sets up a player hand by storing collections of cards for the four different suits.
+/// This class sets up a player hand by storing the cards held as a card set with one bit mask per suit.
+/// The suit lengths, high card points and strength are kept up to date as cards are added, and during
+/// play cards can be removed and put back in last-in first-out order, each in constant time.
 ///
 
 /// \brief
-/// Adds the first nodes of the four suit lists to an suit cards array.
-Hand::Hand() {
-
-    // Adds first node of each suit list to suitCards array
-    this->suitCards[CLUBS] = &this->c_header;
-    this->suitCards[DIAMONDS] = &this->d_header;
-    this->suitCards[HEARTS] = &this->h_header;
-    this->suitCards[SPADES] = &this->s_header;
-}
+/// Creates an empty hand.
+Hand::Hand() {}
 
 /// \brief
-/// Iterates through the suit cards array starting with each suit's first node and deletes all nodes that
-/// connect to form that suit list before moving to the next suit.
-Hand::~Hand() {
+/// Clears the hand by emptying the card set so that a new hand can be dealt.
+void Hand::clear() {
+    cards = 0;
+    handStrength = 0;
+    points = 0;
     for (int i = 0; i < NUMSUITS; i++) {
-        iteratorNode = *suitCards[i];
-        cardNode* temp;
-
-        // Iterate through nodes until last node
-        while(iteratorNode != NULL) {
-
-            // Delete nodes
-            temp = iteratorNode->next;
-            delete(iteratorNode);
-            iteratorNode = temp;
-        }
+        lengths[i] = 0;
     }
+    numRemoved = 0;
 }
 
 /// \brief
-/// Clears the lists for each suit in the hand by returning the header node for each suit to NULL.
-/// Also resets the strength of the hand as all cards have been removed.
-void Hand::clear() {
+/// Adds a card to the hand by setting its bit in the card set.
+///
+/// \param cardToAdd Card* - the card to be added to the hand.
+void Hand::addCard(Card* cardToAdd) {
+    int card = cardToAdd->getSuit() * SUITBITS + cardToAdd->getRank();
+    if (((cards >> card) & 1) == 0) {
+        insertCard(card);
+    }
+}
 
-    //Set header nodes to null so that new suit lists can be created
-    c_header = NULL;
-    d_header = NULL;
-    h_header = NULL;
-    s_header = NULL;
-    handStrength = 0;
+/// \brief
+/// Returns the cards held in the hand.
+///
+/// \return CardSet - the card set holding one bit mask per suit.
+CardSet Hand::getCards() {
+    return cards;
 }
 
 /// \brief
-/// Adds a card node to the correct suit list depening on card pointer given as input parameter
-/// (eg. clubs card adds a node to the clubs list).
+/// Removes a card from the hand as it is played, keeping the suit lengths, points and strength up
+/// to date and pushing the card onto the undo stack.
 ///
-/// \param cardToAdd Card* - used to determine which suit list the card node should be added to.
-void Hand::addCard(Card* cardToAdd) {
+/// \param card int - bit index of a card held in the hand.
+void Hand::removeCard(int card) {
+    removed[numRemoved++] = (uint8_t) card;
+    takeCard(card);
+}
 
-    // Create node with card pointer as its data variable
-    node = new cardNode;
-    node->data = cardToAdd;
+/// \brief
+/// Puts back the card most recently removed, undoing removals in the reverse order they were made.
+///
+/// \return int - bit index of the card put back.
+int Hand::restoreCard() {
+    int card = removed[--numRemoved];
+    insertCard(card);
+    return card;
+}
 
-    cardNode* header;
+/// \brief
+/// Returns the number of cards removed and not yet put back.
+///
+/// \return int - depth of the undo stack.
+int Hand::getNumRemoved() {
+    return numRemoved;
+}
 
-    switch(cardToAdd->getSuit()) {
-        case CLUBS:
-            insertCard(c_header, node);
-            header = c_header;
-            break;
-        case SPADES:
-            insertCard(s_header, node);
-            header = s_header;
-            break;
-        case HEARTS:
-            insertCard(h_header, node);
-            header = h_header;
-            break;
-        case DIAMONDS:
-            insertCard(d_header, node);
-            header = d_header;
-            break;
+/// \brief
+/// Returns the cards the player may play to a trick: the cards of the suit led if any are held,
+/// otherwise every card.
+///
+/// \param ledSuit Suit - the suit led to the trick.
+///
+/// \return CardSet - the legal cards.
+CardSet Hand::legalCards(Suit ledSuit) {
+    if (lengths[ledSuit] == 0) {
+        return cards;
     }
+    return cards & ((CardSet) FULLSUIT << (ledSuit * SUITBITS));
+}
 
-    // Calculating high card points and length points
-    checkForHighCard(cardToAdd);
-    if (suitSize(header) > 4) {
-        handStrength++;
+/// \brief
+/// Returns the number of cards held in a suit.
+///
+/// \param suit Suit - the suit to be counted.
+///
+/// \return int - number of cards in the suit.
+int Hand::getSuitLength(Suit suit) {
+    return lengths[suit];
+}
+
+/// \brief
+/// Returns the high card points of the cards held.
+///
+/// \return int - four for each ace down to one for each jack.
+int Hand::getHighCardPoints() {
+    return points;
+}
+
+/// \brief
+/// Returns the strength of the cards held as their high card points plus one length point
+/// for every card over four in a suit.
+///
+/// \return int - the high card and length points of the hand.
+int Hand::getStrength() {
+    return handStrength;
+}
+
+/// \brief
+/// Evaluates the cards held: points, losing trick count, controls, quick tricks and playing tricks.
+///
+/// \return HandEvaluation - the evaluations of the hand.
+HandEvaluation Hand::evaluate() {
+    return evaluate(cards);
+}
+
+/// \brief
+/// Combines the evaluations of two partners' hands.
+///
+/// \param first const HandEvaluation& - the evaluations of one partner's hand.
+/// \param second const HandEvaluation& - the evaluations of the other partner's hand.
+///
+/// \return PartnershipEvaluation - the evaluations of the partnership.
+PartnershipEvaluation Hand::evaluatePartnership(const HandEvaluation& first, const HandEvaluation& second) {
+    PartnershipEvaluation partnership = {};
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        int length = first.lengths[suit] + second.lengths[suit];
+
+        // Suits are taken from lowest to highest so that a higher ranking fit wins a tie
+        if (length >= partnership.fitLength) {
+            partnership.fitSuit = suit;
+            partnership.fitLength = length;
+        }
     }
+    partnership.highCardPoints = first.highCardPoints + second.highCardPoints;
+    partnership.strength = partnership.highCardPoints + first.lengthPoints + second.lengthPoints;
+    partnership.losers = first.losers + second.losers;
+    partnership.controls = first.controls + second.controls;
+    partnership.halfQuickTricks = first.halfQuickTricks + second.halfQuickTricks;
+    partnership.tricks = min(24 - partnership.losers, NUMRANKS);
+    return partnership;
 }
 
 /// \brief
@@ -90,84 +152,73 @@ void Hand::addCard(Card* cardToAdd) {
 ///
 /// \return string - the bid that the player should make.
 string Hand::makeBid() {
-    int longestNum = calculateLongestSuit();
-    bool handBalanced = calculateShape();
-
-    if (!handBalanced) {
-        if (handStrength <= 12) {
-            switch(longestNum) {
-                case 6:
-
-                    // Bid highest suit if there are two suits of size 6
-                    if (longestSuit.size() == 2) {
-                        bid = "2" + suitName(longestSuit.back());
-                        break;
-                    }
-
-                    // Passes if clubs suit is of size 6
-                    if (longestSuit.front() == 0) {
-                        bid = "PASS";
-                        break;
-                    }
-
-                    bid = "2" + suitName(longestSuit.front());
-                    break;
-                case 7:
-                    bid = "3" + suitName(longestSuit.front());
-                    break;
-                case 8:
-                    bid = "4" + suitName(longestSuit.front());
-                    break;
-                default:
-                    bid = "PASS";
-                    break;
-            }
-        }
+    bid = bidName(makeBidCode());
+    return bid;
+}
 
-        else if (handStrength <= 21) {
+/// \brief
+/// Decides what bid for the player to make by looking up their hand strength and suit lengths
+/// in the opening bid table.
+///
+/// \return BidCode - the bid that the player should make.
+BidCode Hand::makeBidCode() {
+    return openingBidCode(lengths, handStrength);
+}
 
-            // Bid the longest suit
-            if (longestSuit.size() == 1) {
-                bid = "1" + suitName(longestSuit.front());
-            }
+/// \brief
+/// Looks up the opening bid for a hand with the given suit lengths and strength in the table
+/// compiled from the active bidding system, so that hands evaluated in bulk can be bid without
+/// creating hand objects.
+///
+/// \param lengths const int[] - number of cards held in each suit, indexed by Suit.
+/// \param strength int - the high card and length points of the hand.
+///
+/// \return BidCode - the bid that the player should make.
+BidCode Hand::openingBidCode(const int lengths[NUMSUITS], int strength) {
+    return BiddingSystem::active().openingBid(lengths, strength);
+}
 
-            // Bids highest suit if two suits have a size of four or lowest
-            // suit if two suits have a size of 5 or more.
-            else {
-                if (longestNum == 4) {
-                    bid = "1" + suitName(longestSuit.front());
-                }
-                else {
-                    bid = "1" + suitName(longestSuit.back());
-                }
-            }
-        }
-        else {
-            bid = "2C";
-        }
+/// \brief
+/// Returns the name of a bid (eg. "1NT" or "PASS").
+///
+/// \param code BidCode - the bid.
+///
+/// \return string - the bid as written in the auction.
+string Hand::bidName(BidCode code) {
+    const char* strainNames[NUMSUITS + 1] = { "C", "D", "H", "S", "NT" };
+
+    if (code == PASSBID) {
+        return "PASS";
     }
+    return to_string((code - 1) / 5 + 1) + strainNames[(code - 1) % 5];
+}
 
-    else {
-        if (handStrength <= 12) {
-            bid = "PASS";
-        }
-        else if (handStrength <= 14) {
-            bidMinorSuit();
-        }
-        else if (handStrength <= 17) {
-            bid = "1NT";
-        }
-        else if (handStrength <= 19) {
-            bidMinorSuit();
-        }
-        else if (handStrength <= 21) {
-            bid = "2NT";
-        }
-        else {
-            bid = "2C";
+/// \brief
+/// Reads the name of a bid as written by bidName, in either case.
+///
+/// \param name const string& - the name, such as "1NT" or "pass".
+/// \param code BidCode& - receives the bid.
+///
+/// \return bool - true if the name is a pass or a level from 1 to 7 and a strain.
+bool Hand::parseBidName(const string& name, BidCode& code) {
+    const char* strainNames[NUMSUITS + 1] = { "C", "D", "H", "S", "NT" };
+    string upper = name;
+    transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+    if (upper == "PASS") {
+        code = PASSBID;
+        return true;
+    }
+    if (upper.size() < 2 || upper[0] < '1' || upper[0] > '7') {
+        return false;
+    }
+    for (int strain = 0; strain <= NUMSUITS; strain++) {
+        if (upper.compare(1, string::npos, strainNames[strain]) == 0) {
+            code = (upper[0] - '1') * 5 + strain + 1;
+            return true;
         }
     }
-    return bid;
+    return false;
 }
 
 /// \brief
@@ -175,60 +226,68 @@ string Hand::makeBid() {
 /// This output will return a string representation of the cards within the hand divided into each suit.
 ostream& operator << (ostream& out, Hand& hand) {
     out << "Spades\t :";
-    hand.displaySuit(out, hand.s_header);
+    hand.displaySuit(out, SPADES);
     out << endl << "Hearts\t :";
-    hand.displaySuit(out, hand.h_header);
+    hand.displaySuit(out, HEARTS);
     out << endl << "Diamonds :";
-    hand.displaySuit(out, hand.d_header);
+    hand.displaySuit(out, DIAMONDS);
     out << endl << "Clubs\t :";
-    hand.displaySuit(out, hand.c_header);
+    hand.displaySuit(out, CLUBS);
 
     return out;
 }
 
 /// \brief
-/// Checks if card has a high rank and adds points to hand strength
-/// corresponding to the rank.
+/// Puts a card into the hand and updates the features of the hand.
 ///
-/// \param cardToAdd Card* - card who's rank will be evaluated.
-void Hand::checkForHighCard(Card* cardToAdd) {
-    switch(cardToAdd->getRank()) {
-        case ACE:
-            handStrength += 4;
-            break;
-        case KING:
-            handStrength += 3;
-            break;
-        case QUEEN:
-            handStrength += 2;
-            break;
-        case JACK:
-            handStrength++;
-            break;
+/// \param card int - bit index of a card not held in the hand.
+void Hand::insertCard(int card) {
+    int suit = card / SUITBITS;
+    cards |= (CardSet) 1 << card;
+    points += cardPoints(card);
+
+    // Each card beyond the fourth of a suit is worth a length point
+    if (++lengths[suit] > 4) {
+        handStrength++;
+    }
+    handStrength += cardPoints(card);
+}
+
+/// \brief
+/// Takes a card out of the hand and updates the features of the hand.
+///
+/// \param card int - bit index of a card held in the hand.
+void Hand::takeCard(int card) {
+    int suit = card / SUITBITS;
+    cards &= ~((CardSet) 1 << card);
+    points -= cardPoints(card);
+    if (lengths[suit]-- > 4) {
+        handStrength--;
     }
+    handStrength -= cardPoints(card);
 }
 
 /// \brief
-/// Calculates the shape of the hand (balanced or unbalanced) depending on
-/// the number of cards in each different suit.
+/// Calculates whether a hand with the given suit lengths is balanced, holding two to four
+/// cards in every suit and at most one doubleton.
+///
+/// \param lengths const int[] - number of cards held in each suit, indexed by Suit.
 ///
 /// \return bool - returns true if balanced and false if not.
-bool Hand::calculateShape() {
+bool Hand::calculateShape(const int lengths[NUMSUITS]) {
     bool handBalanced = true;
     int numTwoSuits = 0;
 
     for (int i = 0; i < NUMSUITS; i++) {
-
-        // Set header to the next suit's header each time loop is entered
-        cardNode* header = *this->suitCards[(Suit) i];
+        int size = lengths[i];
 
         // Check that the suit is not less than two or greate than four in size
-        if (suitSize(header) < 2 || suitSize(header) > 4) {
+        if (size < 2 || size > 4) {
             handBalanced = false;
             break;
         }
 
-        if (suitSize(header) == 2) {
+        if (size == 2) {
             numTwoSuits++;
 
             // Checks that only zero or one suits are of size two
@@ -240,106 +299,17 @@ bool Hand::calculateShape() {
     return handBalanced;
 }
 
-/// \brief
-/// Determines how many suits are the longest and how many cards they have.
-///
-/// \return int - returns number of cards in the longest suit/s.
-int Hand::calculateLongestSuit() {
-    int longestNum = 0;
-    for (int i = 0; i < NUMSUITS; i++) {
-
-        // Set header to the next suit's header each time loop is entered
-        cardNode* header = *this->suitCards[(Suit) i];
-
-        // Does the current suit have a greater size than the current longest
-        if (longestNum < suitSize(header)) {
-            longestNum = suitSize(header);
-
-            // Clears previous longest suit and adds new one
-            longestSuit.clear();
-            longestSuit.push_back((Suit) i);
-        }
-
-        // if the current suit has the same size as the current longest
-        else if (longestNum == suitSize(header)) {
-
-            // Add to the list of longest suits
-            longestSuit.push_back((Suit) i);
-        }
-    }
-    return longestNum;
-}
-
-/// \brief
-/// Determines the number of cards in a suit by counting the nodes it a suit list.
-///
-/// \param suit_headerNode cardNode* - first node of the suit list to be calculated.
-///
-/// \return int - returns number of cards in the suit.
-int Hand::suitSize(cardNode* suit_headerNode) {
-    int num = 0;
-    iteratorNode = suit_headerNode;
-    while(iteratorNode != NULL) {
-        num++;
-        iteratorNode = iteratorNode->next;
-    }
-    return num;
-}
-
 /// \brief
 /// Creates a string representation of the cards in given suit to be passed to the hand class output stream.
+/// Cards are written from highest to lowest rank using the ranks of the suit's holding rendered at compile time.
 ///
 /// \param out ostream& - output stream to receive the output produced by this method.
-/// \param suit_headerNode cardNode* - the first node of the suit to be displayed a string.
-void Hand::displaySuit(ostream& out, cardNode* suit_headerNode) {
-    iteratorNode = suit_headerNode;
-    Card* cardPtr;
-    while(iteratorNode != NULL) {
-        out << " ";
-        cardPtr = iteratorNode->data;
-        out << *cardPtr;
-        iteratorNode = iteratorNode->next;
-    }
-}
-
-/// \brief
-/// Inserts a card node pointer to a card to the correct suit list in the correct place.
-///
-/// \param suit_headerNode cardNode*& - first node of the suit list where card is to be added.
-/// \param node cardNode* - node pointing to card to be added to list.
-void Hand::insertCard(cardNode*& suit_headerNode, cardNode* node) {
-    Card greaterThan;
-
-    // Check if suit list is not empty
-    if (suit_headerNode == NULL) {
-        suit_headerNode = node;
-        node->next = NULL;
-    }
-
-    // Check if the new node is greater than the current first node
-    else if (greaterThan(node->data, suit_headerNode->data)) {
-        node->next = suit_headerNode;
-
-        // Set new node as new first node
-        suit_headerNode = node;
-    }
-
-    else {
-        for (cardNode* temp = suit_headerNode; temp != NULL; temp = temp->next) {
-
-            // End of list has being reached
-            if (temp->next == NULL) {
-                temp->next = node;
-                node->next = NULL;
-            }
-
-            // Current node is greater than next node
-            else if (greaterThan(node->data, temp->next->data)) {
-                node->next = temp->next;
-                temp->next = node;
-                break;
-            }
-        }
+/// \param suit Suit - the suit to be displayed as a string.
+void Hand::displaySuit(ostream& out, Suit suit) {
+    const char* ranks = suitInfo(suitHolding(cards, suit)).ranks;
+    char suitChar = suitName(suit)[0];
+    for (int i = 0; ranks[i] != '\0'; i++) {
+        out << ' ' << ranks[i] << suitChar;
     }
 }
 
@@ -350,38 +320,6 @@ void Hand::insertCard(cardNode*& suit_headerNode, cardNode* node) {
 ///
 /// \return string - returns suit name as string that the suit value corresponds to.
 string Hand::suitName(int suitValue) {
-    switch(suitValue) {
-        case 0:
-            return "C";
-            break;
-        case 1:
-            return "D";
-            break;
-        case 2:
-            return "H";
-            break;
-        case 3:
-            return "S";
-            break;
-    }
-}
-
-/// \brief
-/// Bids longest of minor suits (diamonds or clubs). However if suits are both length of four bids
-/// bids diamonds and if length is three bids clubs.
-void Hand::bidMinorSuit() {
-    if (suitSize(d_header) == suitSize(c_header)) {
-        if (suitSize(d_header) == 4) {
-            bid = "1D";
-        }
-        else {
-            bid = "1C";
-        }
-    }
-    else if (suitSize(d_header) > suitSize(c_header)) {
-        bid = "1D";
-    }
-    else {
-        bid = "1C";
-    }
+    const char* suitNames[NUMSUITS] = { "C", "D", "H", "S" };
+    return suitNames[suitValue];
 }
@@ -0,0 +1,182 @@
+#include "handbatch.h"
+#include "profiler.h"
+#include "suittables.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HANDBATCH_AVX2
+#include <immintrin.h>
+#endif
+
+/// This class evaluates many hands at once, working out the high card points, length points, suit
+/// lengths and balanced flag used by Hand::makeBid for a contiguous array of card sets, or every
+/// evaluation of Hand::evaluate.
+///
+
+static_assert(sizeof(HandFeatures) == sizeof(CardSet), "hand features must fill one 64-bit lane");
+
+/// \brief
+/// Evaluates one hand at a time, looking up the features of each suit.
+///
+/// \param hands const CardSet* - the cards of each hand.
+/// \param count int - number of hands.
+/// \param features HandFeatures* - receives the features of each hand.
+static void evaluateScalar(const CardSet* hands, int count, HandFeatures* features) {
+    for (int i = 0; i < count; i++) {
+        HandFeatures& result = features[i];
+        int points = 0;
+        int lengthPoints = 0;
+        int doubletons = 0;
+        bool inRange = true;
+
+        for (int suit = 0; suit < NUMSUITS; suit++) {
+            const SuitInfo& info = suitInfo(suitHolding(hands[i], (Suit) suit));
+            int length = info.length;
+            points += info.highCardPoints;
+            result.lengths[suit] = length;
+            if (length > 4) {
+                lengthPoints += length - 4;
+            }
+
+            // Balanced hands hold two to four cards in every suit and at most one doubleton
+            inRange = inRange && length >= 2 && length <= 4;
+            doubletons += length == 2;
+        }
+        result.highCardPoints = points;
+        result.lengthPoints = lengthPoints;
+        result.balanced = inRange && doubletons <= 1;
+        result.unused = 0;
+    }
+}
+
+#ifdef HANDBATCH_AVX2
+
+/// \brief
+/// Evaluates four hands at a time with AVX2, each hand in one 64-bit lane and each suit in one
+/// 16-bit lane, finishing any hands left over one at a time.
+///
+/// \param hands const CardSet* - the cards of each hand.
+/// \param count int - number of hands.
+/// \param features HandFeatures* - receives the features of each hand.
+__attribute__((target("avx2")))
+static void evaluateVector(const CardSet* hands, int count, HandFeatures* features) {
+    const __m256i nibbleCounts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i honourPoints = _mm256_setr_epi8(0, 1, 2, 3, 3, 4, 5, 6, 4, 5, 6, 7, 7, 8, 9, 10,
+                                                  0, 1, 2, 3, 3, 4, 5, 6, 4, 5, 6, 7, 7, 8, 9, 10);
+
+    // Moves the low byte of each suit length to the first four bytes of its hand
+    const __m256i packLengths = _mm256_setr_epi8(0, 2, 4, 6, -1, -1, -1, -1, 8, 10, 12, 14, -1, -1, -1, -1,
+                                                 0, 2, 4, 6, -1, -1, -1, -1, 8, 10, 12, 14, -1, -1, -1, -1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+    const __m256i two = _mm256_set1_epi16(2);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i cards = _mm256_loadu_si256((const __m256i*) (hands + i));
+
+        // Count the bits of each byte from a table of nibble counts, then add byte pairs into suit lengths
+        __m256i lowCounts = _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(cards, lowNibbles));
+        __m256i highCounts = _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(_mm256_srli_epi16(cards, 4), lowNibbles));
+        __m256i lengths = _mm256_maddubs_epi16(_mm256_add_epi8(lowCounts, highCounts), _mm256_set1_epi8(1));
+
+        // Look up the points of each suit's jack to ace bits and add up the suits of each hand
+        __m256i honours = _mm256_and_si256(_mm256_srli_epi16(cards, JACK), _mm256_set1_epi16(0xF));
+        __m256i points = _mm256_sad_epu8(_mm256_shuffle_epi8(honourPoints, honours), zero);
+        __m256i extra = _mm256_sad_epu8(_mm256_subs_epu16(lengths, _mm256_set1_epi16(4)), zero);
+
+        // Lengths below two wrap round and fail the range test along with those above four
+        __m256i offset = _mm256_sub_epi16(lengths, two);
+        __m256i inRange = _mm256_cmpeq_epi16(_mm256_min_epu16(offset, two), offset);
+        __m256i allInRange = _mm256_cmpeq_epi64(inRange, _mm256_set1_epi64x(-1));
+        __m256i doubletons = _mm256_sad_epu8(_mm256_and_si256(_mm256_cmpeq_epi16(lengths, two), _mm256_set1_epi16(1)), zero);
+        __m256i balanced = _mm256_and_si256(_mm256_and_si256(allInRange, _mm256_cmpgt_epi64(_mm256_set1_epi64x(2), doubletons)),
+                                            _mm256_set1_epi64x(1));
+
+        __m256i packed = _mm256_or_si256(_mm256_shuffle_epi8(lengths, packLengths),
+                         _mm256_or_si256(_mm256_slli_epi64(points, 32),
+                         _mm256_or_si256(_mm256_slli_epi64(extra, 40), _mm256_slli_epi64(balanced, 48))));
+        _mm256_storeu_si256((__m256i*) (features + i), packed);
+    }
+    evaluateScalar(hands + i, count - i, features + i);
+}
+
+#endif // HANDBATCH_AVX2
+
+/// \brief
+/// Creates an evaluator using AVX2 if the processor supports it.
+///
+/// \param allowVector bool - false to always use the plain loop.
+HandBatch::HandBatch(bool allowVector) {
+    evaluator = evaluateScalar;
+    vectorized = false;
+
+#ifdef HANDBATCH_AVX2
+    if (allowVector && __builtin_cpu_supports("avx2")) {
+        evaluator = evaluateVector;
+        vectorized = true;
+    }
+#endif
+}
+
+/// \brief
+/// Evaluates an array of hands.
+///
+/// \param hands const CardSet* - the cards of each hand.
+/// \param count int - number of hands.
+/// \param features HandFeatures* - receives the features of each hand.
+void HandBatch::evaluate(const CardSet* hands, int count, HandFeatures* features) {
+    PROFILE_BATCH(EVALUATECOUNTER, count);
+    evaluator(hands, count, features);
+}
+
+/// \brief
+/// Works out every evaluation of an array of hands, making one pass over the suits of each.
+///
+/// \param hands const CardSet* - the cards of each hand.
+/// \param count int - number of hands.
+/// \param evaluations HandEvaluation* - receives the evaluations of each hand.
+void HandBatch::evaluate(const CardSet* hands, int count, HandEvaluation* evaluations) {
+    PROFILE_BATCH(EVALUATECOUNTER, count);
+    for (int i = 0; i < count; i++) {
+        evaluations[i] = Hand::evaluate(hands[i]);
+    }
+}
+
+/// \brief
+/// Combines the evaluations of the hands of whole deals into the evaluations of their partnerships.
+///
+/// \param evaluations const HandEvaluation* - the evaluations of the hands, four per deal in Position order.
+/// \param numDeals int - number of deals.
+/// \param partnerships PartnershipEvaluation* - receives north-south then east-west for each deal.
+void HandBatch::evaluatePartnerships(const HandEvaluation* evaluations, int numDeals, PartnershipEvaluation* partnerships) {
+    for (int i = 0; i < numDeals; i++) {
+        const HandEvaluation* deal = evaluations + i * 4;
+
+        // North and south sit two places apart, as do east and west
+        partnerships[i * 2] = Hand::evaluatePartnership(deal[0], deal[2]);
+        partnerships[i * 2 + 1] = Hand::evaluatePartnership(deal[1], deal[3]);
+    }
+}
+
+/// \brief
+/// Returns whether the evaluator uses AVX2.
+///
+/// \return bool - true if hands are evaluated four at a time.
+bool HandBatch::usesVector() {
+    return vectorized;
+}
+
+/// \brief
+/// Decides the opening bid of an evaluated hand with the rules of Hand::makeBid.
+///
+/// \param features const HandFeatures& - the features of the hand.
+///
+/// \return BidCode - the bid that the player should make.
+BidCode HandBatch::openingBid(const HandFeatures& features) {
+    int lengths[NUMSUITS];
+    for (int i = 0; i < NUMSUITS; i++) {
+        lengths[i] = features.lengths[i];
+    }
+    return Hand::openingBidCode(lengths, features.highCardPoints + features.lengthPoints);
+}
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include "biddingsystem.h"
+#include "dealnumber.h"
+#include "handdistribution.h"
+#include "suittables.h"
+
+/// This class counts exactly how many hands that can be dealt from the unknown cards have each suit
+/// length pattern and number of high card points, from binomial coefficients of each suit's spot
+/// cards for every set of its honours, multiplied and convolved over the suits.
+///
+
+// Highest number of points the suits' counts reach as they are convolved one suit at a time
+const int MAXCONVOLVEDHCP = NUMSUITS * MAXSUITHCP;
+
+/// \brief
+/// Creates a distribution over every hand that can be dealt from the whole pack.
+HandDistribution::HandDistribution() {
+    string error;
+    compute(0, error);
+}
+
+/// \brief
+/// Counts the hands that can be dealt from the cards not known to lie elsewhere.
+///
+/// \param known CardSet - cards held by other hands.
+/// \param error string& - receives a description of the problem if the cards cannot be used.
+///
+/// \return bool - true if at least 13 cards are unknown.
+bool HandDistribution::compute(CardSet known, string& error) {
+    known &= ALLCARDS;
+    int numUnknown = NUMCARDS - cardCount(known);
+    if (numUnknown < NUMRANKS) {
+        error = "Error: The known cards leave " + to_string(numUnknown) + " cards, too few for a hand";
+        return false;
+    }
+
+    // For each suit, the hands holding each length and number of points
+    uint64_t suitCounts[NUMSUITS][NUMRANKS + 1][MAXSUITHCP + 1] = {};
+    const Holding honourRanks = FULLSUIT & ~((1 << JACK) - 1);
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        Holding unknown = FULLSUIT & ~suitHolding(known, (Suit) suit);
+        Holding honours = unknown & honourRanks;
+        int spots = holdingLength(unknown & ~honourRanks);
+
+        // Every set of the unknown honours, including none, goes with any number of the spot cards
+        Holding held = 0;
+        do {
+            int numHonours = holdingLength(held);
+            int points = suitInfo(held).highCardPoints;
+            for (int numSpots = 0; numSpots <= spots; numSpots++) {
+                suitCounts[suit][numHonours + numSpots][points] += BINOMIALS.choose[spots][numSpots];
+            }
+            held = (held - honours) & honours;
+        } while (held != 0);
+    }
+
+    counts.assign(NUMBIDSHAPES * (MAXHCP + 1), 0);
+    for (int clubs = 0; clubs <= NUMRANKS; clubs++) {
+        for (int diamonds = 0; clubs + diamonds <= NUMRANKS; diamonds++) {
+            for (int hearts = 0; clubs + diamonds + hearts <= NUMRANKS; hearts++) {
+                int lengths[NUMSUITS] = { clubs, diamonds, hearts, NUMRANKS - clubs - diamonds - hearts };
+
+                // Add the points of one suit at a time, the hands multiplying as they combine
+                uint64_t convolved[MAXCONVOLVEDHCP + 1] = {};
+                copy(suitCounts[CLUBS][clubs], suitCounts[CLUBS][clubs] + MAXSUITHCP + 1, convolved);
+                int highest = MAXSUITHCP;
+                for (int suit = DIAMONDS; suit < NUMSUITS; suit++) {
+                    const uint64_t* suitCount = suitCounts[suit][lengths[suit]];
+                    uint64_t next[MAXCONVOLVEDHCP + 1] = {};
+                    for (int points = 0; points <= highest; points++) {
+                        if (convolved[points] == 0) {
+                            continue;
+                        }
+                        for (int suitPoints = 0; suitPoints <= MAXSUITHCP; suitPoints++) {
+                            next[points + suitPoints] += convolved[points] * suitCount[suitPoints];
+                        }
+                    }
+                    highest += MAXSUITHCP;
+                    copy(next, next + highest + 1, convolved);
+                }
+
+                int shapeCode = (clubs * 14 + diamonds) * 14 + hearts;
+                copy(convolved, convolved + MAXHCP + 1, counts.begin() + shapeCode * (MAXHCP + 1));
+            }
+        }
+    }
+    numHands = BINOMIALS.choose[numUnknown][NUMRANKS];
+    return true;
+}
+
+/// \brief
+/// Returns the number of hands counted.
+///
+/// \return uint64_t - the number of ways of choosing 13 of the unknown cards.
+uint64_t HandDistribution::getNumHands() {
+    return numHands;
+}
+
+/// \brief
+/// Returns the number of hands with the given suit lengths and high card points.
+///
+/// \param lengths const int[] - cards held in each suit, indexed by Suit.
+/// \param highCardPoints int - the high card points.
+///
+/// \return uint64_t - count of hands.
+uint64_t HandDistribution::getCount(const int lengths[NUMSUITS], int highCardPoints) {
+    if (lengths[CLUBS] + lengths[DIAMONDS] + lengths[HEARTS] + lengths[SPADES] != NUMRANKS
+        || *min_element(lengths, lengths + NUMSUITS) < 0 || highCardPoints < 0 || highCardPoints > MAXHCP) {
+        return 0;
+    }
+    int shapeCode = (lengths[CLUBS] * 14 + lengths[DIAMONDS]) * 14 + lengths[HEARTS];
+    return counts[shapeCode * (MAXHCP + 1) + highCardPoints];
+}
+
+/// \brief
+/// Counts the hands holding each number of high card points.
+///
+/// \param pointCounts vector<uint64_t>& - receives the counts, indexed by points from 0 to MAXHCP.
+/// \param bid int - the opening bid the hands must make, or ANYBID.
+void HandDistribution::countPoints(vector<uint64_t>& pointCounts, int bid) {
+    pointCounts.assign(MAXHCP + 1, 0);
+    int lengths[NUMSUITS];
+    for (int shapeCode = 0; shapeCode < NUMBIDSHAPES; shapeCode++) {
+        if (!shapeLengths(shapeCode, lengths)) {
+            continue;
+        }
+        for (int points = 0; points <= MAXHCP; points++) {
+            if (makesBid(lengths, points, bid)) {
+                pointCounts[points] += counts[shapeCode * (MAXHCP + 1) + points];
+            }
+        }
+    }
+}
+
+/// \brief
+/// Counts the hands holding each number of cards in a suit.
+///
+/// \param suit Suit - the suit.
+/// \param lengthCounts vector<uint64_t>& - receives the counts, indexed by length from 0 to 13.
+/// \param bid int - the opening bid the hands must make, or ANYBID.
+void HandDistribution::countLengths(Suit suit, vector<uint64_t>& lengthCounts, int bid) {
+    lengthCounts.assign(NUMRANKS + 1, 0);
+    int lengths[NUMSUITS];
+    for (int shapeCode = 0; shapeCode < NUMBIDSHAPES; shapeCode++) {
+        if (!shapeLengths(shapeCode, lengths)) {
+            continue;
+        }
+        for (int points = 0; points <= MAXHCP; points++) {
+            if (makesBid(lengths, points, bid)) {
+                lengthCounts[lengths[suit]] += counts[shapeCode * (MAXHCP + 1) + points];
+            }
+        }
+    }
+}
+
+/// \brief
+/// Counts the hands of each suit length pattern, the lengths written longest first whatever
+/// their suits (eg. "4-4-3-2").
+///
+/// \param patternCounts map<string, uint64_t>& - receives the counts of the patterns held by any hand.
+/// \param bid int - the opening bid the hands must make, or ANYBID.
+void HandDistribution::countPatterns(map<string, uint64_t>& patternCounts, int bid) {
+    patternCounts.clear();
+    int lengths[NUMSUITS];
+    for (int shapeCode = 0; shapeCode < NUMBIDSHAPES; shapeCode++) {
+        if (!shapeLengths(shapeCode, lengths)) {
+            continue;
+        }
+        uint64_t total = 0;
+        for (int points = 0; points <= MAXHCP; points++) {
+            if (makesBid(lengths, points, bid)) {
+                total += counts[shapeCode * (MAXHCP + 1) + points];
+            }
+        }
+        if (total == 0) {
+            continue;
+        }
+
+        int sorted[NUMSUITS];
+        copy(lengths, lengths + NUMSUITS, sorted);
+        sort(sorted, sorted + NUMSUITS, greater<int>());
+        string pattern = to_string(sorted[0]);
+        for (int i = 1; i < NUMSUITS; i++) {
+            pattern += "-" + to_string(sorted[i]);
+        }
+        patternCounts[pattern] += total;
+    }
+}
+
+/// \brief
+/// Counts the hands making each opening bid by the active bidding system.
+///
+/// \param bidCounts vector<uint64_t>& - receives the counts, indexed by BidCode.
+void HandDistribution::countBids(vector<uint64_t>& bidCounts) {
+    bidCounts.assign(NUMBIDCODES, 0);
+    int lengths[NUMSUITS];
+    for (int shapeCode = 0; shapeCode < NUMBIDSHAPES; shapeCode++) {
+        if (!shapeLengths(shapeCode, lengths)) {
+            continue;
+        }
+        int lengthPoints = 0;
+        for (int suit = 0; suit < NUMSUITS; suit++) {
+            lengthPoints += max(lengths[suit] - 4, 0);
+        }
+        for (int points = 0; points <= MAXHCP; points++) {
+            bidCounts[Hand::openingBidCode(lengths, points + lengthPoints)] += counts[shapeCode * (MAXHCP + 1) + points];
+        }
+    }
+}
+
+/// \brief
+/// Works out the suit lengths of a shape code.
+///
+/// \param shapeCode int - the shape code, (clubs * 14 + diamonds) * 14 + hearts.
+/// \param lengths int[] - receives the cards held in each suit.
+///
+/// \return bool - false if the code stands for more than 13 cards.
+bool HandDistribution::shapeLengths(int shapeCode, int lengths[NUMSUITS]) {
+    lengths[CLUBS] = shapeCode / (14 * 14);
+    lengths[DIAMONDS] = shapeCode / 14 % 14;
+    lengths[HEARTS] = shapeCode % 14;
+    lengths[SPADES] = NUMRANKS - lengths[CLUBS] - lengths[DIAMONDS] - lengths[HEARTS];
+    return lengths[SPADES] >= 0;
+}
+
+/// \brief
+/// Decides whether hands with the given suit lengths and high card points make an opening bid.
+///
+/// \param lengths const int[] - cards held in each suit, indexed by Suit.
+/// \param highCardPoints int - the high card points.
+/// \param bid int - the opening bid, or ANYBID.
+///
+/// \return bool - true if the hands open with the bid, or the bid is ANYBID.
+bool HandDistribution::makesBid(const int lengths[NUMSUITS], int highCardPoints, int bid) {
+    if (bid == ANYBID) {
+        return true;
+    }
+    int strength = highCardPoints;
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        strength += max(lengths[suit] - 4, 0);
+    }
+    return Hand::openingBidCode(lengths, strength) == bid;
+}
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "dealnumber.h"
+#include "layoutenumerator.h"
+
+/// This class visits every way the cards of two unknown hands can lie once the other two hands are known,
+/// optionally with the suit lengths of the first unknown hand fixed.
+///
+
+/// \brief
+/// Sets up an enumeration of the layouts of two unknown hands.
+///
+/// \param deal const CardSet[] - the cards held by each position, only those of the two known positions being used.
+/// \param first Position - the first unknown position.
+/// \param second Position - the second unknown position.
+/// \param error string& - receives a description of the problem if the hands cannot be used.
+///
+/// \return bool - true if the known hands hold 13 different cards each.
+bool LayoutEnumerator::setup(const CardSet deal[NUMPOSITIONS], Position first, Position second, string& error) {
+    if (first == second) {
+        error = "Error: The two unknown hands must be different positions";
+        return false;
+    }
+    this->first = first;
+    this->second = second;
+
+    CardSet seen = 0;
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        known[i] = (i == first || i == second) ? 0 : deal[i];
+        if (i != first && i != second && (cardCount(known[i]) != NUMRANKS || (seen & known[i]) != 0)) {
+            error = "Error: Each known hand must hold 13 cards not held by the other";
+            return false;
+        }
+        seen |= known[i];
+    }
+    unknown = ALLCARDS & ~seen;
+
+    // Without lengths all 26 unknown cards make one pool
+    Pool& pool = pools[0];
+    pool.size = 0;
+    for (CardSet cards = unknown; cards != 0; cards &= cards - 1) {
+        pool.cards[pool.size++] = __builtin_ctzll(cards);
+    }
+    pool.choose = NUMRANKS;
+    pool.count = BINOMIALS.choose[pool.size][pool.choose];
+    numPools = 1;
+    numLayouts = pool.count;
+    return true;
+}
+
+/// \brief
+/// Fixes the number of cards the first unknown position holds in each suit.
+///
+/// \param lengths const int[] - cards held in each suit, clubs first.
+/// \param error string& - receives a description of the problem if the lengths cannot be held.
+///
+/// \return bool - true if the lengths add up to 13 and each suit has enough unknown cards.
+bool LayoutEnumerator::setLengths(const int lengths[NUMSUITS], string& error) {
+    int total = 0;
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        if (lengths[suit] < 0 || lengths[suit] > suitLength(unknown, (Suit) suit)) {
+            error = "Error: The unknown hands do not hold that many cards of a suit";
+            return false;
+        }
+        total += lengths[suit];
+    }
+    if (total != NUMRANKS) {
+        error = "Error: The suit lengths must add up to 13";
+        return false;
+    }
+
+    numLayouts = 1;
+    for (int suit = 0; suit < NUMSUITS; suit++) {
+        Pool& pool = pools[suit];
+        pool.size = 0;
+        for (CardSet cards = unknown & ((CardSet) FULLSUIT << (suit * SUITBITS)); cards != 0; cards &= cards - 1) {
+            pool.cards[pool.size++] = __builtin_ctzll(cards);
+        }
+        pool.choose = lengths[suit];
+        pool.count = BINOMIALS.choose[pool.size][pool.choose];
+        numLayouts *= pool.count;
+    }
+    numPools = NUMSUITS;
+    return true;
+}
+
+/// \brief
+/// Returns the number of layouts the enumeration visits.
+///
+/// \return long long - count of layouts.
+long long LayoutEnumerator::getNumLayouts() {
+    return numLayouts;
+}
+
+/// \brief
+/// Visits every layout, splitting the enumeration into one contiguous range per visitor and
+/// running each range on its own thread.
+///
+/// \param visitors vector<LayoutVisitor*>& - one visitor for each thread.
+void LayoutEnumerator::run(vector<LayoutVisitor*>& visitors) {
+    vector<thread> workers;
+    long long numThreads = visitors.size();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    for (long long i = 0; i < numThreads; i++) {
+        workers.push_back(thread(&LayoutEnumerator::enumerate, this, numLayouts * i / numThreads,
+                                 numLayouts * (i + 1) / numThreads, visitors[i]));
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    layoutsPerSecond = numLayouts / max(elapsed.count(), 1e-9);
+}
+
+/// \brief
+/// Returns the throughput of the last run.
+///
+/// \return double - layouts visited per second.
+double LayoutEnumerator::getLayoutsPerSecond() {
+    return layoutsPerSecond;
+}
+
+/// \brief
+/// Visits the layouts in one range of the enumeration.
+///
+/// \param firstIndex long long - index of the first layout visited.
+/// \param lastIndex long long - index after the last layout visited.
+/// \param visitor LayoutVisitor* - receives the layouts.
+void LayoutEnumerator::enumerate(long long firstIndex, long long lastIndex, LayoutVisitor* visitor) {
+    if (firstIndex >= lastIndex) {
+        return;
+    }
+
+    // Build the first layout of the range from scratch
+    long long digits[NUMSUITS];
+    uint32_t chosen[NUMSUITS];
+    LayoutState layout;
+    grayDigits(firstIndex, digits);
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        layout.hands[i] = known[i];
+    }
+    for (int p = 0; p < numPools; p++) {
+        chosen[p] = revolvingDoor(digits[p], pools[p].size, pools[p].choose);
+        for (int place = 0; place < pools[p].size; place++) {
+            Position holder = ((chosen[p] >> place) & 1) ? first : second;
+            layout.hands[holder] |= (CardSet) 1 << pools[p].cards[place];
+        }
+    }
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        for (int suit = 0; suit < NUMSUITS; suit++) {
+            layout.lengths[i][suit] = suitLength(layout.hands[i], (Suit) suit);
+        }
+        layout.highCardPoints[i] = highCardPoints(layout.hands[i]);
+    }
+    layout.index = firstIndex;
+    visitor->visit(layout);
+
+    // Each later layout moves one card from each unknown hand to the other
+    for (long long index = firstIndex + 1; index < lastIndex; index++) {
+        long long next[NUMSUITS];
+        grayDigits(index, next);
+        int p = 0;
+        while (next[p] == digits[p]) {
+            p++;
+        }
+        digits[p] = next[p];
+
+        uint32_t changed = revolvingDoor(digits[p], pools[p].size, pools[p].choose);
+        int joining = pools[p].cards[__builtin_ctz(changed & ~chosen[p])];
+        int leaving = pools[p].cards[__builtin_ctz(chosen[p] & ~changed)];
+        chosen[p] = changed;
+
+        CardSet exchange = ((CardSet) 1 << joining) | ((CardSet) 1 << leaving);
+        layout.hands[first] ^= exchange;
+        layout.hands[second] ^= exchange;
+        layout.lengths[first][joining / SUITBITS]++;
+        layout.lengths[first][leaving / SUITBITS]--;
+        layout.lengths[second][joining / SUITBITS]--;
+        layout.lengths[second][leaving / SUITBITS]++;
+        int points = cardPoints(joining) - cardPoints(leaving);
+        layout.highCardPoints[first] += points;
+        layout.highCardPoints[second] -= points;
+        layout.index = index;
+        visitor->visit(layout);
+    }
+}
+
+/// \brief
+/// Works out the place of each pool in its revolving door order for a layout. The first pool is the
+/// lowest digit, and each digit runs backwards whenever the digits above it make an odd number.
+///
+/// \param index long long - index of the layout.
+/// \param digits long long[] - receives the place of each pool.
+void LayoutEnumerator::grayDigits(long long index, long long digits[NUMSUITS]) {
+    for (int p = 0; p < numPools; p++) {
+        long long place = index % pools[p].count;
+        index /= pools[p].count;
+        digits[p] = (index % 2 == 0) ? place : pools[p].count - 1 - place;
+    }
+}
+
+/// \brief
+/// Finds the combination at the given place of the revolving door order, in which consecutive combinations
+/// differ by one item leaving and one joining. Combinations are ordered by their highest item, and those
+/// sharing a highest item c follow the order of the rest reversed, so the combination with highest item c
+/// at place r has the rest at place C(c + 1, k) - 1 - r of the order of k - 1 items.
+///
+/// \param number long long - place in the order.
+/// \param size int - number of items to choose from.
+/// \param choose int - number of items chosen.
+///
+/// \return uint32_t - bit n is set when item n is chosen.
+uint32_t LayoutEnumerator::revolvingDoor(long long number, int size, int choose) {
+    uint32_t chosen = 0;
+    int item = size;
+    uint64_t place = number;
+    for (int k = choose; k >= 1; k--) {
+        do {
+            item--;
+        } while (BINOMIALS.choose[item][k] > place);
+        chosen |= (uint32_t) 1 << item;
+        place = BINOMIALS.choose[item + 1][k] - 1 - place;
+    }
+    return chosen;
+}
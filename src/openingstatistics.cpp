@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "bulkdealer.h"
+#include "openingstatistics.h"
+
+/// This class deals a large number of games across several threads, holds the auction of each and counts
+/// how often each opening bid is made, by dealer, seat, opener's high card points and opener's shape.
+///
+
+/// Normal deviate giving a 95% confidence interval.
+const double CONFIDENCEZ = 1.96;
+
+/// \brief
+/// Works out the Wilson score interval of a proportion, which stays inside 0 to 1 and is sound for
+/// counts of zero and for proportions close to 0 or 1.
+///
+/// \param count long long - number of times the event happened.
+/// \param total long long - number of trials.
+/// \param low double& - receives the lower end of the interval.
+/// \param high double& - receives the upper end of the interval.
+static void wilsonInterval(long long count, long long total, double& low, double& high) {
+    if (total == 0) {
+        low = 0;
+        high = 1;
+        return;
+    }
+    double n = (double) total;
+    double p = count / n;
+    double z2 = CONFIDENCEZ * CONFIDENCEZ;
+    double centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+    double halfWidth = CONFIDENCEZ * sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+    low = max(0.0, centre - halfWidth);
+    high = min(1.0, centre + halfWidth);
+}
+
+/// \brief
+/// Formats a proportion as a percentage followed by the half width of its confidence interval.
+///
+/// \param count long long - number of times the event happened.
+/// \param total long long - number of trials.
+///
+/// \return string - the percentage, such as "12.345 +-0.020".
+static string percentage(long long count, long long total) {
+    double low;
+    double high;
+    wilsonInterval(count, total, low, high);
+    ostringstream text;
+    text << fixed << setprecision(3) << setw(7) << (total > 0 ? 100.0 * count / total : 0)
+         << " +-" << setw(5) << left << 50 * (high - low);
+    return text.str();
+}
+
+/// \brief
+/// Sets up a run over the given number of deals.
+///
+/// \param numDeals long long - total number of deals to be bid.
+/// \param seed unsigned long long - seed from which every deal's random stream is derived.
+/// \param numThreads int - number of worker threads dealing and bidding.
+OpeningStatistics::OpeningStatistics(long long numDeals, unsigned long long seed, int numThreads) :
+    totals(1) {
+    this->numDeals = numDeals;
+    this->seed = seed;
+    this->numThreads = numThreads;
+}
+
+/// \brief
+/// Deals and bids every game on the worker threads and adds up their counts.
+void OpeningStatistics::run() {
+    vector<thread> workers;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(thread(&OpeningStatistics::worker, this, i));
+    }
+    for (int i = 0; i < numThreads; i++) {
+        workers[i].join();
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    dealsPerSecond = numDeals / max(elapsed.count(), 1e-9);
+}
+
+/// \brief
+/// Returns the throughput of the last run.
+///
+/// \return double - deals bid per second.
+double OpeningStatistics::getDealsPerSecond() {
+    return dealsPerSecond;
+}
+
+/// \brief
+/// Returns the shape class of a hand from its suit lengths.
+///
+/// \param lengths const int[] - number of cards held in each suit.
+///
+/// \return ShapeClass - the kind of shape.
+ShapeClass OpeningStatistics::shapeClass(const int lengths[NUMSUITS]) {
+    int sorted[NUMSUITS];
+    copy(lengths, lengths + NUMSUITS, sorted);
+    sort(sorted, sorted + NUMSUITS, greater<int>());
+
+    if (sorted[0] <= 5 && sorted[2] == 3 && sorted[3] >= 2) {
+        return BALANCEDSHAPE;
+    }
+    if (sorted[0] <= 6 && sorted[2] == 2 && sorted[3] == 2) {
+        return SEMIBALANCEDSHAPE;
+    }
+    if (sorted[2] >= 4) {
+        return THREESUITEDSHAPE;
+    }
+    if (sorted[1] >= 4) {
+        return TWOSUITEDSHAPE;
+    }
+    return ONESUITEDSHAPE;
+}
+
+/// \brief
+/// Returns the range a count of high card points falls in.
+///
+/// \param points int - high card points held.
+///
+/// \return int - index of the range, from 0 for up to 9 points to NUMHCPBUCKETS - 1 for 22 or more.
+int OpeningStatistics::hcpBucket(int points) {
+    const int lowestPoints[NUMHCPBUCKETS] = { 0, 10, 12, 15, 18, 20, 22 };
+    int bucket = NUMHCPBUCKETS - 1;
+    while (points < lowestPoints[bucket]) {
+        bucket--;
+    }
+    return bucket;
+}
+
+/// \brief
+/// Deals and bids every chunk belonging to one worker thread, then adds its counts to the totals.
+///
+/// \param threadIndex int - index of the worker, which handles every chunk equal to it modulo the thread count.
+void OpeningStatistics::worker(int threadIndex) {
+    Game game;
+    vector<Histogram> counts(1);
+    Histogram& histogram = counts[0];
+    long long numChunks = (numDeals + DEALSPERCHUNK - 1) / DEALSPERCHUNK;
+
+    for (long long chunk = threadIndex; chunk < numChunks; chunk += numThreads) {
+        long long lastDeal = min((chunk + 1) * DEALSPERCHUNK, numDeals);
+        for (long long deal = chunk * DEALSPERCHUNK; deal < lastDeal; deal++) {
+            Position dealer = (Position) (deal % NUMPOSITIONS);
+            game.setDealer(dealer);
+            game.setup(seed, deal);
+            game.deal();
+            game.auction();
+
+            BidCode bid = game.getOpeningBid();
+            if (bid == PASSBID) {
+                histogram.passedOut[dealer]++;
+                continue;
+            }
+            Position opener = game.getOpener();
+            CardSet cards = game.getHand(opener)->getCards();
+            int lengths[NUMSUITS];
+            for (int suit = 0; suit < NUMSUITS; suit++) {
+                lengths[suit] = suitLength(cards, (Suit) suit);
+            }
+            int seat = (opener - dealer + NUMPOSITIONS) % NUMPOSITIONS;
+            histogram.opened[dealer][seat][bid][hcpBucket(highCardPoints(cards))][shapeClass(lengths)]++;
+        }
+    }
+
+    // Merge once at the end so the workers never touch shared counts while dealing
+    lock_guard<mutex> guard(totalsLock);
+    totals[0] += histogram;
+}
+
+/// \brief
+/// Adds the counts of another histogram to these.
+///
+/// \param other const Histogram& - the counts to add.
+///
+/// \return Histogram& - this histogram.
+OpeningStatistics::Histogram& OpeningStatistics::Histogram::operator+=(const Histogram& other) {
+
+    // The opened counts are one array of long longs, so they are added as a single run
+    long long* total = &opened[0][0][0][0][0];
+    const long long* own = &other.opened[0][0][0][0][0];
+    for (size_t i = 0; i < sizeof(opened) / sizeof(long long); i++) {
+        total[i] += own[i];
+    }
+    for (int dealer = 0; dealer < NUMPOSITIONS; dealer++) {
+        passedOut[dealer] += other.passedOut[dealer];
+    }
+    return *this;
+}
+
+/// \brief
+/// Writes the frequency tables, each percentage given with its 95% confidence interval.
+///
+/// \param out ostream& - output stream receiving the tables.
+void OpeningStatistics::print(ostream& out) {
+    const char* positionNames[NUMPOSITIONS] = { "North", "East", "South", "West" };
+    const char* hcpNames[NUMHCPBUCKETS] = { "0-9", "10-11", "12-14", "15-17", "18-19", "20-21", "22+" };
+    const char* shapeNames[NUMSHAPECLASSES] = { "Balanced", "Semi-bal", "1-suited", "2-suited", "3-suited" };
+    const int column = 16;
+
+    // Collapse the histogram into the tables' margins
+    long long bids[NUMBIDCODES] = { 0 };
+    long long bySeat[NUMBIDCODES][NUMPOSITIONS] = { { 0 } };
+    long long byHcp[NUMBIDCODES][NUMHCPBUCKETS] = { { 0 } };
+    long long byShape[NUMBIDCODES][NUMSHAPECLASSES] = { { 0 } };
+    long long byDealer[NUMPOSITIONS][NUMPOSITIONS] = { { 0 } };
+    long long dealerDeals[NUMPOSITIONS] = { 0 };
+    long long passedOut = 0;
+    Histogram& histogram = totals[0];
+
+    for (int dealer = 0; dealer < NUMPOSITIONS; dealer++) {
+        passedOut += histogram.passedOut[dealer];
+        dealerDeals[dealer] += histogram.passedOut[dealer];
+        for (int seat = 0; seat < NUMPOSITIONS; seat++) {
+            for (int bid = 0; bid < NUMBIDCODES; bid++) {
+                for (int hcp = 0; hcp < NUMHCPBUCKETS; hcp++) {
+                    for (int shape = 0; shape < NUMSHAPECLASSES; shape++) {
+                        long long count = histogram.opened[dealer][seat][bid][hcp][shape];
+                        bids[bid] += count;
+                        bySeat[bid][seat] += count;
+                        byHcp[bid][hcp] += count;
+                        byShape[bid][shape] += count;
+                        byDealer[dealer][(dealer + seat) % NUMPOSITIONS] += count;
+                        dealerDeals[dealer] += count;
+                    }
+                }
+            }
+        }
+    }
+
+    out << "Opening bids over " << numDeals << " deals (% of deals, 95% interval)" << endl;
+    for (int bid = 1; bid < NUMBIDCODES; bid++) {
+        if (bids[bid] > 0) {
+            double low;
+            double high;
+            wilsonInterval(bids[bid], numDeals, low, high);
+            out << setw(6) << Hand::bidName(bid) << setw(14) << bids[bid] << fixed << setprecision(4)
+                << setw(10) << 100.0 * bids[bid] / numDeals << "  [" << 100 * low << ", " << 100 * high << "]" << endl;
+        }
+    }
+    double low;
+    double high;
+    wilsonInterval(passedOut, numDeals, low, high);
+    out << setw(6) << "Pass" << setw(14) << passedOut << fixed << setprecision(4) << setw(10) << 100.0 * passedOut / max(numDeals, 1LL)
+        << "  [" << 100 * low << ", " << 100 * high << "]" << endl << endl;
+
+    out << "Opening bid by seat (% of deals)" << endl << setw(6) << "";
+    for (int seat = 0; seat < NUMPOSITIONS; seat++) {
+        out << setw(column) << (to_string(seat + 1) + (seat == 0 ? "st" : seat == 1 ? "nd" : seat == 2 ? "rd" : "th"));
+    }
+    out << endl;
+    for (int bid = 1; bid < NUMBIDCODES; bid++) {
+        if (bids[bid] > 0) {
+            out << setw(6) << Hand::bidName(bid);
+            for (int seat = 0; seat < NUMPOSITIONS; seat++) {
+                out << setw(column) << percentage(bySeat[bid][seat], numDeals);
+            }
+            out << endl;
+        }
+    }
+    out << endl;
+
+    out << "Opener by dealer (% of that dealer's deals)" << endl << setw(6) << "";
+    for (int position = 0; position < NUMPOSITIONS; position++) {
+        out << setw(column) << positionNames[position];
+    }
+    out << setw(column) << "Passed out" << endl;
+    for (int dealer = 0; dealer < NUMPOSITIONS; dealer++) {
+        out << setw(6) << positionNames[dealer];
+        for (int position = 0; position < NUMPOSITIONS; position++) {
+            out << setw(column) << percentage(byDealer[dealer][position], dealerDeals[dealer]);
+        }
+        out << setw(column) << percentage(histogram.passedOut[dealer], dealerDeals[dealer]) << endl;
+    }
+    out << endl;
+
+    out << "Opener's high card points by bid (% of that bid)" << endl << setw(6) << "";
+    for (int hcp = 0; hcp < NUMHCPBUCKETS; hcp++) {
+        out << setw(column) << hcpNames[hcp];
+    }
+    out << endl;
+    for (int bid = 1; bid < NUMBIDCODES; bid++) {
+        if (bids[bid] > 0) {
+            out << setw(6) << Hand::bidName(bid);
+            for (int hcp = 0; hcp < NUMHCPBUCKETS; hcp++) {
+                out << setw(column) << percentage(byHcp[bid][hcp], bids[bid]);
+            }
+            out << endl;
+        }
+    }
+    out << endl;
+
+    out << "Opener's shape by bid (% of that bid)" << endl << setw(6) << "";
+    for (int shape = 0; shape < NUMSHAPECLASSES; shape++) {
+        out << setw(column) << shapeNames[shape];
+    }
+    out << endl;
+    for (int bid = 1; bid < NUMBIDCODES; bid++) {
+        if (bids[bid] > 0) {
+            out << setw(6) << Hand::bidName(bid);
+            for (int shape = 0; shape < NUMSHAPECLASSES; shape++) {
+                out << setw(column) << percentage(byShape[bid][shape], bids[bid]);
+            }
+            out << endl;
+        }
+    }
+}
@@ -0,0 +1,276 @@
+#include "playengine.h"
+
+/// This class plays out a deal trick by trick with each player choosing cards by a cheap policy
+/// rather than by search, so that the tricks of a contract can be estimated over very large samples.
+///
+
+/// \brief
+/// Returns the cards of one suit, or no cards for no trumps.
+///
+/// \param suit int - a Suit value, or NOTRUMP.
+///
+/// \return CardSet - every card of the suit.
+static inline CardSet suitCards(int suit) {
+    return suit == NOTRUMP ? 0 : (CardSet) FULLSUIT << (suit * SUITBITS);
+}
+
+/// One card of each suit at rank zero, shifted up to pick out every card of a rank.
+const CardSet RANKCARDS = 0x0001000100010001ULL;
+
+/// \brief
+/// Returns the ranks held in any suit of a set.
+///
+/// \param cards CardSet - the set of cards.
+///
+/// \return Holding - bit n is set when a card of rank n is held in some suit.
+static inline Holding ranksHeld(CardSet cards) {
+    return (Holding) (cards | cards >> SUITBITS | cards >> (2 * SUITBITS) | cards >> (3 * SUITBITS));
+}
+
+/// \brief
+/// Finds the lowest ranking card of a set, taking the lowest suit when several suits share that rank.
+///
+/// \param cards CardSet - a non-empty set of cards.
+///
+/// \return int - bit index of the card.
+static inline int lowestCard(CardSet cards) {
+    return __builtin_ctzll(cards & (RANKCARDS << __builtin_ctz(ranksHeld(cards))));
+}
+
+/// \brief
+/// Finds the highest ranking card of a set, taking the highest suit when several suits share that rank.
+///
+/// \param cards CardSet - a non-empty set of cards.
+///
+/// \return int - bit index of the card.
+static inline int highestCard(CardSet cards) {
+    return 63 - __builtin_clzll(cards & (RANKCARDS << highestRank(ranksHeld(cards))));
+}
+
+/// \brief
+/// Finds the lowest card to throw away, keeping trumps while there is anything else.
+///
+/// \param cards CardSet - a non-empty set of cards.
+/// \param trump int - trump suit as a Suit value, or NOTRUMP.
+///
+/// \return int - bit index of the card.
+static int lowestDiscard(CardSet cards, int trump) {
+    CardSet sideCards = cards & ~suitCards(trump);
+    return lowestCard(sideCards != 0 ? sideCards : cards);
+}
+
+/// \brief
+/// Creates an engine with every player using the second-hand-low, third-hand-high heuristics.
+PlayEngine::PlayEngine() {
+    setPolicy(heuristicPolicy);
+}
+
+/// \brief
+/// Sets the policy used by every player.
+///
+/// \param policy PlayPolicy - the way cards are chosen.
+void PlayEngine::setPolicy(PlayPolicy policy) {
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        policies[i] = policy;
+    }
+}
+
+/// \brief
+/// Sets the policy used by one player.
+///
+/// \param position Position - the player.
+/// \param policy PlayPolicy - the way the player chooses cards.
+void PlayEngine::setPolicy(Position position, PlayPolicy policy) {
+    policies[position] = policy;
+}
+
+/// \brief
+/// Plays out a dealt game for the given strain and opening leader.
+///
+/// \param game Game& - a game whose cards have been dealt.
+/// \param strain int - trump suit as a Suit value, or NOTRUMP.
+/// \param leader Position - the player making the opening lead.
+/// \param randomizer Random& - source of the random choices made by the policies.
+///
+/// \return int - tricks taken by the opening leader and their partner.
+int PlayEngine::playOut(Game& game, int strain, Position leader, Random& randomizer) {
+    CardSet deal[NUMPOSITIONS];
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        deal[i] = game.getHand((Position) i)->getCards();
+    }
+    return playOut(deal, strain, leader, randomizer);
+}
+
+/// \brief
+/// Plays out a deal given as four card sets of equal size for the given strain and opening leader.
+///
+/// \param deal const CardSet[] - the cards held by each position.
+/// \param strain int - trump suit as a Suit value, or NOTRUMP.
+/// \param leader Position - the player making the opening lead.
+/// \param randomizer Random& - source of the random choices made by the policies.
+///
+/// \return int - tricks taken by the opening leader and their partner.
+int PlayEngine::playOut(const CardSet deal[NUMPOSITIONS], int strain, Position leader, Random& randomizer) {
+    PlayState state;
+    for (int i = 0; i < NUMPOSITIONS; i++) {
+        state.hands[i] = deal[i];
+    }
+    state.trump = strain;
+
+    int numTricks = cardCount(deal[leader]);
+    int trickLeader = leader;
+    int tricks = 0;
+
+    for (int trick = 0; trick < numTricks; trick++) {
+        state.seat = trickLeader;
+        for (state.cardsPlayed = 0; state.cardsPlayed < NUMPOSITIONS; state.cardsPlayed++) {
+            CardSet legal = legalCards(state);
+            int card = policies[state.seat](state, legal, randomizer);
+
+            // A policy choosing a card it may not play gets its lowest legal card instead
+            if (((legal >> card) & 1) == 0) {
+                card = __builtin_ctzll(legal);
+            }
+            state.hands[state.seat] &= ~((CardSet) 1 << card);
+
+            if (state.cardsPlayed == 0) {
+                state.ledSuit = card / SUITBITS;
+                state.winningCard = card;
+                state.winningSeat = state.seat;
+            }
+            else if (beats(card, state.winningCard, state.trump)) {
+                state.winningCard = card;
+                state.winningSeat = state.seat;
+            }
+            state.seat = (state.seat + 1) % NUMPOSITIONS;
+        }
+
+        if (state.winningSeat % 2 == leader % 2) {
+            tricks++;
+        }
+        trickLeader = state.winningSeat;
+    }
+    return tricks;
+}
+
+/// \brief
+/// Returns the cards a player may play: the cards of the suit led if any are held, otherwise every card.
+///
+/// \param state const PlayState& - the state of play.
+///
+/// \return CardSet - the legal cards.
+CardSet PlayEngine::legalCards(const PlayState& state) {
+    CardSet hand = state.hands[state.seat];
+    if (state.cardsPlayed == 0) {
+        return hand;
+    }
+    CardSet following = hand & suitCards(state.ledSuit);
+    return following != 0 ? following : hand;
+}
+
+/// \brief
+/// Checks whether a card beats the card currently winning the trick.
+///
+/// \param card int - bit index of the card played.
+/// \param winningCard int - bit index of the card currently winning.
+/// \param trump int - trump suit as a Suit value, or NOTRUMP.
+///
+/// \return bool - true if the new card wins the trick so far.
+bool PlayEngine::beats(int card, int winningCard, int trump) {
+    if (card / SUITBITS == winningCard / SUITBITS) {
+        return card > winningCard;
+    }
+    return card / SUITBITS == trump;
+}
+
+/// \brief
+/// Plays a legal card chosen uniformly at random.
+///
+/// \param state const PlayState& - the state of play.
+/// \param legal CardSet - the cards the player may play.
+/// \param randomizer Random& - source of random choices.
+///
+/// \return int - bit index of the card played.
+int PlayEngine::randomPolicy(const PlayState& state, CardSet legal, Random& randomizer) {
+    int skip = randomizer.randomInteger(0, cardCount(legal) - 1);
+    for (int i = 0; i < skip; i++) {
+        legal &= legal - 1;
+    }
+    return __builtin_ctzll(legal);
+}
+
+/// \brief
+/// Plays the highest ranking legal card.
+///
+/// \param state const PlayState& - the state of play.
+/// \param legal CardSet - the cards the player may play.
+/// \param randomizer Random& - source of random choices.
+///
+/// \return int - bit index of the card played.
+int PlayEngine::highestPolicy(const PlayState& state, CardSet legal, Random& randomizer) {
+    return highestCard(legal);
+}
+
+/// \brief
+/// Plays the lowest ranking legal card.
+///
+/// \param state const PlayState& - the state of play.
+/// \param legal CardSet - the cards the player may play.
+/// \param randomizer Random& - source of random choices.
+///
+/// \return int - bit index of the card played.
+int PlayEngine::lowestPolicy(const PlayState& state, CardSet legal, Random& randomizer) {
+    return lowestCard(legal);
+}
+
+/// \brief
+/// Plays by simple rules of thumb. The leader cashes a card no one can beat in a side suit, or else
+/// leads low from their longest suit. Second hand plays low. Third and fourth hand play low when
+/// partner is winning, otherwise the cheapest card that wins the trick so far, ruffing when
+/// void, and otherwise discard their lowest card outside trumps.
+///
+/// \param state const PlayState& - the state of play.
+/// \param legal CardSet - the cards the player may play.
+/// \param randomizer Random& - source of random choices.
+///
+/// \return int - bit index of the card played.
+int PlayEngine::heuristicPolicy(const PlayState& state, CardSet legal, Random& randomizer) {
+    if (state.cardsPlayed == 0) {
+        CardSet outstanding = state.hands[0] | state.hands[1] | state.hands[2] | state.hands[3];
+        CardSet topCards = 0;
+        int longestSuit = 0;
+        int longestLength = 0;
+
+        for (int suit = 0; suit < NUMSUITS; suit++) {
+            Holding holding = suitHolding(outstanding, (Suit) suit);
+            if (holding != 0) {
+                topCards |= (CardSet) 1 << (suit * SUITBITS + highestRank(holding));
+            }
+            int length = suitLength(legal, (Suit) suit);
+            if (length >= longestLength) {
+                longestSuit = suit;
+                longestLength = length;
+            }
+        }
+
+        CardSet winners = legal & topCards & ~suitCards(state.trump);
+        if (winners != 0) {
+            return __builtin_ctzll(winners);
+        }
+        return longestSuit * SUITBITS + __builtin_ctz(suitHolding(legal, (Suit) longestSuit));
+    }
+
+    // Second hand low, and no point overtaking partner
+    if (state.cardsPlayed == 1 || state.winningSeat == (state.seat + 2) % NUMPOSITIONS) {
+        return lowestDiscard(legal, state.trump);
+    }
+
+    // Legal cards run from the lowest rank of each suit upwards, and only one suit can hold winners
+    for (CardSet cards = legal; cards != 0; cards &= cards - 1) {
+        int card = __builtin_ctzll(cards);
+        if (beats(card, state.winningCard, state.trump)) {
+            return card;
+        }
+    }
+    return lowestDiscard(legal, state.trump);
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+#include "profiler.h"
+
+/// This class gathers the time spent and calls made in each hot path, kept by each thread in its own
+/// counters so that timing takes no lock, and reports them added up and per thread.
+///
+
+/// The counters of one thread, created the first time the thread records a time and kept until exit.
+struct ThreadProfile {
+    int index;
+    long long calls[NUMPROFILECOUNTERS] = {};
+    uint64_t ticks[NUMPROFILECOUNTERS] = {};
+};
+
+static mutex registryLock;
+static vector<ThreadProfile*> threadProfiles;
+static thread_local ThreadProfile* currentProfile = NULL;
+
+// Read together when the program starts, so that ticks can be converted to seconds
+static const uint64_t STARTTICKS = Profiler::ticks();
+static const chrono::steady_clock::time_point STARTTIME = chrono::steady_clock::now();
+
+/// \brief
+/// Works out how many ticks make a second by comparing the clock with the steady clock since the program started.
+///
+/// \return double - ticks per second.
+static double ticksPerSecond() {
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - STARTTIME;
+    return (Profiler::ticks() - STARTTICKS) / max(elapsed.count(), 1e-9);
+}
+
+/// \brief
+/// Adds time and calls to the calling thread's counter.
+///
+/// \param counter ProfileCounter - the hot path.
+/// \param elapsed uint64_t - ticks spent.
+/// \param calls long long - calls made.
+void Profiler::record(ProfileCounter counter, uint64_t elapsed, long long calls) {
+    ThreadProfile* profile = currentProfile;
+    if (profile == NULL) {
+        profile = new ThreadProfile();
+        lock_guard<mutex> guard(registryLock);
+        profile->index = threadProfiles.size();
+        threadProfiles.push_back(profile);
+        currentProfile = profile;
+    }
+    profile->calls[counter] += calls;
+    profile->ticks[counter] += elapsed;
+}
+
+/// \brief
+/// Writes the counters of every thread and their totals as JSON.
+///
+/// \param out ostream& - output stream receiving the JSON.
+void Profiler::writeJson(ostream& out) {
+    const char* counterNames[NUMPROFILECOUNTERS] = { "shuffle", "deal", "evaluate", "bid", "parse", "render" };
+    double rate = ticksPerSecond();
+    lock_guard<mutex> guard(registryLock);
+
+    out << "{\n  \"ticks_per_second\": " << fixed << setprecision(0) << rate << ",\n  \"counters\": [";
+    for (int i = 0; i < NUMPROFILECOUNTERS; i++) {
+        long long calls = 0;
+        uint64_t ticks = 0;
+        for (size_t j = 0; j < threadProfiles.size(); j++) {
+            calls += threadProfiles[j]->calls[i];
+            ticks += threadProfiles[j]->ticks[i];
+        }
+        out << (i > 0 ? "," : "") << "\n    {\"name\": \"" << counterNames[i] << "\", \"calls\": " << calls
+            << setprecision(6) << ", \"seconds\": " << ticks / rate << setprecision(1)
+            << ", \"ns_per_call\": " << (calls > 0 ? ticks / rate * 1e9 / calls : 0.0)
+            << ", \"ticks_per_call\": " << (calls > 0 ? (double) ticks / calls : 0.0) << ", \"threads\": [";
+
+        bool first = true;
+        for (size_t j = 0; j < threadProfiles.size(); j++) {
+            if (threadProfiles[j]->calls[i] == 0) {
+                continue;
+            }
+            out << (first ? "" : ", ") << "{\"thread\": " << threadProfiles[j]->index << ", \"calls\": "
+                << threadProfiles[j]->calls[i] << setprecision(6) << ", \"seconds\": " << threadProfiles[j]->ticks[i] / rate
+                << "}";
+            first = false;
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}" << endl;
+}
+
+/// \brief
+/// Writes a table of the calls, total time, time per call and cycles per call of each hot path.
+///
+/// \param out ostream& - output stream receiving the table.
+void Profiler::printSummary(ostream& out) {
+    const char* counterNames[NUMPROFILECOUNTERS] = { "shuffle", "deal", "evaluate", "bid", "parse", "render" };
+    double rate = ticksPerSecond();
+    lock_guard<mutex> guard(registryLock);
+
+    out << left << setw(10) << "path" << right << setw(14) << "calls" << setw(12) << "total ms" << setw(10) << "ns/call"
+        << setw(14) << "ticks/call" << setw(9) << "threads" << endl;
+    for (int i = 0; i < NUMPROFILECOUNTERS; i++) {
+        long long calls = 0;
+        uint64_t ticks = 0;
+        int threads = 0;
+        for (size_t j = 0; j < threadProfiles.size(); j++) {
+            calls += threadProfiles[j]->calls[i];
+            ticks += threadProfiles[j]->ticks[i];
+            threads += threadProfiles[j]->calls[i] > 0 ? 1 : 0;
+        }
+        out << left << setw(10) << counterNames[i] << right << setw(14) << calls << fixed << setprecision(1)
+            << setw(12) << ticks / rate * 1e3 << setw(10) << (calls > 0 ? ticks / rate * 1e9 / calls : 0.0)
+            << setw(14) << (calls > 0 ? (double) ticks / calls : 0.0) << setw(9) << threads << endl;
+    }
+    out << "Ticks run at " << setprecision(0) << rate << " per second across " << threadProfiles.size()
+        << " threads; times of paths called inside others are also counted in theirs" << endl;
+}
+
+#ifdef BRIDGE_PROFILING
+/// \brief
+/// Writes the counters to standard error in the form the BRIDGE_PROFILE environment variable asks for.
+static void reportProfile() {
+    const char* format = getenv("BRIDGE_PROFILE");
+    if (format != NULL && strcmp(format, "off") == 0) {
+        return;
+    }
+    if (format != NULL && strcmp(format, "json") == 0) {
+        Profiler::writeJson(cerr);
+    }
+    else {
+        Profiler::printSummary(cerr);
+    }
+}
+#endif // BRIDGE_PROFILING
+
+/// \brief
+/// Arranges for the counters to be written to standard error when the program exits, as JSON
+/// if the BRIDGE_PROFILE environment variable is "json", not at all if it is "off" and as
+/// a table otherwise. Does nothing unless the program is built with BRIDGE_PROFILING defined.
+void Profiler::reportAtExit() {
+#ifdef BRIDGE_PROFILING
+    atexit(reportProfile);
+#endif
+}
+
+/// \brief
+/// Reads a steady clock in nanoseconds.
+///
+/// \return uint64_t - nanoseconds since an arbitrary point.
+uint64_t Profiler::steadyNanoseconds() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -1,25 +1,92 @@
-#include <cstdlib>
 #include <ctime>
+#include <random>
 #include "random.h"
 
+using namespace std;
+
+/// \brief
+/// Advances a SplitMix64 sequence and returns its next output, used to spread seeds over the generator state.
+///
+/// \param x uint64_t& - the sequence position, advanced by the call.
+/// \return uint64_t - the next well mixed 64-bit value.
+static uint64_t splitMix(uint64_t& x) {
+   uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   return z ^ (z >> 31);
+}
+
+/// \brief
+/// Rotates a 64-bit value left.
+static inline uint64_t rotateLeft(uint64_t x, int k) {
+   return (x << k) | (x >> (64 - k));
+}
+
 /// This class provides several functions for generating pseud-random numbers.
 ///
 Random::Random() {
    randomize();
 }
 
+/// \brief
+///
+/// Initialize the randomizer with a reproducible stream. Randomizers created with the same seed
+/// and stream produce the same numbers, while different streams of one seed are independent.
+///
+/// \param seed unsigned long long - seed shared by all streams of a run.
+/// \param stream unsigned long long - index of the stream to be generated from the seed.
+///
+Random::Random(unsigned long long seed, unsigned long long stream) {
+
+   // Mix the seed and stream separately so nearby pairs do not give overlapping sequences
+   uint64_t seedMix = seed;
+   uint64_t streamMix = stream ^ 0x6A09E667F3BCC909ULL;
+   uint64_t x = splitMix(seedMix) ^ rotateLeft(splitMix(streamMix), 17);
+   for (int i = 0; i < 4; i++) {
+      state[i] = splitMix(x);
+   }
+}
+
+/// \brief
+///
+/// Generates the next 64 random bits of the stream.
+/// \return uint64_t - a uniformly distributed 64-bit value.
+///
+uint64_t Random::next() {
+   uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+   uint64_t t = state[1] << 17;
+
+   state[2] ^= state[0];
+   state[3] ^= state[1];
+   state[1] ^= state[2];
+   state[0] ^= state[3];
+   state[2] ^= t;
+   state[3] = rotateLeft(state[3], 45);
+   return result;
+}
+
 
 /// \brief
 /// Generates a random integer number greater than or equal to low and less than or equal to high.
+/// Every value in the range is equally likely: the 64-bit output is scaled by multiplication and the
+/// rare products that would favour low values are rejected.
 ///
 /// \param low int - lower bound for range (inclusive).
 /// \param high int - upper bound for range (inclusive).
 /// \return int - A random integer number greater than or equal to low and less than or equal to high.
 ///
 int Random::randomInteger(int low, int high) {
-   double d = double(rand()) / (double(RAND_MAX) + 1);
-   int k = int(d * (high - low  + 1));
-   return low + k;
+   uint64_t range = (uint64_t) (high - low) + 1;
+   unsigned __int128 product = (unsigned __int128) next() * range;
+
+   // Reject the products whose low half falls in the biased region
+   if ((uint64_t) product < range) {
+      uint64_t threshold = -range % range;
+      while ((uint64_t) product < threshold) {
+         product = (unsigned __int128) next() * range;
+      }
+   }
+   return low + (int) (product >> 64);
 }
 
 /// \brief
@@ -30,7 +97,7 @@ int Random::randomInteger(int low, int high) {
 /// \return double - A random real number greater than or equal to low and less than high.
 ///
 double Random::randomReal(double low, double high) {
-   double d = double(rand()) / (double(RAND_MAX) + 1);
+   double d = double(next() >> 11) / 9007199254740992.0;
    return low + d * (high - low);
 }
 
@@ -48,9 +115,14 @@ bool Random::randomChance(double p) {
 /// \brief
 ///
 /// Initializes the random-number generator so that its results are unpredictable.  If this function is
-/// not called the other functions will return the same values on each run.
+/// not called the other functions will return the same values on each run. The hardware entropy source
+/// is combined with the time so that randomizers created in the same second still differ.
 ///
 void Random::randomize() {
-   srand(int(time(NULL)));
+   random_device entropy;
+   uint64_t x = ((uint64_t) entropy() << 32) ^ entropy() ^ (uint64_t) time(NULL);
+   for (int i = 0; i < 4; i++) {
+      state[i] = splitMix(x);
+   }
 }
 
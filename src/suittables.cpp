@@ -0,0 +1,8 @@
+#include "suittables.h"
+
+/// This class holds the features of every possible suit holding, worked out when the program is
+/// compiled so that evaluating a hand takes one lookup per suit and nothing has to be set up at startup.
+///
+
+/// The features of every suit holding, indexed by the holding's 13 rank bits.
+constexpr SuitTables SUITTABLES;
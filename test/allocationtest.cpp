@@ -0,0 +1,39 @@
+/// File: allocationtest.cpp
+/// Checks that setting up, dealing and bidding a game makes no heap allocations, running a million
+/// shuffled games after a warm-up and exiting with status 1 if any allocation is counted.
+///
+/// Usage: allocationtest
+
+#include <iostream>
+#include "allocationcounter.h"
+#include "game.h"
+
+using namespace std;
+
+const long long NUMWARMUPDEALS = 1000;
+const long long NUMTESTDEALS = 1000000;
+const unsigned long long TESTSEED = 1;
+
+int main() {
+    Game game;
+
+    // Anything allocated once, such as the shared pack and the bid table, is made during the warm-up
+    for (long long i = 0; i < NUMWARMUPDEALS; i++) {
+        game.setup(TESTSEED, i);
+        game.deal();
+        game.auction();
+        game.nextDealer();
+    }
+
+    long long allocationsBefore = allocations;
+    for (long long i = 0; i < NUMTESTDEALS; i++) {
+        game.setup(TESTSEED, NUMWARMUPDEALS + i);
+        game.deal();
+        game.auction();
+        game.nextDealer();
+    }
+    long long made = allocations - allocationsBefore;
+
+    cout << "Made " << made << " heap allocations in " << NUMTESTDEALS << " setup, deal and auction cycles" << endl;
+    return made == 0 ? 0 : 1;
+}
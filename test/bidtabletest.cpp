@@ -0,0 +1,165 @@
+/// File: bidtabletest.cpp
+/// Checks the opening bids of the active bidding system, compiled from the standard rules, against
+/// a copy of the original bidding code for every suit length pattern and every strength from 0 to 60,
+/// exiting with status 1 if any bid differs, so that no edit to the rules can change a bid unnoticed.
+///
+/// Usage: bidtabletest
+
+#include <iostream>
+#include <string>
+#include "biddingsystem.h"
+#include "hand.h"
+
+using namespace std;
+
+const int MAXTESTSTRENGTH = 60;
+
+/// \brief
+/// Returns the letter of a suit as used in bids.
+///
+/// \param suit int - the suit.
+///
+/// \return string - C, D, H or S.
+static string suitName(int suit) {
+    return string(1, "CDHS"[suit]);
+}
+
+/// \brief
+/// Decides the opening bid by the rules of the original Hand::makeBid, kept here unchanged
+/// as the reference the bidding system must reproduce.
+///
+/// \param lengths const int[] - number of cards held in each suit, indexed by Suit.
+/// \param handStrength int - the high card and length points of the hand.
+///
+/// \return string - the bid that the player should make.
+static string referenceBid(const int lengths[NUMSUITS], int handStrength) {
+    string bid;
+
+    // The longest suits from the lowest ranking, as calculateLongestSuit found them
+    int longestSuit[NUMSUITS];
+    int numLongest = 0;
+    int longestNum = 0;
+    for (int i = 0; i < NUMSUITS; i++) {
+        if (longestNum < lengths[i]) {
+            longestNum = lengths[i];
+            numLongest = 0;
+            longestSuit[numLongest++] = i;
+        }
+        else if (longestNum == lengths[i]) {
+            longestSuit[numLongest++] = i;
+        }
+    }
+
+    // Balanced hands have no suit shorter than two or longer than four and at most one doubleton
+    bool handBalanced = true;
+    int numTwoSuits = 0;
+    for (int i = 0; i < NUMSUITS; i++) {
+        if (lengths[i] < 2 || lengths[i] > 4) {
+            handBalanced = false;
+            break;
+        }
+        if (lengths[i] == 2 && ++numTwoSuits > 1) {
+            handBalanced = false;
+        }
+    }
+
+    // Bids the longer minor, diamonds if both hold four and clubs if both hold three
+    auto bidMinorSuit = [&]() {
+        if (lengths[DIAMONDS] == lengths[CLUBS]) {
+            bid = lengths[DIAMONDS] == 4 ? "1D" : "1C";
+        }
+        else {
+            bid = lengths[DIAMONDS] > lengths[CLUBS] ? "1D" : "1C";
+        }
+    };
+
+    if (!handBalanced) {
+        if (handStrength <= 12) {
+            switch(longestNum) {
+                case 6:
+                    if (numLongest == 2) {
+                        bid = "2" + suitName(longestSuit[numLongest - 1]);
+                        break;
+                    }
+                    if (longestSuit[0] == 0) {
+                        bid = "PASS";
+                        break;
+                    }
+                    bid = "2" + suitName(longestSuit[0]);
+                    break;
+                case 7:
+                    bid = "3" + suitName(longestSuit[0]);
+                    break;
+                case 8:
+                    bid = "4" + suitName(longestSuit[0]);
+                    break;
+                default:
+                    bid = "PASS";
+                    break;
+            }
+        }
+        else if (handStrength <= 21) {
+            if (numLongest == 1) {
+                bid = "1" + suitName(longestSuit[0]);
+            }
+            else if (longestNum == 4) {
+                bid = "1" + suitName(longestSuit[0]);
+            }
+            else {
+                bid = "1" + suitName(longestSuit[numLongest - 1]);
+            }
+        }
+        else {
+            bid = "2C";
+        }
+    }
+    else {
+        if (handStrength <= 12) {
+            bid = "PASS";
+        }
+        else if (handStrength <= 14) {
+            bidMinorSuit();
+        }
+        else if (handStrength <= 17) {
+            bid = "1NT";
+        }
+        else if (handStrength <= 19) {
+            bidMinorSuit();
+        }
+        else if (handStrength <= 21) {
+            bid = "2NT";
+        }
+        else {
+            bid = "2C";
+        }
+    }
+    return bid;
+}
+
+int main() {
+    int numChecked = 0;
+    int numMismatches = 0;
+
+    for (int clubs = 0; clubs <= NUMRANKS; clubs++) {
+        for (int diamonds = 0; clubs + diamonds <= NUMRANKS; diamonds++) {
+            for (int hearts = 0; clubs + diamonds + hearts <= NUMRANKS; hearts++) {
+                int lengths[NUMSUITS] = { clubs, diamonds, hearts, NUMRANKS - clubs - diamonds - hearts };
+                for (int strength = 0; strength <= MAXTESTSTRENGTH; strength++) {
+                    string expected = referenceBid(lengths, strength);
+                    string found = Hand::bidName(BiddingSystem::active().openingBid(lengths, strength));
+                    numChecked++;
+                    if (found != expected) {
+                        if (numMismatches++ < 20) {
+                            cerr << "Mismatch: " << lengths[SPADES] << "-" << lengths[HEARTS] << "-"
+                                 << lengths[DIAMONDS] << "-" << lengths[CLUBS] << " strength " << strength
+                                 << " bids " << found << ", expected " << expected << endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    cout << "Checked " << numChecked << " shapes and strengths, " << numMismatches << " mismatches" << endl;
+    return numMismatches == 0 ? 0 : 1;
+}